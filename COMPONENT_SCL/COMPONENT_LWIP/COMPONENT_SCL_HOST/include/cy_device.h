@@ -0,0 +1,57 @@
+/*
+ * Copyright 2018-2020 Cypress Semiconductor Corporation
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ *  Provides the device definitions used by SCL for host builds.
+ *  The DWT cycle counter runs at SystemCoreClock and is derived from the monotonic clock.
+ */
+#ifndef INCLUDED_CY_DEVICE_H_
+#define INCLUDED_CY_DEVICE_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define DWT_CTRL_CYCCNTENA_Msk        (1UL)
+#define CoreDebug_DEMCR_TRCENA_Msk    (1UL << 24)
+
+typedef struct {
+    volatile uint32_t CTRL;
+    volatile uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct {
+    volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+extern uint32_t SystemCoreClock;
+extern CoreDebug_Type scl_host_core_debug;
+
+/** Returns the emulated DWT registers with CYCCNT refreshed */
+DWT_Type *scl_host_dwt(void);
+
+#define DWT                           (scl_host_dwt())
+#define CoreDebug                     (&scl_host_core_debug)
+
+#ifdef __cplusplus
+} /*extern "C" */
+#endif
+
+#endif /* ifndef INCLUDED_CY_DEVICE_H_ */
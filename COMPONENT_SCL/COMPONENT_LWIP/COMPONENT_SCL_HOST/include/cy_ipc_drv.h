@@ -0,0 +1,26 @@
+/*
+ * Copyright 2018-2020 Cypress Semiconductor Corporation
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ *  Host build placeholder, SCL reaches the IPC registers through scl_ipc_hal.h
+ */
+#ifndef INCLUDED_CY_IPC_DRV_H_
+#define INCLUDED_CY_IPC_DRV_H_
+
+#include "cy_device.h"
+
+#endif /* ifndef INCLUDED_CY_IPC_DRV_H_ */
@@ -0,0 +1,120 @@
+/*
+ * Copyright 2018-2020 Cypress Semiconductor Corporation
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ *  Provides the subset of the CY-RTOS abstraction used by SCL, implemented with pthreads for host builds
+ */
+#ifndef INCLUDED_CYABS_RTOS_H_
+#define INCLUDED_CYABS_RTOS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "cy_result.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/******************************************************
+*                      Macros
+******************************************************/
+#define CY_RTOS_NEVER_TIMEOUT         (0xFFFFFFFFUL)
+
+#define CY_RTOS_TIMEOUT               CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_ABSTRACTION_OS, 0)
+#define CY_RTOS_NO_MEMORY             CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_ABSTRACTION_OS, 1)
+#define CY_RTOS_GENERAL_ERROR         CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_ABSTRACTION_OS, 2)
+#define CY_RTOS_BAD_PARAM             CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_ABSTRACTION_OS, 5)
+
+/******************************************************
+*             Structures and Enumerations
+******************************************************/
+/**
+ * Thread priorities, accepted for compatibility; host threads all run at the default priority
+ */
+typedef enum {
+    CY_RTOS_PRIORITY_MIN         = 0,
+    CY_RTOS_PRIORITY_LOW         = 1,
+    CY_RTOS_PRIORITY_BELOWNORMAL = 2,
+    CY_RTOS_PRIORITY_NORMAL      = 3,
+    CY_RTOS_PRIORITY_ABOVENORMAL = 4,
+    CY_RTOS_PRIORITY_HIGH        = 5,
+    CY_RTOS_PRIORITY_REALTIME    = 6,
+    CY_RTOS_PRIORITY_MAX         = 7
+} cy_thread_priority_t;
+
+typedef enum {
+    CY_TIMER_TYPE_PERIODIC,
+    CY_TIMER_TYPE_ONCE
+} cy_timer_trigger_type_t;
+
+typedef void *cy_thread_arg_t;
+typedef void (*cy_thread_entry_fn_t)(cy_thread_arg_t arg);
+typedef struct cy_host_thread *cy_thread_t;
+
+typedef void *cy_timer_callback_arg_t;
+typedef void (*cy_timer_callback_t)(cy_timer_callback_arg_t arg);
+typedef struct cy_host_timer *cy_timer_t;
+
+typedef uint32_t cy_time_t;
+
+typedef pthread_mutex_t cy_mutex_t;
+
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    uint32_t count;
+    uint32_t maxcount;
+} cy_semaphore_t;
+
+/******************************************************
+*             Function Prototypes
+******************************************************/
+cy_rslt_t cy_rtos_create_thread(cy_thread_t *thread, cy_thread_entry_fn_t entry_function,
+                                const char *name, void *stack, uint32_t stack_size,
+                                cy_thread_priority_t priority, cy_thread_arg_t arg);
+void cy_rtos_exit_thread(void);
+cy_rslt_t cy_rtos_terminate_thread(cy_thread_t *thread);
+cy_rslt_t cy_rtos_join_thread(cy_thread_t *thread);
+cy_rslt_t cy_rtos_get_thread_handle(cy_thread_t *thread);
+
+cy_rslt_t cy_rtos_init_mutex(cy_mutex_t *mutex);
+cy_rslt_t cy_rtos_get_mutex(cy_mutex_t *mutex, cy_time_t timeout_ms);
+cy_rslt_t cy_rtos_set_mutex(cy_mutex_t *mutex);
+cy_rslt_t cy_rtos_deinit_mutex(cy_mutex_t *mutex);
+
+cy_rslt_t cy_rtos_init_semaphore(cy_semaphore_t *semaphore, uint32_t maxcount, uint32_t initcount);
+cy_rslt_t cy_rtos_get_semaphore(cy_semaphore_t *semaphore, cy_time_t timeout_ms, bool in_isr);
+cy_rslt_t cy_rtos_set_semaphore(cy_semaphore_t *semaphore, bool in_isr);
+cy_rslt_t cy_rtos_deinit_semaphore(cy_semaphore_t *semaphore);
+
+cy_rslt_t cy_rtos_init_timer(cy_timer_t *timer, cy_timer_trigger_type_t type,
+                             cy_timer_callback_t fun, cy_timer_callback_arg_t arg);
+cy_rslt_t cy_rtos_start_timer(cy_timer_t *timer, cy_time_t num_ms);
+cy_rslt_t cy_rtos_stop_timer(cy_timer_t *timer);
+cy_rslt_t cy_rtos_is_running_timer(cy_timer_t *timer, bool *state);
+cy_rslt_t cy_rtos_deinit_timer(cy_timer_t *timer);
+
+cy_rslt_t cy_rtos_get_time(cy_time_t *tval);
+cy_rslt_t cy_rtos_delay_milliseconds(cy_time_t num_ms);
+
+#ifdef __cplusplus
+} /*extern "C" */
+#endif
+
+#endif /* ifndef INCLUDED_CYABS_RTOS_H_ */
@@ -0,0 +1,42 @@
+/*
+ * Copyright 2018-2020 Cypress Semiconductor Corporation
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ *  Provides the subset of the HAL used by SCL for host builds.
+ *  A critical section excludes the emulated interrupt handlers, like masking interrupts on target.
+ */
+#ifndef INCLUDED_CYHAL_H_
+#define INCLUDED_CYHAL_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include "cy_result.h"
+#include "cy_device.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+uint32_t cyhal_system_critical_section_enter(void);
+void cyhal_system_critical_section_exit(uint32_t old_state);
+
+#ifdef __cplusplus
+} /*extern "C" */
+#endif
+
+#endif /* ifndef INCLUDED_CYHAL_H_ */
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2018-2020 Cypress Semiconductor Corporation
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ *  Provides declarations for the Network Processor side of the emulated IPC hardware.
+ *
+ *  The emulation keeps the IPC_STRUCT semantics used by SCL: a channel is locked by
+ *  scl_ipc_hal_acquire() and unlocked by scl_ipc_hal_release(); a notify sets bit (16 + channel)
+ *  and a release sets bit (channel) in the interrupt structures of the given mask. Handlers
+ *  registered with scl_ipc_hal_enable_interrupt() run one at a time on an interrupt thread,
+ *  excluded by cyhal_system_critical_section_enter(). The Network Processor polls its events
+ *  with the functions below instead of taking interrupts.
+ */
+#ifndef INCLUDED_SCL_IPC_HAL_HOST_H_
+#define INCLUDED_SCL_IPC_HAL_HOST_H_
+
+#include "scl_ipc_hal.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/******************************************************
+*                      Macros
+******************************************************/
+/**
+ * Number of emulated IPC channels and interrupt structures
+ */
+#define SCL_IPC_HOST_CHANNELS         (16)
+
+/******************************************************
+*             Function Prototypes
+******************************************************/
+/** Waits until one of the channels is notified, as seen by the interrupt structure of the same number
+ *
+ *  @param   channels   Mask of the channels to be watched.
+ *  @param   timeout_ms Time to wait, CY_RTOS_NEVER_TIMEOUT to wait forever.
+ *
+ *  @return  Mask of the notified channels, their notify events are cleared; 0 on timeout
+ */
+uint32_t scl_ipc_host_wait_notify(uint32_t channels, uint32_t timeout_ms);
+
+/** Waits until a channel is unlocked
+ *
+ *  @param   channel    IPC channel.
+ *  @param   timeout_ms Time to wait, CY_RTOS_NEVER_TIMEOUT to wait forever.
+ *
+ *  @return  SCL_TRUE if the channel is unlocked
+ */
+scl_bool_t scl_ipc_host_wait_unlocked(uint32_t channel, uint32_t timeout_ms);
+
+/** Waits until a channel is unlocked and acquires it
+ *
+ *  @param   channel    IPC channel.
+ *  @param   timeout_ms Time to wait, CY_RTOS_NEVER_TIMEOUT to wait forever.
+ *
+ *  @return  SCL_TRUE if the lock was acquired
+ */
+scl_bool_t scl_ipc_host_acquire_wait(uint32_t channel, uint32_t timeout_ms);
+
+/** Calls the deep-sleep check registered by SCL
+ *
+ *  @return  SCL_TRUE if SCL allows deep sleep or did not register a check
+ */
+scl_bool_t scl_ipc_host_deepsleep_allowed(void);
+
+#ifdef __cplusplus
+} /*extern "C" */
+#endif
+
+#endif /* ifndef INCLUDED_SCL_IPC_HAL_HOST_H_ */
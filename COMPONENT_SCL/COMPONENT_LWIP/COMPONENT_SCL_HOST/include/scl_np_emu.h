@@ -0,0 +1,138 @@
+/*
+ * Copyright 2018-2020 Cypress Semiconductor Corporation
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ *  Provides declarations for the emulated Network Processor used by host builds.
+ *
+ *  The emulator serves the legacy IPC protocol on the emulated IPC hardware: it answers the
+ *  control commands, loops SCL_TX_SEND_OUT frames back through the SCL_RX_GET_BUFFER and
+ *  SCL_RX_DATA handshake or hands them to a callback standing for the remote peer, and injects
+ *  frames, events and status changes on request. The TX ring, with its completion ring and
+ *  doorbells, the RX ring, with the RX buffer post ring, and small-frame aggregation are accepted
+ *  only when enabled in the configuration.
+ *  It does not accept the tag, channel, scatter-gather or credit configuration commands, so SCL
+ *  falls back to the legacy path for them as it does with older NP firmware.
+ */
+#ifndef INCLUDED_SCL_NP_EMU_H_
+#define INCLUDED_SCL_NP_EMU_H_
+
+#include "scl_common.h"
+#include "scl_wifi_api.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/******************************************************
+*             Structures and Enumerations
+******************************************************/
+/**
+ * Receives a copy of each SCL_TX_SEND_OUT frame, on the NP thread before the channel is released
+ */
+typedef void (*scl_np_emu_tx_callback_t)(const uint8_t *frame, uint32_t length, void *user_data);
+
+/**
+ * Configuration of the emulated Network Processor
+ */
+typedef struct {
+    scl_mac_t mac;                  /**< MAC address returned by SCL_TX_GET_MAC */
+    int32_t rssi;                   /**< RSSI returned by SCL_TX_WIFI_GET_RSSI */
+    scl_bool_t loopback;            /**< SCL_TRUE to send SCL_TX_SEND_OUT frames back to SCL */
+    uint32_t turnaround_us;         /**< Time spent by NP on each command before releasing the channel */
+    scl_np_emu_tx_callback_t tx_callback; /**< Takes the SCL_TX_SEND_OUT frames instead of the loopback, NULL if unused */
+    void *tx_user_data;             /**< Argument of tx_callback */
+    scl_bool_t aggregation;         /**< SCL_TRUE to accept SCL_TX_AGG_CONFIG and aggregate small received frames */
+    scl_bool_t tx_ring;             /**< SCL_TRUE to accept the TX ring and the TX completion ring */
+    scl_bool_t rx_ring;             /**< SCL_TRUE to accept the RX ring and the RX buffer post ring */
+} scl_np_emu_config_t;
+
+/**
+ * Counters of the emulated Network Processor
+ */
+typedef struct {
+    uint32_t commands;              /**< Commands received from SCL, frames included */
+    uint32_t frames_sent;           /**< SCL_TX_SEND_OUT frames received from SCL */
+    uint32_t frames_received;       /**< Frames delivered to SCL with SCL_RX_DATA or in the RX ring */
+    uint32_t frames_dropped;        /**< Frames dropped because SCL had no buffer or the channel timed out */
+    uint32_t tx_aggregates;         /**< SCL_TX_SEND_OUT_AGG aggregates received from SCL, their frames count as sent */
+    uint32_t rx_aggregates;         /**< Aggregates delivered to SCL with SCL_RX_DATA_AGG, their frames count as received */
+    uint32_t events;                /**< Events and status changes delivered to SCL */
+    uint32_t rx_messages;           /**< Messages written to the RX channel, one IPC handshake each */
+    uint32_t rx_pending;            /**< Frames, events and status changes not yet delivered */
+    uint32_t doorbells;             /**< SCL_TX_RING_DOORBELL commands received from SCL */
+    uint32_t completions;           /**< Buffers reported in the TX completion ring */
+    uint32_t ring_notifications;    /**< SCL_RX_RING_DOORBELL messages sent to SCL */
+    uint32_t posted_buffers;        /**< RX buffers taken from the post ring instead of SCL_RX_GET_BUFFER */
+    uint32_t post_low;              /**< SCL_RX_POST_LOW messages sent to SCL */
+    uint64_t cpu_time_us;           /**< CPU time used by the emulator threads */
+    uint32_t last_ioctl;            /**< Last IOCTL of SCL_TX_SET_IOCTL_VALUE */
+    uint32_t last_ioctl_value;      /**< Value of the last SCL_TX_SET_IOCTL_VALUE */
+} scl_np_emu_stats_t;
+
+/******************************************************
+*             Function Prototypes
+******************************************************/
+/** Starts the emulated Network Processor, to be called before scl_init()
+ *
+ *  @param   config   Configuration, NULL for the defaults.
+ *
+ *  @return  SCL_SUCCESS, SCL_ERROR if it is already running or its threads cannot be created
+ */
+scl_result_t scl_np_emu_start(const scl_np_emu_config_t *config);
+
+/** Stops the emulated Network Processor and drops the frames and events not yet delivered */
+void scl_np_emu_stop(void);
+
+/** Queues a frame to be delivered to SCL with SCL_RX_DATA
+ *
+ *  @param   data     Ethernet frame, copied by the call.
+ *  @param   length   Length of the frame.
+ *
+ *  @return  SCL_SUCCESS, SCL_BADARG or SCL_ERROR if the emulator is not running
+ */
+scl_result_t scl_np_emu_inject_frame(const uint8_t *data, uint32_t length);
+
+/** Queues an event to be delivered to SCL with SCL_RX_EVENT_CALLBACK
+ *
+ *  @param   header   Event header, its datalen gives the length of data.
+ *  @param   data     Event data, copied by the call; may be NULL if datalen is 0.
+ *
+ *  @return  SCL_SUCCESS, SCL_BADARG or SCL_ERROR if the emulator is not running
+ */
+scl_result_t scl_np_emu_inject_event(const scl_event_header_t *header, const uint8_t *data);
+
+/** Queues a message without buffer, such as SCL_RX_GET_CONNECTION_STATUS or SCL_RX_SCAN_STATUS
+ *
+ *  @param   index    Receive index.
+ *  @param   value    Value written in DATA1.
+ *
+ *  @return  SCL_SUCCESS or SCL_ERROR if the emulator is not running
+ */
+scl_result_t scl_np_emu_inject_status(scl_ipc_rx_t index, uint32_t value);
+
+/** Reads the counters of the emulated Network Processor
+ *
+ *  @param   stats    Receives the counters.
+ */
+void scl_np_emu_get_stats(scl_np_emu_stats_t *stats);
+
+#ifdef __cplusplus
+} /*extern "C" */
+#endif
+
+#endif /* ifndef INCLUDED_SCL_NP_EMU_H_ */
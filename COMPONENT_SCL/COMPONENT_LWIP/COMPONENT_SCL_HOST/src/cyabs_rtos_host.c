@@ -0,0 +1,438 @@
+/*
+ * Copyright 2018-2020 Cypress Semiconductor Corporation
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ *  Provides the pthread implementation of the CY-RTOS abstraction subset used by SCL on host builds
+ */
+#include "cyabs_rtos.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <time.h>
+
+/******************************************************
+ *        Variables Definitions
+ *****************************************************/
+/* Structure of a host thread
+ *   thread:               pthread running the entry function
+ *   entry:                entry function of the thread
+ *   arg:                  argument of the entry function
+ */
+struct cy_host_thread {
+    pthread_t thread;
+    cy_thread_entry_fn_t entry;
+    cy_thread_arg_t arg;
+};
+
+/* Structure of a host timer
+ *   mutex:                protects the timer state
+ *   cond:                 signaled when the timer is started, stopped or deleted
+ *   thread:               thread calling the callback
+ *   type:                 one-shot or periodic
+ *   fun:                  callback
+ *   arg:                  argument of the callback
+ *   period_ms:            period given to cy_rtos_start_timer()
+ *   deadline:             next expiry, CLOCK_MONOTONIC
+ *   running:              set while the timer is armed
+ *   quit:                 set to stop the thread
+ */
+struct cy_host_timer {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    pthread_t thread;
+    cy_timer_trigger_type_t type;
+    cy_timer_callback_t fun;
+    cy_timer_callback_arg_t arg;
+    cy_time_t period_ms;
+    struct timespec deadline;
+    bool running;
+    bool quit;
+};
+
+static struct timespec cy_host_start;
+/* Host thread running on this pthread, NULL for threads not created by cy_rtos_create_thread() */
+static __thread struct cy_host_thread *cy_host_thread_current;
+static pthread_once_t cy_host_start_once = PTHREAD_ONCE_INIT;
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+
+/** Adds milliseconds to a CLOCK_MONOTONIC time */
+static void cy_host_add_ms(struct timespec *time, cy_time_t ms)
+{
+    time->tv_sec += ms / 1000;
+    time->tv_nsec += (long) (ms % 1000) * 1000000L;
+    if (time->tv_nsec >= 1000000000L) {
+        time->tv_sec++;
+        time->tv_nsec -= 1000000000L;
+    }
+}
+
+/** Initializes a condition variable on CLOCK_MONOTONIC */
+static void cy_host_cond_init(pthread_cond_t *cond)
+{
+    pthread_condattr_t attr;
+
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+/** Records the time origin of cy_rtos_get_time() */
+static void cy_host_start_init(void)
+{
+    clock_gettime(CLOCK_MONOTONIC, &cy_host_start);
+}
+
+static void *cy_host_thread_entry(void *arg)
+{
+    struct cy_host_thread *thread = (struct cy_host_thread *) arg;
+
+    cy_host_thread_current = thread;
+    thread->entry(thread->arg);
+    return NULL;
+}
+
+cy_rslt_t cy_rtos_create_thread(cy_thread_t *thread, cy_thread_entry_fn_t entry_function,
+                                const char *name, void *stack, uint32_t stack_size,
+                                cy_thread_priority_t priority, cy_thread_arg_t arg)
+{
+    struct cy_host_thread *host_thread;
+
+    (void) name;
+    (void) stack;
+    (void) stack_size;
+    (void) priority;
+    if ((thread == NULL) || (entry_function == NULL)) {
+        return CY_RTOS_BAD_PARAM;
+    }
+    host_thread = (struct cy_host_thread *) malloc(sizeof(*host_thread));
+    if (host_thread == NULL) {
+        return CY_RTOS_NO_MEMORY;
+    }
+    host_thread->entry = entry_function;
+    host_thread->arg = arg;
+    if (pthread_create(&host_thread->thread, NULL, cy_host_thread_entry, host_thread) != 0) {
+        free(host_thread);
+        return CY_RTOS_GENERAL_ERROR;
+    }
+    *thread = host_thread;
+    return CY_RSLT_SUCCESS;
+}
+
+void cy_rtos_exit_thread(void)
+{
+    pthread_exit(NULL);
+}
+
+cy_rslt_t cy_rtos_terminate_thread(cy_thread_t *thread)
+{
+    if ((thread == NULL) || (*thread == NULL)) {
+        return CY_RTOS_BAD_PARAM;
+    }
+    return (pthread_cancel((*thread)->thread) == 0) ? CY_RSLT_SUCCESS : CY_RTOS_GENERAL_ERROR;
+}
+
+cy_rslt_t cy_rtos_join_thread(cy_thread_t *thread)
+{
+    if ((thread == NULL) || (*thread == NULL)) {
+        return CY_RTOS_BAD_PARAM;
+    }
+    if (pthread_join((*thread)->thread, NULL) != 0) {
+        return CY_RTOS_GENERAL_ERROR;
+    }
+    free(*thread);
+    *thread = NULL;
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t cy_rtos_get_thread_handle(cy_thread_t *thread)
+{
+    if (thread == NULL) {
+        return CY_RTOS_BAD_PARAM;
+    }
+    *thread = cy_host_thread_current;
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t cy_rtos_init_mutex(cy_mutex_t *mutex)
+{
+    pthread_mutexattr_t attr;
+    int err;
+
+    if (mutex == NULL) {
+        return CY_RTOS_BAD_PARAM;
+    }
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    err = pthread_mutex_init(mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+    return (err == 0) ? CY_RSLT_SUCCESS : CY_RTOS_GENERAL_ERROR;
+}
+
+cy_rslt_t cy_rtos_get_mutex(cy_mutex_t *mutex, cy_time_t timeout_ms)
+{
+    struct timespec deadline;
+
+    if (mutex == NULL) {
+        return CY_RTOS_BAD_PARAM;
+    }
+    if (timeout_ms == CY_RTOS_NEVER_TIMEOUT) {
+        return (pthread_mutex_lock(mutex) == 0) ? CY_RSLT_SUCCESS : CY_RTOS_GENERAL_ERROR;
+    }
+    /* pthread_mutex_timedlock() only takes CLOCK_REALTIME */
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    cy_host_add_ms(&deadline, timeout_ms);
+    switch (pthread_mutex_timedlock(mutex, &deadline)) {
+        case 0:
+            return CY_RSLT_SUCCESS;
+        case ETIMEDOUT:
+            return CY_RTOS_TIMEOUT;
+        default:
+            return CY_RTOS_GENERAL_ERROR;
+    }
+}
+
+cy_rslt_t cy_rtos_set_mutex(cy_mutex_t *mutex)
+{
+    if (mutex == NULL) {
+        return CY_RTOS_BAD_PARAM;
+    }
+    return (pthread_mutex_unlock(mutex) == 0) ? CY_RSLT_SUCCESS : CY_RTOS_GENERAL_ERROR;
+}
+
+cy_rslt_t cy_rtos_deinit_mutex(cy_mutex_t *mutex)
+{
+    if (mutex == NULL) {
+        return CY_RTOS_BAD_PARAM;
+    }
+    return (pthread_mutex_destroy(mutex) == 0) ? CY_RSLT_SUCCESS : CY_RTOS_GENERAL_ERROR;
+}
+
+cy_rslt_t cy_rtos_init_semaphore(cy_semaphore_t *semaphore, uint32_t maxcount, uint32_t initcount)
+{
+    if ((semaphore == NULL) || (maxcount == 0) || (initcount > maxcount)) {
+        return CY_RTOS_BAD_PARAM;
+    }
+    pthread_mutex_init(&semaphore->mutex, NULL);
+    cy_host_cond_init(&semaphore->cond);
+    semaphore->count = initcount;
+    semaphore->maxcount = maxcount;
+    return CY_RSLT_SUCCESS;
+}
+
+/** Releases the semaphore lock when a waiting thread is terminated */
+static void cy_host_semaphore_unlock(void *arg)
+{
+    pthread_mutex_unlock((pthread_mutex_t *) arg);
+}
+
+cy_rslt_t cy_rtos_get_semaphore(cy_semaphore_t *semaphore, cy_time_t timeout_ms, bool in_isr)
+{
+    struct timespec deadline;
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+
+    (void) in_isr;
+    if (semaphore == NULL) {
+        return CY_RTOS_BAD_PARAM;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    cy_host_add_ms(&deadline, timeout_ms);
+    pthread_mutex_lock(&semaphore->mutex);
+    pthread_cleanup_push(cy_host_semaphore_unlock, &semaphore->mutex);
+    while ((semaphore->count == 0) && (result == CY_RSLT_SUCCESS)) {
+        if (timeout_ms == CY_RTOS_NEVER_TIMEOUT) {
+            pthread_cond_wait(&semaphore->cond, &semaphore->mutex);
+        } else if (pthread_cond_timedwait(&semaphore->cond, &semaphore->mutex, &deadline) == ETIMEDOUT) {
+            result = CY_RTOS_TIMEOUT;
+        }
+    }
+    if (semaphore->count > 0) {
+        semaphore->count--;
+        result = CY_RSLT_SUCCESS;
+    }
+    pthread_cleanup_pop(1);
+    return result;
+}
+
+cy_rslt_t cy_rtos_set_semaphore(cy_semaphore_t *semaphore, bool in_isr)
+{
+    (void) in_isr;
+    if (semaphore == NULL) {
+        return CY_RTOS_BAD_PARAM;
+    }
+    pthread_mutex_lock(&semaphore->mutex);
+    if (semaphore->count < semaphore->maxcount) {
+        semaphore->count++;
+    }
+    pthread_cond_signal(&semaphore->cond);
+    pthread_mutex_unlock(&semaphore->mutex);
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t cy_rtos_deinit_semaphore(cy_semaphore_t *semaphore)
+{
+    if (semaphore == NULL) {
+        return CY_RTOS_BAD_PARAM;
+    }
+    pthread_cond_destroy(&semaphore->cond);
+    pthread_mutex_destroy(&semaphore->mutex);
+    return CY_RSLT_SUCCESS;
+}
+
+static void *cy_host_timer_thread(void *arg)
+{
+    struct cy_host_timer *timer = (struct cy_host_timer *) arg;
+    cy_timer_callback_t fun;
+    cy_timer_callback_arg_t fun_arg;
+
+    pthread_mutex_lock(&timer->mutex);
+    while (!timer->quit) {
+        if (!timer->running) {
+            pthread_cond_wait(&timer->cond, &timer->mutex);
+            continue;
+        }
+        if (pthread_cond_timedwait(&timer->cond, &timer->mutex, &timer->deadline) != ETIMEDOUT) {
+            /* Restarted, stopped or deleted */
+            continue;
+        }
+        if (timer->type == CY_TIMER_TYPE_PERIODIC) {
+            cy_host_add_ms(&timer->deadline, timer->period_ms);
+        } else {
+            timer->running = false;
+        }
+        fun = timer->fun;
+        fun_arg = timer->arg;
+        pthread_mutex_unlock(&timer->mutex);
+        fun(fun_arg);
+        pthread_mutex_lock(&timer->mutex);
+    }
+    pthread_mutex_unlock(&timer->mutex);
+    return NULL;
+}
+
+cy_rslt_t cy_rtos_init_timer(cy_timer_t *timer, cy_timer_trigger_type_t type,
+                             cy_timer_callback_t fun, cy_timer_callback_arg_t arg)
+{
+    struct cy_host_timer *host_timer;
+
+    if ((timer == NULL) || (fun == NULL)) {
+        return CY_RTOS_BAD_PARAM;
+    }
+    host_timer = (struct cy_host_timer *) calloc(1, sizeof(*host_timer));
+    if (host_timer == NULL) {
+        return CY_RTOS_NO_MEMORY;
+    }
+    pthread_mutex_init(&host_timer->mutex, NULL);
+    cy_host_cond_init(&host_timer->cond);
+    host_timer->type = type;
+    host_timer->fun = fun;
+    host_timer->arg = arg;
+    if (pthread_create(&host_timer->thread, NULL, cy_host_timer_thread, host_timer) != 0) {
+        free(host_timer);
+        return CY_RTOS_GENERAL_ERROR;
+    }
+    *timer = host_timer;
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t cy_rtos_start_timer(cy_timer_t *timer, cy_time_t num_ms)
+{
+    struct cy_host_timer *host_timer;
+
+    if ((timer == NULL) || (*timer == NULL)) {
+        return CY_RTOS_BAD_PARAM;
+    }
+    host_timer = *timer;
+    pthread_mutex_lock(&host_timer->mutex);
+    host_timer->period_ms = num_ms;
+    clock_gettime(CLOCK_MONOTONIC, &host_timer->deadline);
+    cy_host_add_ms(&host_timer->deadline, num_ms);
+    host_timer->running = true;
+    pthread_cond_signal(&host_timer->cond);
+    pthread_mutex_unlock(&host_timer->mutex);
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t cy_rtos_stop_timer(cy_timer_t *timer)
+{
+    if ((timer == NULL) || (*timer == NULL)) {
+        return CY_RTOS_BAD_PARAM;
+    }
+    pthread_mutex_lock(&(*timer)->mutex);
+    (*timer)->running = false;
+    pthread_cond_signal(&(*timer)->cond);
+    pthread_mutex_unlock(&(*timer)->mutex);
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t cy_rtos_is_running_timer(cy_timer_t *timer, bool *state)
+{
+    if ((timer == NULL) || (*timer == NULL) || (state == NULL)) {
+        return CY_RTOS_BAD_PARAM;
+    }
+    pthread_mutex_lock(&(*timer)->mutex);
+    *state = (*timer)->running;
+    pthread_mutex_unlock(&(*timer)->mutex);
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t cy_rtos_deinit_timer(cy_timer_t *timer)
+{
+    struct cy_host_timer *host_timer;
+
+    if ((timer == NULL) || (*timer == NULL)) {
+        return CY_RTOS_BAD_PARAM;
+    }
+    host_timer = *timer;
+    pthread_mutex_lock(&host_timer->mutex);
+    host_timer->quit = true;
+    pthread_cond_signal(&host_timer->cond);
+    pthread_mutex_unlock(&host_timer->mutex);
+    pthread_join(host_timer->thread, NULL);
+    pthread_cond_destroy(&host_timer->cond);
+    pthread_mutex_destroy(&host_timer->mutex);
+    free(host_timer);
+    *timer = NULL;
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t cy_rtos_get_time(cy_time_t *tval)
+{
+    struct timespec now;
+
+    if (tval == NULL) {
+        return CY_RTOS_BAD_PARAM;
+    }
+    pthread_once(&cy_host_start_once, cy_host_start_init);
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    *tval = (cy_time_t) ((now.tv_sec - cy_host_start.tv_sec) * 1000 +
+                         (now.tv_nsec - cy_host_start.tv_nsec) / 1000000L);
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t cy_rtos_delay_milliseconds(cy_time_t num_ms)
+{
+    struct timespec delay;
+
+    delay.tv_sec = num_ms / 1000;
+    delay.tv_nsec = (long) (num_ms % 1000) * 1000000L;
+    while ((nanosleep(&delay, &delay) != 0) && (errno == EINTR)) {
+    }
+    return CY_RSLT_SUCCESS;
+}
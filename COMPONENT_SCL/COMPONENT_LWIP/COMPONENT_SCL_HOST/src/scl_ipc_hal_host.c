@@ -0,0 +1,392 @@
+/*
+ * Copyright 2018-2020 Cypress Semiconductor Corporation
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ *  Provides the host implementation of the IPC hardware access: IPC_STRUCT registers,
+ *  interrupt delivery and critical sections are emulated with pthreads
+ */
+#include "scl_ipc_hal_host.h"
+#include "cyhal.h"
+#include "cyabs_rtos.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <time.h>
+
+/******************************************************
+ **                      Macros
+ *******************************************************/
+#define SCL_HOST_NOTIFY_EVENT(ch)  (1UL << (16 + (ch)))
+#define SCL_HOST_RELEASE_EVENT(ch) (1UL << (ch))
+#define SCL_HOST_CORE_CLOCK        (100000000UL)
+
+/******************************************************
+ *        Variables Definitions
+ *****************************************************/
+/* Structure of an emulated IPC channel
+ *   locked:               lock status, set by an acquire and cleared by a release
+ *   data0:                DATA0 register
+ *   data1:                DATA1 register, wide enough for a host pointer
+ */
+struct scl_host_ipc_channel {
+    bool locked;
+    uint32_t data0;
+    uintptr_t data1;
+};
+
+/* Structure of an emulated IPC interrupt structure
+ *   intr:                 pending release and notify events
+ *   mask:                 events routed to the CP handler
+ *   isr:                  CP handler of the interrupt line
+ */
+struct scl_host_ipc_intr {
+    uint32_t intr;
+    uint32_t mask;
+    scl_ipc_hal_isr_t isr;
+};
+
+/* Structure of SCL host IPC info
+ *   lock:                 protects the registers
+ *   changed:              signaled on every register change
+ *   channel:              emulated IPC channels
+ *   intr:                 emulated IPC interrupt structures
+ *   interrupt_thread:     thread running the CP handlers
+ *   started:              set once the interrupt thread runs
+ *   idle:                 deep-sleep check registered by SCL
+ */
+static struct scl_host_ipc_info_t {
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    struct scl_host_ipc_channel channel[SCL_IPC_HOST_CHANNELS];
+    struct scl_host_ipc_intr intr[SCL_IPC_HOST_CHANNELS];
+    pthread_t interrupt_thread;
+    bool started;
+    scl_ipc_hal_idle_t idle;
+} scl_host_ipc = {
+    .lock = PTHREAD_MUTEX_INITIALIZER
+};
+
+static pthread_once_t scl_host_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t scl_host_critical_section;
+static __thread bool scl_host_in_isr;
+
+uint32_t SystemCoreClock = SCL_HOST_CORE_CLOCK;
+CoreDebug_Type scl_host_core_debug;
+/* Each thread reads CYCCNT from its own copy, refreshed on access */
+static __thread DWT_Type scl_host_dwt_regs;
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+
+/** Creates the objects that need attributes */
+static void scl_host_init_once(void)
+{
+    pthread_mutexattr_t mutex_attr;
+    pthread_condattr_t cond_attr;
+
+    pthread_mutexattr_init(&mutex_attr);
+    pthread_mutexattr_settype(&mutex_attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&scl_host_critical_section, &mutex_attr);
+    pthread_mutexattr_destroy(&mutex_attr);
+
+    pthread_condattr_init(&cond_attr);
+    pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&scl_host_ipc.changed, &cond_attr);
+    pthread_condattr_destroy(&cond_attr);
+}
+
+/** Converts a relative timeout to an absolute CLOCK_MONOTONIC time */
+static void scl_host_deadline(struct timespec *deadline, uint32_t timeout_ms)
+{
+    clock_gettime(CLOCK_MONOTONIC, deadline);
+    deadline->tv_sec += timeout_ms / 1000;
+    deadline->tv_nsec += (long) (timeout_ms % 1000) * 1000000L;
+    if (deadline->tv_nsec >= 1000000000L) {
+        deadline->tv_sec++;
+        deadline->tv_nsec -= 1000000000L;
+    }
+}
+
+/** Waits for a register change, called with the register lock held
+ *
+ *  @return  false once the deadline has passed
+ */
+static bool scl_host_wait_change(const struct timespec *deadline)
+{
+    if (deadline == NULL) {
+        pthread_cond_wait(&scl_host_ipc.changed, &scl_host_ipc.lock);
+        return true;
+    }
+    return (pthread_cond_timedwait(&scl_host_ipc.changed, &scl_host_ipc.lock, deadline) == 0);
+}
+
+/** Returns the lowest interrupt structure with an unmasked pending event, called with the register lock held
+ *
+ *  @return  Interrupt structure or SCL_IPC_HOST_CHANNELS if none
+ */
+static uint32_t scl_host_pending_intr(void)
+{
+    uint32_t intr;
+
+    for (intr = 0; intr < SCL_IPC_HOST_CHANNELS; intr++) {
+        if ((scl_host_ipc.intr[intr].isr != NULL) &&
+            (scl_host_ipc.intr[intr].intr & scl_host_ipc.intr[intr].mask)) {
+            break;
+        }
+    }
+    return intr;
+}
+
+/** Runs the CP handlers of the pending interrupts, one at a time, like a single-core NVIC */
+static void *scl_host_interrupt_thread(void *arg)
+{
+    scl_ipc_hal_isr_t isr;
+    uint32_t intr;
+
+    (void) arg;
+    scl_host_in_isr = true;
+    while (true) {
+        pthread_mutex_lock(&scl_host_ipc.lock);
+        while ((intr = scl_host_pending_intr()) == SCL_IPC_HOST_CHANNELS) {
+            scl_host_wait_change(NULL);
+        }
+        isr = scl_host_ipc.intr[intr].isr;
+        pthread_mutex_unlock(&scl_host_ipc.lock);
+
+        /* The handler clears its events through scl_ipc_hal_clear_interrupt() */
+        pthread_mutex_lock(&scl_host_critical_section);
+        isr();
+        pthread_mutex_unlock(&scl_host_critical_section);
+    }
+    return NULL;
+}
+
+/** Sets events in the interrupt structures of a mask, called with the register lock held */
+static void scl_host_raise(uint32_t intr_mask, uint32_t event)
+{
+    uint32_t intr;
+
+    for (intr = 0; intr < SCL_IPC_HOST_CHANNELS; intr++) {
+        if (intr_mask & (1UL << intr)) {
+            scl_host_ipc.intr[intr].intr |= event;
+        }
+    }
+    pthread_cond_broadcast(&scl_host_ipc.changed);
+}
+
+scl_bool_t scl_ipc_hal_is_locked(uint32_t channel)
+{
+    bool locked;
+
+    pthread_mutex_lock(&scl_host_ipc.lock);
+    locked = scl_host_ipc.channel[channel].locked;
+    pthread_mutex_unlock(&scl_host_ipc.lock);
+    return locked ? SCL_TRUE : SCL_FALSE;
+}
+
+scl_bool_t scl_ipc_hal_acquire(uint32_t channel)
+{
+    bool acquired = false;
+
+    pthread_mutex_lock(&scl_host_ipc.lock);
+    if (!scl_host_ipc.channel[channel].locked) {
+        scl_host_ipc.channel[channel].locked = true;
+        acquired = true;
+    }
+    pthread_mutex_unlock(&scl_host_ipc.lock);
+    return acquired ? SCL_TRUE : SCL_FALSE;
+}
+
+uint32_t scl_ipc_hal_read_data0(uint32_t channel)
+{
+    uint32_t data0;
+
+    pthread_mutex_lock(&scl_host_ipc.lock);
+    data0 = scl_host_ipc.channel[channel].data0;
+    pthread_mutex_unlock(&scl_host_ipc.lock);
+    return data0;
+}
+
+uintptr_t scl_ipc_hal_read_data1(uint32_t channel)
+{
+    uintptr_t data1;
+
+    pthread_mutex_lock(&scl_host_ipc.lock);
+    data1 = scl_host_ipc.channel[channel].data1;
+    pthread_mutex_unlock(&scl_host_ipc.lock);
+    return data1;
+}
+
+void scl_ipc_hal_write(uint32_t channel, uint32_t data0, uintptr_t data1)
+{
+    pthread_mutex_lock(&scl_host_ipc.lock);
+    scl_host_ipc.channel[channel].data0 = data0;
+    scl_host_ipc.channel[channel].data1 = data1;
+    pthread_mutex_unlock(&scl_host_ipc.lock);
+}
+
+void scl_ipc_hal_write_data1(uint32_t channel, uintptr_t data1)
+{
+    pthread_mutex_lock(&scl_host_ipc.lock);
+    scl_host_ipc.channel[channel].data1 = data1;
+    pthread_mutex_unlock(&scl_host_ipc.lock);
+}
+
+void scl_ipc_hal_notify(uint32_t channel, uint32_t intr_mask)
+{
+    pthread_mutex_lock(&scl_host_ipc.lock);
+    scl_host_raise(intr_mask, SCL_HOST_NOTIFY_EVENT(channel));
+    pthread_mutex_unlock(&scl_host_ipc.lock);
+}
+
+void scl_ipc_hal_release(uint32_t channel, uint32_t intr_mask)
+{
+    pthread_mutex_lock(&scl_host_ipc.lock);
+    scl_host_ipc.channel[channel].locked = false;
+    scl_host_raise(intr_mask, SCL_HOST_RELEASE_EVENT(channel));
+    pthread_mutex_unlock(&scl_host_ipc.lock);
+}
+
+void scl_ipc_hal_enable_interrupt(uint32_t intr, uint32_t mask, scl_ipc_hal_isr_t isr)
+{
+    pthread_once(&scl_host_once, scl_host_init_once);
+    pthread_mutex_lock(&scl_host_ipc.lock);
+    scl_host_ipc.intr[intr].mask |= mask;
+    scl_host_ipc.intr[intr].isr = isr;
+    if (!scl_host_ipc.started) {
+        scl_host_ipc.started = (pthread_create(&scl_host_ipc.interrupt_thread, NULL,
+                                               scl_host_interrupt_thread, NULL) == 0);
+    }
+    pthread_cond_broadcast(&scl_host_ipc.changed);
+    pthread_mutex_unlock(&scl_host_ipc.lock);
+}
+
+scl_bool_t scl_ipc_hal_clear_interrupt(uint32_t intr, uint32_t mask)
+{
+    bool pending;
+
+    pthread_mutex_lock(&scl_host_ipc.lock);
+    pending = ((scl_host_ipc.intr[intr].intr & scl_host_ipc.intr[intr].mask & mask) != 0);
+    if (pending) {
+        scl_host_ipc.intr[intr].intr &= ~mask;
+    }
+    pthread_mutex_unlock(&scl_host_ipc.lock);
+    return pending ? SCL_TRUE : SCL_FALSE;
+}
+
+scl_bool_t scl_ipc_hal_in_isr(void)
+{
+    return scl_host_in_isr ? SCL_TRUE : SCL_FALSE;
+}
+
+scl_result_t scl_ipc_hal_register_deepsleep(scl_ipc_hal_idle_t idle)
+{
+    scl_host_ipc.idle = idle;
+    return SCL_SUCCESS;
+}
+
+uint32_t scl_ipc_host_wait_notify(uint32_t channels, uint32_t timeout_ms)
+{
+    struct timespec deadline;
+    uint32_t notified = 0;
+    uint32_t channel;
+
+    pthread_once(&scl_host_once, scl_host_init_once);
+    scl_host_deadline(&deadline, timeout_ms);
+    pthread_mutex_lock(&scl_host_ipc.lock);
+    while (true) {
+        for (channel = 0; channel < SCL_IPC_HOST_CHANNELS; channel++) {
+            if ((channels & (1UL << channel)) &&
+                (scl_host_ipc.intr[channel].intr & SCL_HOST_NOTIFY_EVENT(channel))) {
+                scl_host_ipc.intr[channel].intr &= ~SCL_HOST_NOTIFY_EVENT(channel);
+                notified |= (1UL << channel);
+            }
+        }
+        if ((notified != 0) ||
+            !scl_host_wait_change((timeout_ms == CY_RTOS_NEVER_TIMEOUT) ? NULL : &deadline)) {
+            break;
+        }
+    }
+    pthread_mutex_unlock(&scl_host_ipc.lock);
+    return notified;
+}
+
+scl_bool_t scl_ipc_host_wait_unlocked(uint32_t channel, uint32_t timeout_ms)
+{
+    struct timespec deadline;
+    bool unlocked;
+
+    pthread_once(&scl_host_once, scl_host_init_once);
+    scl_host_deadline(&deadline, timeout_ms);
+    pthread_mutex_lock(&scl_host_ipc.lock);
+    while (scl_host_ipc.channel[channel].locked &&
+           scl_host_wait_change((timeout_ms == CY_RTOS_NEVER_TIMEOUT) ? NULL : &deadline)) {
+    }
+    unlocked = !scl_host_ipc.channel[channel].locked;
+    pthread_mutex_unlock(&scl_host_ipc.lock);
+    return unlocked ? SCL_TRUE : SCL_FALSE;
+}
+
+scl_bool_t scl_ipc_host_acquire_wait(uint32_t channel, uint32_t timeout_ms)
+{
+    struct timespec deadline;
+    bool acquired = false;
+
+    pthread_once(&scl_host_once, scl_host_init_once);
+    scl_host_deadline(&deadline, timeout_ms);
+    pthread_mutex_lock(&scl_host_ipc.lock);
+    while (true) {
+        if (!scl_host_ipc.channel[channel].locked) {
+            scl_host_ipc.channel[channel].locked = true;
+            acquired = true;
+            break;
+        }
+        if (!scl_host_wait_change((timeout_ms == CY_RTOS_NEVER_TIMEOUT) ? NULL : &deadline)) {
+            break;
+        }
+    }
+    pthread_mutex_unlock(&scl_host_ipc.lock);
+    return acquired ? SCL_TRUE : SCL_FALSE;
+}
+
+scl_bool_t scl_ipc_host_deepsleep_allowed(void)
+{
+    return ((scl_host_ipc.idle == NULL) || scl_host_ipc.idle()) ? SCL_TRUE : SCL_FALSE;
+}
+
+uint32_t cyhal_system_critical_section_enter(void)
+{
+    pthread_once(&scl_host_once, scl_host_init_once);
+    pthread_mutex_lock(&scl_host_critical_section);
+    return 0;
+}
+
+void cyhal_system_critical_section_exit(uint32_t old_state)
+{
+    (void) old_state;
+    pthread_mutex_unlock(&scl_host_critical_section);
+}
+
+DWT_Type *scl_host_dwt(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    scl_host_dwt_regs.CYCCNT = (uint32_t) ((uint64_t) now.tv_sec * SCL_HOST_CORE_CLOCK +
+                                           (uint64_t) now.tv_nsec / (1000000000UL / SCL_HOST_CORE_CLOCK));
+    return &scl_host_dwt_regs;
+}
@@ -0,0 +1,949 @@
+/*
+ * Copyright 2018-2020 Cypress Semiconductor Corporation
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ *  Provides the emulated Network Processor of host builds: one thread serves the commands of SCL,
+ *  another delivers frames, events and status changes to SCL, through the RX ring when SCL
+ *  registered one, a third one consumes the TX ring
+ */
+#include "scl_np_emu.h"
+#include "scl_ipc.h"
+#include "scl_ipc_ring.h"
+#include "scl_ipc_hal_host.h"
+#include "scl_buffer_api.h"
+#include "cyabs_rtos.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/******************************************************
+ **                      Macros
+ *******************************************************/
+#define SCL_NP_EMU_TX_CHANNEL      (10)
+#define SCL_NP_EMU_RX_CHANNEL      (11)
+#define SCL_NP_EMU_DATA_CHANNEL    (12)
+#define SCL_NP_EMU_CHANNEL(ch)     (1UL << (ch))
+/* Interval at which the threads check for scl_np_emu_stop() */
+#define SCL_NP_EMU_POLL_MS         (100)
+/* Time given to SCL to answer an RX message before the emulator gives up */
+#define SCL_NP_EMU_RX_TIMEOUT_MS   (1000)
+#define SCL_NP_EMU_COMPATIBLE      (3)
+
+/******************************************************
+ *        Variables Definitions
+ *****************************************************/
+/* Payloads of the commands, as laid out by SCL */
+struct scl_np_emu_version {
+    uint8_t major;
+    uint8_t minor;
+    uint8_t patch;
+    uint32_t compatibility;
+};
+
+struct scl_np_emu_mac {
+    scl_mac_t *mac;
+    uint32_t retval;
+};
+
+struct scl_np_emu_rssi {
+    uint32_t retval;
+    int32_t *rssi;
+};
+
+struct scl_np_emu_ioctl {
+    uint32_t ioctl;
+    uint32_t value;
+};
+
+struct scl_np_emu_event {
+    scl_event_header_t event_header;
+    const uint8_t *event_data;
+};
+
+struct scl_np_emu_agg_config {
+    uint32_t threshold;
+    uint32_t buffer_size;
+    uint32_t max_frames;
+    uint32_t retval;
+};
+
+struct scl_np_emu_ring_config {
+    uint32_t ring_id;
+    scl_ipc_ring_t *ring;
+    uint32_t retval;
+};
+
+struct scl_np_emu_post_config {
+    scl_ipc_ring_t *ring;
+    uint32_t low_watermark;
+    uint32_t retval;
+};
+
+/* Structure of a message queued for SCL
+ *   next:                 next message of the queue
+ *   index:                receive index
+ *   value:                DATA1 of a message without buffer
+ *   header:               header of an SCL_RX_EVENT_CALLBACK
+ *   length:               length of data
+ *   data:                 frame or event data, follows the structure
+ */
+struct scl_np_emu_message {
+    struct scl_np_emu_message *next;
+    scl_ipc_rx_t index;
+    uint32_t value;
+    scl_event_header_t header;
+    uint32_t length;
+    uint8_t data[];
+};
+
+/* Structure of SCL NP emulator info
+ *   lock:                 protects the queue, quit and stats
+ *   queued:               signaled when a message is queued or the emulator stops
+ *   head, tail:           messages to be delivered to SCL, stats.rx_pending of them
+ *   doorbell:             signaled when SCL rings the TX ring doorbell or the emulator stops
+ *   command_thread:       thread serving the commands of SCL
+ *   rx_thread:            thread delivering the messages to SCL
+ *   tx_thread:            thread consuming the TX ring
+ *   config:               configuration given to scl_np_emu_start()
+ *   agg:                  aggregation parameters of SCL, max_frames is 0 until SCL_TX_AGG_CONFIG
+ *   tx_ring:              TX ring registered by SCL, NULL until SCL_TX_RING_CONFIG
+ *   tx_complete:          TX completion ring registered by SCL, NULL if buffers are reclaimed from the TX ring
+ *   rx_ring:              RX ring registered by SCL, NULL until SCL_TX_RING_CONFIG
+ *   rx_post:              RX buffer post ring registered by SCL, NULL until SCL_TX_RX_POST_CONFIG
+ *   post_low_watermark:   SCL_RX_POST_LOW is sent when fewer buffers are posted
+ *   post_low:             set once SCL_RX_POST_LOW is sent, until the post ring is refilled
+ *   rung:                 set by a doorbell not yet seen by the TX thread
+ *   stats:                counters
+ *   running:              set between scl_np_emu_start() and scl_np_emu_stop()
+ *   quit:                 set to stop the threads
+ */
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t queued;
+    pthread_cond_t doorbell;
+    struct scl_np_emu_message *head;
+    struct scl_np_emu_message *tail;
+    pthread_t command_thread;
+    pthread_t rx_thread;
+    pthread_t tx_thread;
+    scl_np_emu_config_t config;
+    struct scl_np_emu_agg_config agg;
+    scl_ipc_ring_t *tx_ring;
+    scl_ipc_ring_t *tx_complete;
+    scl_ipc_ring_t *rx_ring;
+    scl_ipc_ring_t *rx_post;
+    uint32_t post_low_watermark;
+    bool post_low;
+    bool rung;
+    scl_np_emu_stats_t stats;
+    bool running;
+    bool quit;
+} scl_np_emu_info = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .queued = PTHREAD_COND_INITIALIZER,
+    .doorbell = PTHREAD_COND_INITIALIZER
+};
+
+static const scl_np_emu_config_t scl_np_emu_default_config = {
+    .mac = {{0x02, 0x00, 0x00, 0x00, 0x00, 0x01}},
+    .rssi = -40,
+    .loopback = SCL_TRUE,
+    .turnaround_us = 0
+};
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+
+/** Adds one to a counter */
+static void scl_np_emu_count(uint32_t *counter)
+{
+    pthread_mutex_lock(&scl_np_emu_info.lock);
+    (*counter)++;
+    pthread_mutex_unlock(&scl_np_emu_info.lock);
+}
+
+/** Tells whether scl_np_emu_stop() was called */
+static bool scl_np_emu_quit(void)
+{
+    bool quit;
+
+    pthread_mutex_lock(&scl_np_emu_info.lock);
+    quit = scl_np_emu_info.quit;
+    pthread_mutex_unlock(&scl_np_emu_info.lock);
+    return quit;
+}
+
+/** Queues a message for the RX thread
+ *
+ *  @return  SCL_SUCCESS or SCL_ERROR if the emulator is not running
+ */
+static scl_result_t scl_np_emu_queue(struct scl_np_emu_message *message)
+{
+    message->next = NULL;
+    pthread_mutex_lock(&scl_np_emu_info.lock);
+    if (!scl_np_emu_info.running || scl_np_emu_info.quit) {
+        pthread_mutex_unlock(&scl_np_emu_info.lock);
+        free(message);
+        return SCL_ERROR;
+    }
+    if (scl_np_emu_info.tail == NULL) {
+        scl_np_emu_info.head = message;
+    } else {
+        scl_np_emu_info.tail->next = message;
+    }
+    scl_np_emu_info.tail = message;
+    scl_np_emu_info.stats.rx_pending++;
+    pthread_cond_signal(&scl_np_emu_info.queued);
+    pthread_mutex_unlock(&scl_np_emu_info.lock);
+    return SCL_SUCCESS;
+}
+
+/** Allocates a message with room for length bytes of data */
+static struct scl_np_emu_message *scl_np_emu_message_new(scl_ipc_rx_t index, uint32_t length)
+{
+    struct scl_np_emu_message *message;
+
+    message = (struct scl_np_emu_message *) calloc(1, sizeof(*message) + length);
+    if (message != NULL) {
+        message->index = index;
+        message->length = length;
+    }
+    return message;
+}
+
+/** Hands a transmitted frame to the callback or queues it back to SCL */
+static void scl_np_emu_transmit_done(struct scl_np_emu_message *message)
+{
+    if (scl_np_emu_info.config.tx_callback != NULL) {
+        scl_np_emu_info.config.tx_callback(message->data, message->length, scl_np_emu_info.config.tx_user_data);
+        free(message);
+    } else {
+        (void) scl_np_emu_queue(message);
+    }
+}
+
+/** Copies an SCL_TX_SEND_OUT frame, possibly a chain, and transmits it */
+static void scl_np_emu_transmit(const scl_tx_buf_t *tx_buf)
+{
+    struct scl_np_emu_message *message;
+    scl_buffer_t piece;
+    uint32_t offset = 0;
+    uint32_t size;
+
+    message = scl_np_emu_message_new(SCL_RX_DATA, tx_buf->size);
+    if (message == NULL) {
+        scl_np_emu_count(&scl_np_emu_info.stats.frames_dropped);
+        return;
+    }
+    for (piece = tx_buf->buffer; (piece != NULL) && (offset < tx_buf->size); piece = scl_buffer_get_next_piece(piece)) {
+        size = scl_buffer_get_current_piece_size(piece);
+        if (size > tx_buf->size - offset) {
+            size = tx_buf->size - offset;
+        }
+        memcpy(&message->data[offset], scl_buffer_get_current_piece_data_pointer(piece), size);
+        offset += size;
+    }
+    message->length = offset;
+    scl_np_emu_transmit_done(message);
+}
+
+/** Copies a frame held in one contiguous block, such as a record of an aggregate, and transmits it */
+static void scl_np_emu_transmit_piece(const uint8_t *data, uint32_t length)
+{
+    struct scl_np_emu_message *message;
+
+    message = scl_np_emu_message_new(SCL_RX_DATA, length);
+    if (message == NULL) {
+        scl_np_emu_count(&scl_np_emu_info.stats.frames_dropped);
+        return;
+    }
+    memcpy(message->data, data, length);
+    scl_np_emu_transmit_done(message);
+}
+
+/** Splits an SCL_TX_SEND_OUT_AGG aggregate into its frames and transmits them */
+static void scl_np_emu_transmit_agg(const scl_tx_buf_t *tx_buf)
+{
+    const uint8_t *data = scl_buffer_get_current_piece_data_pointer(tx_buf->buffer);
+    uint32_t offset = 0;
+    uint32_t length;
+
+    scl_np_emu_count(&scl_np_emu_info.stats.tx_aggregates);
+    while ((offset + sizeof(length)) <= tx_buf->size) {
+        memcpy(&length, data + offset, sizeof(length));
+        offset += sizeof(length);
+        if ((length == 0) || (length > tx_buf->size - offset)) {
+            break;
+        }
+        scl_np_emu_count(&scl_np_emu_info.stats.frames_sent);
+        if (scl_np_emu_info.config.loopback || (scl_np_emu_info.config.tx_callback != NULL)) {
+            scl_np_emu_transmit_piece(data + offset, length);
+        }
+        offset += SCL_AGG_RECORD_SIZE(length) - sizeof(length);
+    }
+}
+
+/** Sends one message to SCL on the RX channel and waits until SCL releases it
+ *
+ *  @return  false if SCL did not take the message in time
+ */
+static bool scl_np_emu_send(uint32_t index, uintptr_t data1)
+{
+    if (!scl_ipc_host_acquire_wait(SCL_NP_EMU_RX_CHANNEL, SCL_NP_EMU_RX_TIMEOUT_MS)) {
+        return false;
+    }
+    scl_ipc_hal_write(SCL_NP_EMU_RX_CHANNEL, index, data1);
+    scl_np_emu_count(&scl_np_emu_info.stats.rx_messages);
+    scl_ipc_hal_notify(SCL_NP_EMU_RX_CHANNEL, SCL_NP_EMU_CHANNEL(SCL_NP_EMU_RX_CHANNEL));
+    return scl_ipc_host_wait_unlocked(SCL_NP_EMU_RX_CHANNEL, SCL_NP_EMU_RX_TIMEOUT_MS);
+}
+
+/** Gets a buffer from SCL with SCL_RX_GET_BUFFER
+ *
+ *  @return  the buffer, NULL if SCL has none
+ */
+static scl_buffer_t scl_np_emu_get_buffer(uint32_t length)
+{
+    if (!scl_np_emu_send(SCL_RX_GET_BUFFER, length)) {
+        return NULL;
+    }
+    return (scl_buffer_t) scl_ipc_hal_read_data1(SCL_NP_EMU_RX_CHANNEL);
+}
+
+/** Accepts the rings enabled in the configuration */
+static void scl_np_emu_ring_config(struct scl_np_emu_ring_config *ring_config)
+{
+    scl_bool_t enabled = (ring_config->ring_id == SCL_IPC_RING_RX) ? scl_np_emu_info.config.rx_ring :
+                         scl_np_emu_info.config.tx_ring;
+
+    if (!enabled || (ring_config->ring == NULL)) {
+        return;
+    }
+    pthread_mutex_lock(&scl_np_emu_info.lock);
+    if (ring_config->ring_id == SCL_IPC_RING_RX) {
+        /* SCL armed the doorbell before registering the ring */
+        scl_np_emu_info.rx_ring = ring_config->ring;
+        ring_config->retval = SCL_SUCCESS;
+    } else if (ring_config->ring_id == SCL_IPC_RING_TX) {
+        /* The TX thread is idle until the first frame, ask for a doorbell */
+        (void) scl_ipc_ring_arm_doorbell(ring_config->ring);
+        scl_np_emu_info.tx_ring = ring_config->ring;
+        ring_config->retval = SCL_SUCCESS;
+    } else if ((ring_config->ring_id == SCL_IPC_RING_TX_COMPLETE) && (scl_np_emu_info.tx_ring != NULL)) {
+        scl_np_emu_info.tx_complete = ring_config->ring;
+        ring_config->retval = SCL_SUCCESS;
+    }
+    pthread_mutex_unlock(&scl_np_emu_info.lock);
+}
+
+/** Takes the RX buffers of SCL from the post ring, once the RX ring is accepted */
+static void scl_np_emu_post_config(struct scl_np_emu_post_config *post_config)
+{
+    if (post_config->ring == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&scl_np_emu_info.lock);
+    if (scl_np_emu_info.rx_ring != NULL) {
+        scl_np_emu_info.rx_post = post_config->ring;
+        scl_np_emu_info.post_low_watermark = post_config->low_watermark;
+        scl_np_emu_info.post_low = false;
+        post_config->retval = SCL_SUCCESS;
+    }
+    pthread_mutex_unlock(&scl_np_emu_info.lock);
+}
+
+/** Tells SCL that a ring it waits on has changed, with SCL_RX_RING_DOORBELL */
+static void scl_np_emu_ring_notify(void)
+{
+    if (scl_np_emu_send(SCL_RX_RING_DOORBELL, 0)) {
+        scl_np_emu_count(&scl_np_emu_info.stats.ring_notifications);
+    }
+}
+
+/** Transmits the frame of a TX ring descriptor */
+static void scl_np_emu_transmit_desc(const scl_ipc_desc_t *desc)
+{
+    scl_tx_buf_t tx_buf;
+
+    tx_buf.buffer = (scl_buffer_t) desc->buffer;
+    tx_buf.size = desc->length;
+    tx_buf.priority = 0;
+    if (desc->index == SCL_TX_SEND_OUT_AGG) {
+        scl_np_emu_transmit_agg(&tx_buf);
+        return;
+    }
+    scl_np_emu_count(&scl_np_emu_info.stats.frames_sent);
+    if ((desc->index == SCL_TX_SEND_OUT) &&
+        (scl_np_emu_info.config.loopback || (scl_np_emu_info.config.tx_callback != NULL))) {
+        scl_np_emu_transmit(&tx_buf);
+    }
+}
+
+/** Transmits the frames queued in the TX ring and reports their buffers
+ *
+ *  A slot is handed back only once its frame is copied, since SCL may release
+ *  the buffer as soon as the tail passes it when there is no completion ring.
+ *
+ *  @return  number of descriptors consumed
+ */
+static uint32_t scl_np_emu_tx_ring_drain(scl_ipc_ring_t *ring, scl_ipc_ring_t *complete)
+{
+    scl_ipc_desc_t desc;
+    uint32_t consumed = 0;
+
+    while (ring->tail != ring->head) {
+        SCL_IPC_MEMORY_BARRIER();
+        desc = *SCL_IPC_RING_DESC(ring, ring->tail);
+        scl_np_emu_transmit_desc(&desc);
+        (void) scl_ipc_ring_get(ring, &desc);
+        consumed++;
+        if (complete == NULL) {
+            continue;
+        }
+        /* SCL keeps fewer buffers in flight than the completion ring holds */
+        while ((scl_ipc_ring_put(complete, &desc) != SCL_SUCCESS) && !scl_np_emu_quit()) {
+            sched_yield();
+        }
+        scl_np_emu_count(&scl_np_emu_info.stats.completions);
+    }
+    return consumed;
+}
+
+/** Thread consuming the TX ring after a doorbell, until the ring stays empty */
+static void *scl_np_emu_tx_thread(void *arg)
+{
+    scl_ipc_ring_t *ring;
+    scl_ipc_ring_t *complete;
+
+    (void) arg;
+    while (true) {
+        pthread_mutex_lock(&scl_np_emu_info.lock);
+        while (!scl_np_emu_info.rung && !scl_np_emu_info.quit) {
+            pthread_cond_wait(&scl_np_emu_info.doorbell, &scl_np_emu_info.lock);
+        }
+        if (scl_np_emu_info.quit) {
+            pthread_mutex_unlock(&scl_np_emu_info.lock);
+            break;
+        }
+        scl_np_emu_info.rung = false;
+        ring = scl_np_emu_info.tx_ring;
+        complete = scl_np_emu_info.tx_complete;
+        pthread_mutex_unlock(&scl_np_emu_info.lock);
+        if (ring == NULL) {
+            continue;
+        }
+
+        scl_ipc_ring_disarm_doorbell(ring);
+        while (!scl_np_emu_quit()) {
+            /* Room for a waiting sender, or completions SCL asked to hear about */
+            if ((scl_np_emu_tx_ring_drain(ring, complete) != 0) &&
+                (scl_ipc_ring_room_needed(ring) || ((complete != NULL) && scl_ipc_ring_doorbell_needed(complete)))) {
+                scl_np_emu_ring_notify();
+            }
+            /* Sleep only if no frame was queued while the doorbell was being armed */
+            if (scl_ipc_ring_arm_doorbell(ring)) {
+                break;
+            }
+            scl_ipc_ring_disarm_doorbell(ring);
+        }
+    }
+    return NULL;
+}
+
+/** Serves one command of SCL, before the channel is released */
+static void scl_np_emu_command(uint32_t index, void *buffer)
+{
+    scl_np_emu_count(&scl_np_emu_info.stats.commands);
+    switch (index) {
+        case SCL_TX_SCL_VERSION_NUMBER: {
+            ((struct scl_np_emu_version *) buffer)->compatibility = SCL_NP_EMU_COMPATIBLE;
+            break;
+        }
+        case SCL_TX_TRANSCEIVE_READY:
+        case SCL_TX_WIFI_SET_UP: {
+            *(scl_result_t *) buffer = SCL_SUCCESS;
+            break;
+        }
+        case SCL_TX_WIFI_ON: {
+            *(bool *) buffer = true;
+            break;
+        }
+        case SCL_TX_GET_MAC: {
+            struct scl_np_emu_mac *mac = (struct scl_np_emu_mac *) buffer;
+
+            *mac->mac = scl_np_emu_info.config.mac;
+            mac->retval = SCL_SUCCESS;
+            break;
+        }
+        case SCL_TX_WIFI_GET_RSSI: {
+            struct scl_np_emu_rssi *rssi = (struct scl_np_emu_rssi *) buffer;
+
+            *rssi->rssi = scl_np_emu_info.config.rssi;
+            rssi->retval = SCL_SUCCESS;
+            break;
+        }
+        case SCL_TX_SET_IOCTL_VALUE: {
+            struct scl_np_emu_ioctl *ioctl = (struct scl_np_emu_ioctl *) buffer;
+
+            pthread_mutex_lock(&scl_np_emu_info.lock);
+            scl_np_emu_info.stats.last_ioctl = ioctl->ioctl;
+            scl_np_emu_info.stats.last_ioctl_value = ioctl->value;
+            pthread_mutex_unlock(&scl_np_emu_info.lock);
+            break;
+        }
+        case SCL_TX_SEND_OUT: {
+            scl_np_emu_count(&scl_np_emu_info.stats.frames_sent);
+            if ((buffer != NULL) &&
+                (scl_np_emu_info.config.loopback || (scl_np_emu_info.config.tx_callback != NULL))) {
+                scl_np_emu_transmit((const scl_tx_buf_t *) buffer);
+            }
+            break;
+        }
+        case SCL_TX_AGG_CONFIG: {
+            struct scl_np_emu_agg_config *agg_config = (struct scl_np_emu_agg_config *) buffer;
+
+            if (scl_np_emu_info.config.aggregation && (agg_config->max_frames != 0)) {
+                pthread_mutex_lock(&scl_np_emu_info.lock);
+                scl_np_emu_info.agg = *agg_config;
+                pthread_mutex_unlock(&scl_np_emu_info.lock);
+                agg_config->retval = SCL_SUCCESS;
+            }
+            break;
+        }
+        case SCL_TX_SEND_OUT_AGG: {
+            if (buffer != NULL) {
+                scl_np_emu_transmit_agg((const scl_tx_buf_t *) buffer);
+            }
+            break;
+        }
+        case SCL_TX_RING_CONFIG: {
+            scl_np_emu_ring_config((struct scl_np_emu_ring_config *) buffer);
+            break;
+        }
+        case SCL_TX_RX_POST_CONFIG: {
+            scl_np_emu_post_config((struct scl_np_emu_post_config *) buffer);
+            break;
+        }
+        case SCL_TX_RING_DOORBELL: {
+            pthread_mutex_lock(&scl_np_emu_info.lock);
+            scl_np_emu_info.stats.doorbells++;
+            scl_np_emu_info.rung = true;
+            pthread_cond_signal(&scl_np_emu_info.doorbell);
+            pthread_mutex_unlock(&scl_np_emu_info.lock);
+            break;
+        }
+        default: {
+            /* Configuration commands keep their SCL_UNSUPPORTED retval, others are acknowledged */
+            break;
+        }
+    }
+}
+
+/** Thread serving the commands of SCL on the control and data channels */
+static void *scl_np_emu_command_thread(void *arg)
+{
+    const uint32_t channels = SCL_NP_EMU_CHANNEL(SCL_NP_EMU_TX_CHANNEL) | SCL_NP_EMU_CHANNEL(SCL_NP_EMU_DATA_CHANNEL);
+    struct timespec turnaround;
+    uint32_t notified;
+    uint32_t channel;
+
+    (void) arg;
+    turnaround.tv_sec = scl_np_emu_info.config.turnaround_us / 1000000UL;
+    turnaround.tv_nsec = (long) (scl_np_emu_info.config.turnaround_us % 1000000UL) * 1000L;
+    while (!scl_np_emu_quit()) {
+        notified = scl_ipc_host_wait_notify(channels, SCL_NP_EMU_POLL_MS);
+        for (channel = 0; notified != 0; channel++) {
+            if (!(notified & SCL_NP_EMU_CHANNEL(channel))) {
+                continue;
+            }
+            notified &= ~SCL_NP_EMU_CHANNEL(channel);
+            if (scl_np_emu_info.config.turnaround_us != 0) {
+                nanosleep(&turnaround, NULL);
+            }
+            scl_np_emu_command(scl_ipc_hal_read_data0(channel), (void *) scl_ipc_hal_read_data1(channel));
+            scl_ipc_hal_release(channel, SCL_NP_EMU_CHANNEL(channel));
+        }
+    }
+    return NULL;
+}
+
+/** Takes an RX buffer of at least length bytes, from the post ring if SCL registered one
+ *
+ *  SCL_RX_POST_LOW is sent once the post ring falls below its low watermark, and falls back to
+ *  SCL_RX_GET_BUFFER while the post ring is empty or its buffers are too small.
+ *
+ *  @return  the buffer, NULL if SCL has none
+ */
+static scl_buffer_t scl_np_emu_rx_buffer(uint32_t length)
+{
+    scl_ipc_ring_t *post = scl_np_emu_info.rx_post;
+    scl_ipc_desc_t desc;
+    bool low;
+
+    if ((post == NULL) || (post->tail == post->head)) {
+        return scl_np_emu_get_buffer(length);
+    }
+    SCL_IPC_MEMORY_BARRIER();
+    if (SCL_IPC_RING_DESC(post, post->tail)->length < length) {
+        return scl_np_emu_get_buffer(length);
+    }
+    (void) scl_ipc_ring_get(post, &desc);
+    scl_np_emu_count(&scl_np_emu_info.stats.posted_buffers);
+
+    /* Signal the watermark once, until SCL refills the ring above it */
+    pthread_mutex_lock(&scl_np_emu_info.lock);
+    low = scl_ipc_ring_count(post) < scl_np_emu_info.post_low_watermark;
+    if (!low) {
+        scl_np_emu_info.post_low = false;
+    } else if (!scl_np_emu_info.post_low) {
+        scl_np_emu_info.post_low = true;
+    } else {
+        low = false;
+    }
+    pthread_mutex_unlock(&scl_np_emu_info.lock);
+    if (low && scl_np_emu_send(SCL_RX_POST_LOW, 0)) {
+        scl_np_emu_count(&scl_np_emu_info.stats.post_low);
+    }
+    return (scl_buffer_t) desc.buffer;
+}
+
+/** Delivers a buffer to SCL in the RX ring if SCL registered one, or with an RX message
+ *
+ *  @return  false if SCL did not take the buffer
+ */
+static bool scl_np_emu_rx_post(uint32_t index, scl_buffer_t buffer, uint32_t length)
+{
+    scl_ipc_ring_t *ring = scl_np_emu_info.rx_ring;
+    scl_ipc_desc_t desc;
+
+    if (ring == NULL) {
+        return scl_np_emu_send(index, (uintptr_t) buffer);
+    }
+    desc.index = index;
+    desc.length = length;
+    desc.buffer = buffer;
+    /* Wait for SCL to drain the ring, as NP holds the frame until then */
+    while (scl_ipc_ring_put(ring, &desc) != SCL_SUCCESS) {
+        if (scl_np_emu_quit()) {
+            return false;
+        }
+        sched_yield();
+    }
+    if (scl_ipc_ring_doorbell_needed(ring)) {
+        scl_np_emu_ring_notify();
+    }
+    return true;
+}
+
+/** Tells whether a queued message may be delivered in an aggregate
+ *  Called with the emulator lock held.
+ */
+static bool scl_np_emu_aggregatable(const struct scl_np_emu_message *message)
+{
+    return (message != NULL) && (message->index == SCL_RX_DATA) && (scl_np_emu_info.agg.max_frames != 0) &&
+           (message->length <= scl_np_emu_info.agg.threshold);
+}
+
+/** Delivers a small frame together with the small frames queued behind it in one SCL_RX_DATA_AGG
+ *
+ *  @return  true if the frame was delivered, false if it is alone and goes with SCL_RX_DATA
+ */
+static bool scl_np_emu_deliver_agg(const struct scl_np_emu_message *message)
+{
+    struct scl_np_emu_message *batch[SCL_AGG_MAX_FRAMES];
+    struct scl_np_emu_message *next;
+    scl_buffer_t buffer;
+    uint8_t *data;
+    uint32_t frames = 0;
+    uint32_t length = SCL_AGG_RECORD_SIZE(message->length);
+    uint32_t offset = 0;
+    uint32_t i;
+
+    pthread_mutex_lock(&scl_np_emu_info.lock);
+    if (scl_np_emu_aggregatable(message)) {
+        while ((frames < (SCL_AGG_MAX_FRAMES - 1)) && ((frames + 1) < scl_np_emu_info.agg.max_frames)) {
+            next = scl_np_emu_info.head;
+            if (!scl_np_emu_aggregatable(next) ||
+                ((length + SCL_AGG_RECORD_SIZE(next->length)) > scl_np_emu_info.agg.buffer_size)) {
+                break;
+            }
+            length += SCL_AGG_RECORD_SIZE(next->length);
+            scl_np_emu_info.head = next->next;
+            if (scl_np_emu_info.head == NULL) {
+                scl_np_emu_info.tail = NULL;
+            }
+            scl_np_emu_info.stats.rx_pending--;
+            batch[frames++] = next;
+        }
+    }
+    pthread_mutex_unlock(&scl_np_emu_info.lock);
+    if (frames == 0) {
+        return false;
+    }
+
+    buffer = scl_np_emu_rx_buffer(length);
+    if (buffer != NULL) {
+        data = scl_buffer_get_current_piece_data_pointer(buffer);
+        for (i = 0; i <= frames; i++) {
+            next = (i == 0) ? (struct scl_np_emu_message *) message : batch[i - 1];
+            memcpy(data + offset, &next->length, sizeof(next->length));
+            memcpy(data + offset + sizeof(next->length), next->data, next->length);
+            offset += SCL_AGG_RECORD_SIZE(next->length);
+        }
+    }
+    if ((buffer != NULL) && scl_np_emu_rx_post(SCL_RX_DATA_AGG, buffer, length)) {
+        pthread_mutex_lock(&scl_np_emu_info.lock);
+        scl_np_emu_info.stats.rx_aggregates++;
+        scl_np_emu_info.stats.frames_received += frames + 1;
+        pthread_mutex_unlock(&scl_np_emu_info.lock);
+    } else {
+        pthread_mutex_lock(&scl_np_emu_info.lock);
+        scl_np_emu_info.stats.frames_dropped += frames + 1;
+        pthread_mutex_unlock(&scl_np_emu_info.lock);
+    }
+    for (i = 0; i < frames; i++) {
+        free(batch[i]);
+    }
+    return true;
+}
+
+/** Delivers one queued message to SCL */
+static void scl_np_emu_deliver(const struct scl_np_emu_message *message)
+{
+    struct scl_np_emu_event *event;
+    scl_buffer_t buffer;
+    uint8_t *data;
+
+    switch (message->index) {
+        case SCL_RX_DATA: {
+            if (scl_np_emu_deliver_agg(message)) {
+                break;
+            }
+            buffer = scl_np_emu_rx_buffer(message->length);
+            if (buffer == NULL) {
+                scl_np_emu_count(&scl_np_emu_info.stats.frames_dropped);
+                break;
+            }
+            memcpy(scl_buffer_get_current_piece_data_pointer(buffer), message->data, message->length);
+            if (scl_np_emu_rx_post(SCL_RX_DATA, buffer, message->length)) {
+                scl_np_emu_count(&scl_np_emu_info.stats.frames_received);
+            } else {
+                scl_np_emu_count(&scl_np_emu_info.stats.frames_dropped);
+            }
+            break;
+        }
+        case SCL_RX_EVENT_CALLBACK: {
+            /* The event data follows the callback data in the same buffer, SCL releases both */
+            buffer = scl_np_emu_get_buffer(sizeof(*event) + message->length);
+            if (buffer == NULL) {
+                break;
+            }
+            event = (struct scl_np_emu_event *) scl_buffer_get_current_piece_data_pointer(buffer);
+            data = (uint8_t *) (event + 1);
+            memcpy(&event->event_header, &message->header, sizeof(event->event_header));
+            memcpy(data, message->data, message->length);
+            event->event_data = data;
+            if (scl_np_emu_send(SCL_RX_EVENT_CALLBACK, (uintptr_t) buffer)) {
+                scl_np_emu_count(&scl_np_emu_info.stats.events);
+            }
+            break;
+        }
+        default: {
+            if (scl_np_emu_send(message->index, message->value)) {
+                scl_np_emu_count(&scl_np_emu_info.stats.events);
+            }
+            break;
+        }
+    }
+}
+
+/** Thread delivering the queued messages to SCL, one at a time as the RX channel allows */
+static void *scl_np_emu_rx_thread(void *arg)
+{
+    struct scl_np_emu_message *message;
+
+    (void) arg;
+    pthread_mutex_lock(&scl_np_emu_info.lock);
+    while (!scl_np_emu_info.quit) {
+        message = scl_np_emu_info.head;
+        if (message == NULL) {
+            pthread_cond_wait(&scl_np_emu_info.queued, &scl_np_emu_info.lock);
+            continue;
+        }
+        scl_np_emu_info.head = message->next;
+        if (scl_np_emu_info.head == NULL) {
+            scl_np_emu_info.tail = NULL;
+        }
+        pthread_mutex_unlock(&scl_np_emu_info.lock);
+        scl_np_emu_deliver(message);
+        free(message);
+        pthread_mutex_lock(&scl_np_emu_info.lock);
+        scl_np_emu_info.stats.rx_pending--;
+    }
+    pthread_mutex_unlock(&scl_np_emu_info.lock);
+    return NULL;
+}
+
+scl_result_t scl_np_emu_start(const scl_np_emu_config_t *config)
+{
+    pthread_mutex_lock(&scl_np_emu_info.lock);
+    if (scl_np_emu_info.running) {
+        pthread_mutex_unlock(&scl_np_emu_info.lock);
+        return SCL_ERROR;
+    }
+    scl_np_emu_info.config = (config != NULL) ? *config : scl_np_emu_default_config;
+    memset(&scl_np_emu_info.stats, 0, sizeof(scl_np_emu_info.stats));
+    memset(&scl_np_emu_info.agg, 0, sizeof(scl_np_emu_info.agg));
+    scl_np_emu_info.tx_ring = NULL;
+    scl_np_emu_info.tx_complete = NULL;
+    scl_np_emu_info.rx_ring = NULL;
+    scl_np_emu_info.rx_post = NULL;
+    scl_np_emu_info.post_low = false;
+    scl_np_emu_info.rung = false;
+    scl_np_emu_info.quit = false;
+    scl_np_emu_info.running = true;
+    pthread_mutex_unlock(&scl_np_emu_info.lock);
+
+    if (pthread_create(&scl_np_emu_info.command_thread, NULL, scl_np_emu_command_thread, NULL) != 0) {
+        scl_np_emu_info.running = false;
+        return SCL_ERROR;
+    }
+    if (pthread_create(&scl_np_emu_info.rx_thread, NULL, scl_np_emu_rx_thread, NULL) != 0) {
+        pthread_mutex_lock(&scl_np_emu_info.lock);
+        scl_np_emu_info.quit = true;
+        pthread_mutex_unlock(&scl_np_emu_info.lock);
+        pthread_join(scl_np_emu_info.command_thread, NULL);
+        scl_np_emu_info.running = false;
+        return SCL_ERROR;
+    }
+    if (pthread_create(&scl_np_emu_info.tx_thread, NULL, scl_np_emu_tx_thread, NULL) != 0) {
+        pthread_mutex_lock(&scl_np_emu_info.lock);
+        scl_np_emu_info.quit = true;
+        pthread_cond_broadcast(&scl_np_emu_info.queued);
+        pthread_mutex_unlock(&scl_np_emu_info.lock);
+        pthread_join(scl_np_emu_info.command_thread, NULL);
+        pthread_join(scl_np_emu_info.rx_thread, NULL);
+        scl_np_emu_info.running = false;
+        return SCL_ERROR;
+    }
+    return SCL_SUCCESS;
+}
+
+void scl_np_emu_stop(void)
+{
+    struct scl_np_emu_message *message;
+
+    pthread_mutex_lock(&scl_np_emu_info.lock);
+    if (!scl_np_emu_info.running) {
+        pthread_mutex_unlock(&scl_np_emu_info.lock);
+        return;
+    }
+    scl_np_emu_info.quit = true;
+    pthread_cond_broadcast(&scl_np_emu_info.queued);
+    pthread_cond_broadcast(&scl_np_emu_info.doorbell);
+    pthread_mutex_unlock(&scl_np_emu_info.lock);
+
+    pthread_join(scl_np_emu_info.command_thread, NULL);
+    pthread_join(scl_np_emu_info.rx_thread, NULL);
+    pthread_join(scl_np_emu_info.tx_thread, NULL);
+
+    pthread_mutex_lock(&scl_np_emu_info.lock);
+    while (scl_np_emu_info.head != NULL) {
+        message = scl_np_emu_info.head;
+        scl_np_emu_info.head = message->next;
+        free(message);
+    }
+    scl_np_emu_info.tail = NULL;
+    scl_np_emu_info.stats.rx_pending = 0;
+    scl_np_emu_info.running = false;
+    pthread_mutex_unlock(&scl_np_emu_info.lock);
+}
+
+scl_result_t scl_np_emu_inject_frame(const uint8_t *data, uint32_t length)
+{
+    struct scl_np_emu_message *message;
+
+    if ((data == NULL) || (length == 0)) {
+        return SCL_BADARG;
+    }
+    message = scl_np_emu_message_new(SCL_RX_DATA, length);
+    if (message == NULL) {
+        return SCL_ERROR;
+    }
+    memcpy(message->data, data, length);
+    return scl_np_emu_queue(message);
+}
+
+scl_result_t scl_np_emu_inject_event(const scl_event_header_t *header, const uint8_t *data)
+{
+    struct scl_np_emu_message *message;
+
+    if ((header == NULL) || ((data == NULL) && (header->datalen != 0))) {
+        return SCL_BADARG;
+    }
+    message = scl_np_emu_message_new(SCL_RX_EVENT_CALLBACK, header->datalen);
+    if (message == NULL) {
+        return SCL_ERROR;
+    }
+    message->header = *header;
+    if (header->datalen != 0) {
+        memcpy(message->data, data, header->datalen);
+    }
+    return scl_np_emu_queue(message);
+}
+
+scl_result_t scl_np_emu_inject_status(scl_ipc_rx_t index, uint32_t value)
+{
+    struct scl_np_emu_message *message;
+
+    message = scl_np_emu_message_new(index, 0);
+    if (message == NULL) {
+        return SCL_ERROR;
+    }
+    message->value = value;
+    return scl_np_emu_queue(message);
+}
+
+/** Returns the CPU time used by a thread, in microseconds */
+static uint64_t scl_np_emu_cpu_time(pthread_t thread)
+{
+    clockid_t clock;
+    struct timespec time;
+
+    if ((pthread_getcpuclockid(thread, &clock) != 0) || (clock_gettime(clock, &time) != 0)) {
+        return 0;
+    }
+    return (uint64_t) time.tv_sec * 1000000ULL + (uint64_t) time.tv_nsec / 1000ULL;
+}
+
+void scl_np_emu_get_stats(scl_np_emu_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&scl_np_emu_info.lock);
+    *stats = scl_np_emu_info.stats;
+    if (scl_np_emu_info.running && !scl_np_emu_info.quit) {
+        stats->cpu_time_us = scl_np_emu_cpu_time(scl_np_emu_info.command_thread) +
+                             scl_np_emu_cpu_time(scl_np_emu_info.rx_thread) +
+                             scl_np_emu_cpu_time(scl_np_emu_info.tx_thread);
+    }
+    pthread_mutex_unlock(&scl_np_emu_info.lock);
+}
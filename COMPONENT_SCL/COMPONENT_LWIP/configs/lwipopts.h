@@ -254,6 +254,17 @@
  */
 #define LWIP_TCPIP_CORE_LOCKING_INPUT   0
 
+/**
+ * With SCL_RX_DIRECT_INPUT_ENABLE, the core lock is taken through SCL so that the SCL thread
+ * knows when it is free and can feed received frames to lwIP itself, see scl_rx_input.h.
+ */
+#if defined(SCL_RX_DIRECT_INPUT_ENABLE) && (SCL_RX_DIRECT_INPUT_ENABLE)
+void scl_tcpip_core_lock(void);
+void scl_tcpip_core_unlock(void);
+#define LOCK_TCPIP_CORE()               scl_tcpip_core_lock()
+#define UNLOCK_TCPIP_CORE()             scl_tcpip_core_unlock()
+#endif
+
 /**
  * LWIP_NETIF_API==1: Support netif api (in netifapi.c)
  */
@@ -261,7 +272,28 @@
 
 #define LWIP_DNS                       (1)
 
+//
+// With scatter-gather transmit SCL passes pbuf chains to NP as they are
+//
+#if defined(SCL_TX_SG_ENABLE) && (SCL_TX_SG_ENABLE)
+#define LWIP_NETIF_TX_SINGLE_PBUF      (0)
+#else
 #define LWIP_NETIF_TX_SINGLE_PBUF      (1)
+#endif
+
+//
+// SCL buffer pools hand out custom pbufs, lwIP decides otherwise
+//
+#if defined(SCL_BUFFER_POOL_ENABLE) && (SCL_BUFFER_POOL_ENABLE)
+#define LWIP_SUPPORT_CUSTOM_PBUF       (1)
+#endif
+
+/**
+ * Wakes the callers of scl_host_buffer_get() waiting for a buffer when an exhausted lwIP pool,
+ * such as PBUF_POOL, gets an element back, see scl_buffer_api.h.
+ */
+void scl_buffer_memp_available(int type);
+#define LWIP_HOOK_MEMP_AVAILABLE(memp_t_type)  scl_buffer_memp_available((int) (memp_t_type))
 
 #define LWIP_RAND               rand
 
@@ -213,7 +213,12 @@ typedef enum {
     SCL_RX_GET_BUFFER            = 2,      /**< Get the buffer */
     SCL_RX_GET_CONNECTION_STATUS = 3,      /**< Get the connection status */
     SCL_RX_SCAN_STATUS           = 4,      /**< Get the scan status */
-    SCL_RX_EVENT_CALLBACK        = 5       /**< Get the wifi event callback*/
+    SCL_RX_EVENT_CALLBACK        = 5,      /**< Get the wifi event callback*/
+    SCL_RX_CONTROL_COMPLETE      = 6,      /**< Reply to a tagged control request */
+    SCL_RX_RING_DOORBELL         = 7,      /**< New descriptors in a ring filled by NP, or room in the TX ring */
+    SCL_RX_POST_LOW              = 8,      /**< RX buffer post ring below its low watermark */
+    SCL_RX_CREDIT_UPDATE         = 9,      /**< TX credits granted while SCL was flow controlled */
+    SCL_RX_DATA_AGG              = 10      /**< Received aggregate of small frames */
 } scl_ipc_rx_t;
 
 /**
@@ -241,6 +246,16 @@ typedef enum {
     SCL_TX_SET_IOCTL_VALUE             = 19, /**< Set WHD IOCTL Value */
     SCL_TX_WIFI_JOIN                   = 20, /**< Join the Wi-Fi network */
     SCL_TX_SET_EVENT_HANDLER           = 21, /**< Set the event handler */
+    SCL_TX_RING_CONFIG                 = 22, /**< Register a shared-memory descriptor ring */
+    SCL_TX_RING_DOORBELL               = 23, /**< Notify NP of new descriptors in a ring */
+    SCL_TX_TAG_CONFIG                  = 24, /**< Enable tagged control requests */
+    SCL_TX_CHANNEL_CONFIG              = 25, /**< Move the data path to its own IPC channel */
+    SCL_TX_RX_POST_CONFIG              = 26, /**< Register the ring of pre-posted RX buffers */
+    SCL_TX_SG_CONFIG                   = 27, /**< Enable scatter-gather transmit */
+    SCL_TX_SEND_OUT_SG                 = 28, /**< Transmit a frame described by a scatter-gather list */
+    SCL_TX_CREDIT_CONFIG               = 29, /**< Enable credit-based TX flow control */
+    SCL_TX_AGG_CONFIG                  = 30, /**< Enable small-frame aggregation */
+    SCL_TX_SEND_OUT_AGG                = 31, /**< Transmit an aggregate of small frames */
     SCL_TX_DHM_CP_REGISTER             = 50, /**< Register a thread with DHM on NP */
     SCL_TX_DHM_CP_HEART_BEAT           = 51  /**< Send heartbeat messages to DHM on NP */
 } scl_ipc_tx_t;
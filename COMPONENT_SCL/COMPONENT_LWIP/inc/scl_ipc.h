@@ -56,6 +56,26 @@ extern "C"
  * Default timeout value (in seconds) for Wi-Fi disconnection
  */
 #define NW_DISCONNECT_TIMEOUT                  (30)
+/**
+ * Default timeout value (in ms) for commands handled by the Wi-Fi driver of the Network Processor
+ */
+#ifndef SCL_IOCTL_TIMEOUT
+#define SCL_IOCTL_TIMEOUT                      (1000)
+#endif
+/**
+ * Default timeout value (in ms) for the Network Processor to accept a scan request
+ */
+#ifndef SCL_SCAN_TIMEOUT
+#define SCL_SCAN_TIMEOUT                       (10000)
+#endif
+/**
+ * Passed as timeout to scl_send_data to use the default timeout of the command
+ */
+#define SCL_SEND_TIMEOUT_DEFAULT               (0)
+/**
+ * Number of command indexes for which send timeouts are counted
+ */
+#define SCL_SEND_TIMEOUT_INDEX_MAX             (64)
 /**
  * Default interval (in micro seconds) for polling the Network Processor
  */
@@ -64,6 +84,273 @@ extern "C"
  * Default parameter length
  */
 #define PARAM_LEN                              (20)
+/**
+ * Enables the shared-memory TX descriptor ring for SCL_TX_SEND_OUT frames.
+ * SCL falls back to the one-shot IPC handshake if the Network Processor does not accept the ring.
+ */
+#ifndef SCL_TX_RING_ENABLE
+#define SCL_TX_RING_ENABLE                     (0)
+#endif
+/**
+ * Number of descriptors in the TX ring (power of two)
+ */
+#ifndef SCL_TX_RING_SIZE
+#define SCL_TX_RING_SIZE                       (32)
+#endif
+/**
+ * Enables the TX completion ring: the Network Processor reports the SCL_TX_SEND_OUT buffers it has
+ * finished with, instead of SCL releasing them as soon as their TX descriptor is consumed.
+ * Requires SCL_TX_RING_ENABLE.
+ */
+#ifndef SCL_TX_COMPLETE_ENABLE
+#define SCL_TX_COMPLETE_ENABLE                 (0)
+#endif
+/**
+ * Number of descriptors in the TX completion ring (power of two)
+ */
+#ifndef SCL_TX_COMPLETE_RING_SIZE
+#define SCL_TX_COMPLETE_RING_SIZE              (64)
+#endif
+/**
+ * Maximum number of TX buffers handed to the Network Processor and not yet completed.
+ * Senders wait only when this budget is used up.
+ */
+#ifndef SCL_TX_INFLIGHT_MAX
+#define SCL_TX_INFLIGHT_MAX                    (SCL_TX_COMPLETE_RING_SIZE)
+#endif
+/**
+ * Enables TX doorbell coalescing: frames queued in the TX ring while the Network Processor waits for a doorbell
+ * are notified together, once per batch or window, instead of one doorbell per frame. Requires SCL_TX_RING_ENABLE.
+ */
+#ifndef SCL_TX_DOORBELL_COALESCE_ENABLE
+#define SCL_TX_DOORBELL_COALESCE_ENABLE        (0)
+#endif
+/**
+ * Default number of waiting frames that rings the TX ring doorbell at once (1 disables coalescing)
+ */
+#ifndef SCL_TX_DOORBELL_BATCH
+#define SCL_TX_DOORBELL_BATCH                  (8)
+#endif
+/**
+ * Default time (in ms) a frame may wait for the TX ring doorbell (0 disables coalescing)
+ */
+#ifndef SCL_TX_DOORBELL_WINDOW_MS
+#define SCL_TX_DOORBELL_WINDOW_MS              (1)
+#endif
+/**
+ * 802.1D user priority from which a frame rings the TX ring doorbell without waiting
+ */
+#ifndef SCL_TX_DOORBELL_URGENT_PRIORITY
+#define SCL_TX_DOORBELL_URGENT_PRIORITY        (6)
+#endif
+/**
+ * Enables the shared-memory RX completion ring, drained in batches by the SCL thread.
+ * SCL keeps receiving one message per interrupt if the Network Processor does not accept the ring.
+ */
+#ifndef SCL_RX_RING_ENABLE
+#define SCL_RX_RING_ENABLE                     (0)
+#endif
+/**
+ * Number of descriptors in the RX ring (power of two)
+ */
+#ifndef SCL_RX_RING_SIZE
+#define SCL_RX_RING_SIZE                       (64)
+#endif
+/**
+ * Maximum number of RX descriptors processed before the SCL thread yields
+ */
+#ifndef SCL_RX_BUDGET
+#define SCL_RX_BUDGET                          (16)
+#endif
+/**
+ * Default interval (in ms) between two polls of the RX ring in polling mode
+ */
+#ifndef SCL_RX_POLL_INTERVAL_MS
+#define SCL_RX_POLL_INTERVAL_MS                (1)
+#endif
+/**
+ * Default number of descriptors per wakeup that switches the RX ring to polling mode (0 disables moderation)
+ */
+#ifndef SCL_RX_MODERATION_HIGH
+#define SCL_RX_MODERATION_HIGH                 (8)
+#endif
+/**
+ * Default number of descriptors per poll below which a poll counts as idle
+ */
+#ifndef SCL_RX_MODERATION_LOW
+#define SCL_RX_MODERATION_LOW                  (2)
+#endif
+/**
+ * Default number of consecutive idle polls that switches the RX ring back to interrupt mode
+ */
+#ifndef SCL_RX_MODERATION_IDLE_POLLS
+#define SCL_RX_MODERATION_IDLE_POLLS           (4)
+#endif
+/**
+ * Enables a ring of RX buffers pre-posted to the Network Processor, replacing the SCL_RX_GET_BUFFER handshake.
+ * Requires SCL_RX_RING_ENABLE. NP keeps asking for buffers if it does not accept the ring or the ring runs empty.
+ */
+#ifndef SCL_RX_POST_ENABLE
+#define SCL_RX_POST_ENABLE                     (0)
+#endif
+/**
+ * Number of descriptors in the RX buffer post ring (power of two)
+ */
+#ifndef SCL_RX_POST_RING_SIZE
+#define SCL_RX_POST_RING_SIZE                  (16)
+#endif
+/**
+ * Size of each pre-posted RX buffer, large enough for one Ethernet frame
+ */
+#ifndef SCL_RX_POST_BUFFER_SIZE
+#define SCL_RX_POST_BUFFER_SIZE                (SCL_LINK_MTU)
+#endif
+/**
+ * Minimum number of free descriptors before the SCL thread refills the post ring
+ */
+#ifndef SCL_RX_POST_BATCH
+#define SCL_RX_POST_BATCH                      (4)
+#endif
+/**
+ * Number of posted buffers below which the Network Processor asks for an immediate refill
+ */
+#ifndef SCL_RX_POST_LOW_WATERMARK
+#define SCL_RX_POST_LOW_WATERMARK              (4)
+#endif
+/**
+ * Enables scatter-gather transmit: pbuf chains are passed to the Network Processor as a list of segments.
+ * Chains are copied into one buffer if the Network Processor does not accept scatter-gather lists.
+ * Define it for lwipopts.h as well, so that lwIP stops flattening TX frames itself.
+ */
+#ifndef SCL_TX_SG_ENABLE
+#define SCL_TX_SG_ENABLE                       (0)
+#endif
+/**
+ * Maximum number of segments in a scatter-gather list, longer chains are copied into one buffer
+ */
+#ifndef SCL_TX_SG_MAX_ENTRIES
+#define SCL_TX_SG_MAX_ENTRIES                  (8)
+#endif
+/**
+ * Enables credit-based TX flow control: the Network Processor grants one credit per frame it can accept
+ * and scl_network_send_ethernet_data() returns SCL_FLOW_CONTROLLED when no credit is left.
+ */
+#ifndef SCL_TX_CREDIT_ENABLE
+#define SCL_TX_CREDIT_ENABLE                   (0)
+#endif
+/**
+ * Enables small-frame aggregation: SCL_TX_SEND_OUT frames up to SCL_AGG_THRESHOLD bytes are packed into one
+ * buffer sent with SCL_TX_SEND_OUT_AGG, and the Network Processor may pack received frames the same way in
+ * SCL_RX_DATA_AGG. SCL sends the frames one by one if the Network Processor does not accept SCL_TX_AGG_CONFIG.
+ */
+#ifndef SCL_AGG_ENABLE
+#define SCL_AGG_ENABLE                         (0)
+#endif
+/**
+ * Largest frame, in bytes, that is aggregated
+ */
+#ifndef SCL_AGG_THRESHOLD
+#define SCL_AGG_THRESHOLD                      (128)
+#endif
+/**
+ * Size of an aggregate buffer, in bytes
+ */
+#ifndef SCL_AGG_BUFFER_SIZE
+#define SCL_AGG_BUFFER_SIZE                    (SCL_LINK_MTU)
+#endif
+/**
+ * Maximum number of frames in an aggregate
+ */
+#ifndef SCL_AGG_MAX_FRAMES
+#define SCL_AGG_MAX_FRAMES                     (16)
+#endif
+/**
+ * Time (in ms) the oldest frame of an aggregate may wait for more frames
+ */
+#ifndef SCL_AGG_WINDOW_MS
+#define SCL_AGG_WINDOW_MS                      (1)
+#endif
+/**
+ * Number of aggregates that may wait for the Network Processor when the TX ring is not active
+ */
+#ifndef SCL_AGG_BUFFERS
+#define SCL_AGG_BUFFERS                        (2)
+#endif
+/**
+ * Size of the record of a frame in an aggregate. An aggregate is a sequence of records, each one
+ * a uint32_t frame length followed by the frame, padded to a multiple of 4 bytes.
+ */
+#define SCL_AGG_RECORD_SIZE(length)            (4UL + (((length) + 3UL) & ~3UL))
+/**
+ * Enables a dedicated IPC channel for SCL_TX_SEND_OUT frames, separate from control commands.
+ * SCL keeps both on one channel if the Network Processor does not serve the data channel.
+ */
+#ifndef SCL_DATA_CHANNEL_ENABLE
+#define SCL_DATA_CHANNEL_ENABLE                (0)
+#endif
+/**
+ * Enables tagged control requests, several of which can be outstanding on the Network Processor.
+ * SCL falls back to one control request at a time if the Network Processor does not support tags.
+ */
+#ifndef SCL_TAGGED_CONTROL_ENABLE
+#define SCL_TAGGED_CONTROL_ENABLE              (0)
+#endif
+/**
+ * Maximum number of outstanding tagged control requests
+ */
+#ifndef SCL_MAX_OUTSTANDING_CONTROL
+#define SCL_MAX_OUTSTANDING_CONTROL            (4)
+#endif
+/**
+ * Maximum number of threads blocked in scl_send_data at the same time, at most 32.
+ * Further callers wait for one of them to complete.
+ */
+#ifndef SCL_MAX_BLOCKING_SENDERS
+#define SCL_MAX_BLOCKING_SENDERS               (8)
+#endif
+/**
+ * Largest command sent with scl_send_command, which SCL copies for each blocked sender and tag
+ */
+#ifndef SCL_COMMAND_SIZE
+#define SCL_COMMAND_SIZE                       (64)
+#endif
+/**
+ * Passed as result_offset to scl_send_command for a command without result pointer
+ */
+#define SCL_COMMAND_NO_RESULT                  (0xffffffff)
+/**
+ * Enables the per command latency histograms, timed with the DWT cycle counter
+ */
+#ifndef SCL_LATENCY_STATS_ENABLE
+#define SCL_LATENCY_STATS_ENABLE               (1)
+#endif
+/**
+ * Number of buckets of a latency histogram. Bucket 0 counts latencies below 1 us,
+ * bucket n those from 2^(n-1) us up to 2^n us; the last bucket also counts the longer ones.
+ */
+#ifndef SCL_LATENCY_BUCKETS
+#define SCL_LATENCY_BUCKETS                    (16)
+#endif
+/**
+ * Enables the binary trace of the IPC path, dumped with scl_trace_dump()
+ */
+#ifndef SCL_TRACE_ENABLE
+#define SCL_TRACE_ENABLE                       (0)
+#endif
+/**
+ * Number of events kept in the trace buffer, a power of two
+ */
+#ifndef SCL_TRACE_ENTRIES
+#define SCL_TRACE_ENTRIES                      (256)
+#endif
+/**
+ * Number of scl_ipc_tx_t indexes with latency statistics
+ */
+#define SCL_LATENCY_TX_INDEX_MAX               (SCL_TX_DHM_CP_HEART_BEAT + 1)
+/**
+ * Number of scl_ipc_rx_t indexes with latency statistics
+ */
+#define SCL_LATENCY_RX_INDEX_MAX               (SCL_RX_DATA_AGG + 1)
 
 /******************************************************
 *               Variables
@@ -78,6 +365,176 @@ typedef struct network_params {
     int  connection_status; /**< Connection status */
 } network_params_t;
 
+/**
+ * IPC channels used to send to the Network Processor
+ */
+typedef enum {
+    SCL_IPC_CONTROL_CHANNEL = 0, /**< Channel for control commands */
+    SCL_IPC_DATA_CHANNEL    = 1  /**< Channel for SCL_TX_SEND_OUT frames */
+} scl_ipc_channel_t;
+
+/**
+ * Statistics of an IPC channel
+ */
+typedef struct {
+    uint32_t posted;          /**< Requests written to the channel */
+    uint32_t queued;          /**< Requests that waited for the channel to be released */
+    uint32_t completed;       /**< Requests released by the Network Processor */
+    uint32_t errors;          /**< Requests not sent because the IPC lock was not acquired */
+    uint32_t max_queue_depth; /**< Largest number of requests waiting for the channel */
+} scl_ipc_channel_stats_t;
+
+/**
+ * Statistics of the RX ring processing
+ */
+typedef struct {
+    uint32_t wakeups;               /**< Times the SCL thread drained the RX ring */
+    uint32_t frames;                /**< Descriptors processed from the RX ring */
+    uint32_t max_frames_per_wakeup; /**< Largest number of descriptors processed in one wakeup */
+    uint32_t budget_exhausted;      /**< Passes stopped at SCL_RX_BUDGET with descriptors left */
+    uint32_t interrupts;            /**< Wakeups caused by an RX interrupt */
+    uint32_t polls;                 /**< Wakeups caused by the polling interval in polling mode */
+    uint32_t interrupt_frames;      /**< Descriptors processed in interrupt mode */
+    uint32_t poll_frames;           /**< Descriptors processed in polling mode */
+    uint32_t switches_to_polling;   /**< Switches from interrupt mode to polling mode */
+    uint32_t switches_to_interrupt; /**< Switches from polling mode to interrupt mode */
+    uint32_t posted_buffers;        /**< RX buffers pre-posted to the Network Processor */
+    uint32_t post_alloc_failures;   /**< Refills stopped because no RX buffer could be allocated */
+    uint32_t post_low_watermark;    /**< Low watermark signals received from the Network Processor */
+} scl_rx_stats_t;
+
+/**
+ * Log-bucketed latency histogram
+ */
+typedef struct {
+    uint32_t count;                         /**< Samples recorded */
+    uint32_t max_us;                        /**< Largest sample, in us */
+    uint64_t total_us;                      /**< Sum of the samples, in us */
+    uint32_t bucket[SCL_LATENCY_BUCKETS];   /**< Samples per power-of-two range of us */
+} scl_latency_histogram_t;
+
+/**
+ * Latency statistics of an scl_ipc_tx_t index
+ */
+typedef struct {
+    scl_latency_histogram_t queue;      /**< From submission until the request is written to the IPC channel */
+    scl_latency_histogram_t acquire;    /**< Acquisition of the IPC lock */
+    scl_latency_histogram_t turnaround; /**< From the IPC notification until the Network Processor releases the channel */
+    uint32_t lock_failures;             /**< Requests not sent because the IPC lock was not acquired */
+} scl_tx_latency_stats_t;
+
+/**
+ * Latency statistics of an scl_ipc_rx_t index
+ */
+typedef struct {
+    scl_latency_histogram_t wakeup;     /**< From the RX interrupt until the SCL thread reads the message */
+    scl_latency_histogram_t handling;   /**< Handling of the message by the SCL thread */
+} scl_rx_latency_stats_t;
+
+/**
+ * Data-plane counters of one direction
+ */
+typedef struct {
+    uint32_t packets;   /**< Frames exchanged with the Network Processor */
+    uint64_t bytes;     /**< Bytes of the frames counted in packets */
+    uint32_t dropped;   /**< Frames discarded because no buffer or queue slot was available */
+    uint32_t errors;    /**< Frames that could not be handed over because of an error */
+} scl_direction_stats_t;
+
+/**
+ * Data-plane counters of SCL
+ */
+typedef struct {
+    scl_direction_stats_t tx;   /**< Frames sent to the Network Processor */
+    scl_direction_stats_t rx;   /**< Frames received from the Network Processor */
+    uint32_t alloc_failures;    /**< Calls to scl_host_buffer_get() that returned no buffer */
+    uint32_t lock_failures;     /**< Requests not sent because the IPC lock or a TX lock was not acquired */
+    uint32_t unknown_messages;  /**< Messages from the Network Processor with an unknown index */
+    uint32_t already_released;  /**< RX interrupts without message, the channel was already released */
+    uint32_t flow_controlled;   /**< Frames refused with SCL_FLOW_CONTROLLED because no TX credit was left */
+} scl_stats_t;
+
+/**
+ * Receives the trace written by @a scl_trace_dump, in pieces
+ */
+typedef void (*scl_trace_write_t)(const void *data, uint32_t length, void *user_data);
+
+/**
+ * RX interrupt moderation parameters
+ */
+typedef struct {
+    uint32_t poll_interval_ms; /**< Interval between two polls of the RX ring in polling mode */
+    uint32_t high_threshold;   /**< Descriptors per wakeup that switch to polling mode, 0 disables moderation */
+    uint32_t low_threshold;    /**< Descriptors per poll below which a poll counts as idle */
+    uint32_t idle_polls;       /**< Consecutive idle polls that switch back to interrupt mode */
+} scl_rx_moderation_config_t;
+
+/**
+ * TX doorbell coalescing parameters
+ */
+typedef struct {
+    uint32_t window_ms;        /**< Time a frame may wait for the doorbell, 0 disables coalescing */
+    uint32_t batch;            /**< Waiting frames that ring the doorbell at once, 1 disables coalescing */
+} scl_tx_doorbell_config_t;
+
+/**
+ * Statistics of the TX ring doorbells
+ */
+typedef struct {
+    uint32_t doorbells;                /**< Doorbells rung to the Network Processor */
+    uint32_t frames;                   /**< Frames notified by these doorbells */
+    uint32_t max_frames_per_doorbell;  /**< Largest number of frames notified by one doorbell */
+    uint32_t polled_frames;            /**< Frames picked up by the Network Processor without a doorbell */
+    uint32_t batch_doorbells;          /**< Doorbells rung because the batch was complete */
+    uint32_t window_doorbells;         /**< Doorbells rung because the window of the oldest frame elapsed */
+    uint32_t urgent_doorbells;         /**< Doorbells rung for a frame of SCL_TX_DOORBELL_URGENT_PRIORITY or above */
+    uint32_t flush_doorbells;          /**< Doorbells rung by @a scl_tx_flush */
+} scl_tx_doorbell_stats_t;
+
+/**
+ * Statistics of the small-frame aggregation
+ */
+typedef struct {
+    uint32_t tx_aggregates;            /**< Aggregates sent to the Network Processor */
+    uint32_t tx_frames;                /**< Frames sent in these aggregates */
+    uint32_t max_frames_per_aggregate; /**< Largest number of frames sent in one aggregate */
+    uint32_t tx_unaggregated;          /**< Small frames sent alone because no aggregate buffer was available */
+    uint32_t tx_dropped;               /**< Frames of aggregates that could not be handed to the Network Processor */
+    uint32_t rx_aggregates;            /**< Aggregates received from the Network Processor */
+    uint32_t rx_frames;                /**< Frames delivered from these aggregates */
+} scl_agg_stats_t;
+
+/**
+ * Callback telling the network stack to retry transmitting after SCL_FLOW_CONTROLLED,
+ * called from the SCL thread once the Network Processor grants credits again
+ */
+typedef void (*scl_tx_resume_callback_t)(void *user_data);
+
+struct scl_ipc_request;
+
+/**
+ * Completion callback of @a scl_send_data_async.
+ * Called from the IPC release interrupt, from the sender that found the IPC channel idle,
+ * or from the caller when a frame is queued in the TX ring; it must not block.
+ */
+typedef void (*scl_send_callback_t)(struct scl_ipc_request *request, scl_result_t result, void *user_data);
+
+/**
+ * Asynchronous IPC request. The storage is provided by the caller and must stay
+ * valid until the completion callback has been called.
+ */
+typedef struct scl_ipc_request {
+    struct scl_ipc_request *next;    /**< Used by SCL to queue the request */
+    int index;                       /**< Index of the command */
+    char *buffer;                    /**< Data to be sent */
+    scl_send_callback_t callback;    /**< Completion callback, may be NULL */
+    void *user_data;                 /**< Passed to the completion callback */
+    volatile scl_result_t status;    /**< SCL_PENDING until the request is completed */
+    volatile uint32_t state;         /**< Used by SCL to decide between posting and cancelling the request */
+    uint32_t submitted;              /**< Used by SCL for the latency statistics */
+    uint32_t posted;                 /**< Used by SCL for the latency statistics */
+} scl_ipc_request_t;
+
 /******************************************************
 *             Function Declarations
 ******************************************************/
@@ -94,15 +551,238 @@ typedef struct network_params {
 extern scl_result_t scl_init(void);
 
 /** Sends the SCL data and respective command to Network Processor
+ *
+ *  @note When the TX ring is active, SCL_TX_SEND_OUT frames are queued in the ring and this
+ *        function returns without waiting for the Network Processor. The ring then takes its own
+ *        reference on the buffer of the @a scl_tx_buf_t and drops it once the Network Processor has
+ *        consumed it; the caller releases its reference as soon as this function returns.
+ *  @note The buffer of an SCL_TX_SEND_OUT frame may be a chain when SCL_TX_SG_ENABLE is set.
+ *  @note With SCL_AGG_ENABLE, a small SCL_TX_SEND_OUT frame is copied into an aggregate and sent later,
+ *        at the latest SCL_AGG_WINDOW_MS after this function returns.
+ *
+ *  @note On timeout a request that has not been written to the IPC channel yet is dropped.
+ *        A request already written is abandoned and SCL_TIMEOUT is returned: the Network Processor
+ *        may still access @a buffer until it releases the channel, and blocking sends on that channel
+ *        return SCL_TIMEOUT right away until then. SCL sends a copy of SCL_TX_SEND_OUT frames and keeps
+ *        a reference to their buffer; other commands are sent with scl_send_command() for the same reason.
  *
  *  @param index           Index of the command.
  *  @param buffer          Data to be sent.
- *  @param timeout         The maximum time (in ms) to wait for the Network Processor to release IPC channel.
+ *  @param timeout         The maximum time (in ms) to wait for the request to reach the Network Processor,
+ *                         SCL_SEND_TIMEOUT_DEFAULT for the default timeout of the command, or CY_RTOS_NEVER_TIMEOUT.
  *
- *  @return SCL_SUCCESS on successful communication within SCL timeout duration or SCL_ERROR
+ *  @return SCL_SUCCESS on successful communication within SCL timeout duration, SCL_TIMEOUT or SCL_ERROR
  */
 extern scl_result_t scl_send_data(int index, char *buffer, uint32_t timeout);
 
+/** Sends a copy of a command to the Network Processor and waits for it, see scl_send_data()
+ *
+ *  The Network Processor reads and writes a copy of the command held by SCL, and of the result
+ *  it points to, which are copied back to the caller on success. A command abandoned at the
+ *  timeout thus never accesses the memory of the caller.
+ *
+ *  @param index           Index of the command.
+ *  @param command         Command to be sent.
+ *  @param size            Size of the command, at most SCL_COMMAND_SIZE.
+ *  @param result_offset   Offset in the command of the pointer to the result written by the Network Processor,
+ *                         or SCL_COMMAND_NO_RESULT.
+ *  @param result_size     Size of the result, at most the size of an scl_wl_bss_info_t.
+ *  @param timeout         The maximum time (in ms) to wait for the Network Processor,
+ *                         SCL_SEND_TIMEOUT_DEFAULT for the default timeout of the command, or CY_RTOS_NEVER_TIMEOUT.
+ *
+ *  @return SCL_SUCCESS, SCL_BADARG, SCL_TIMEOUT or SCL_ERROR
+ */
+extern scl_result_t scl_send_command(int index, void *command, uint32_t size, uint32_t result_offset,
+                                     uint32_t result_size, uint32_t timeout);
+
+/** Gets the number of scl_send_data calls of a command that timed out
+ *
+ *  @param  index         Index of the command, below SCL_SEND_TIMEOUT_INDEX_MAX.
+ *  @param  count         Receives the number of timeouts.
+ *
+ *  @return SCL_SUCCESS or SCL_BADARG
+ */
+extern scl_result_t scl_get_send_timeouts(int index, uint32_t *count);
+
+/** Tells whether SCL_TX_SEND_OUT frames go through the TX ring
+ *
+ *  @return SCL_TRUE if scl_send_data() returns before the Network Processor has read SCL_TX_SEND_OUT frames
+ */
+extern scl_bool_t scl_tx_ring_is_active(void);
+
+/** Posts the SCL data and respective command to Network Processor without waiting for it
+ *
+ *  The request is queued if the IPC channel is busy. The callback is called once the
+ *  Network Processor has released the IPC channel for this request; the buffer must stay
+ *  valid until then.
+ *
+ *  @param index           Index of the command.
+ *  @param buffer          Data to be sent.
+ *  @param request         Storage for the request, owned by SCL until completion.
+ *  @param callback        Completion callback, called from interrupt context. May be NULL.
+ *  @param user_data       Passed to the completion callback.
+ *
+ *  @note Any thread or ISR may call this function; requests are queued without locks.
+ *        A request that cannot be written to the IPC channel is completed with SCL_ERROR.
+ *        The exception is an SCL_TX_SEND_OUT frame while the TX ring is active: the frame is written
+ *        to the ring under a mutex, so an ISR gets SCL_UNSUPPORTED and must defer it to a thread.
+ *
+ *  @return SCL_SUCCESS if the request was queued (the callback will be called),
+ *          SCL_UNSUPPORTED for a frame sent from an ISR through the TX ring,
+ *          error code otherwise (the callback will not be called)
+ */
+extern scl_result_t scl_send_data_async(int index, char *buffer, scl_ipc_request_t *request,
+                                        scl_send_callback_t callback, void *user_data);
+
+/** Gets the statistics of an IPC channel
+ *
+ *  @note The data channel reports the control channel statistics if the Network Processor
+ *        does not serve a separate data channel.
+ *
+ *  @param  channel       Channel to be queried.
+ *  @param  stats         Receives a snapshot of the channel statistics.
+ *
+ *  @return SCL_SUCCESS or SCL_BADARG
+ */
+extern scl_result_t scl_get_channel_stats(scl_ipc_channel_t channel, scl_ipc_channel_stats_t *stats);
+
+/** Gets the statistics of the RX ring processing
+ *
+ *  @param  stats         Receives a snapshot of the RX statistics.
+ *
+ *  @return SCL_SUCCESS or SCL_BADARG
+ */
+extern scl_result_t scl_get_rx_stats(scl_rx_stats_t *stats);
+
+/** Gets the latency statistics of a command sent to the Network Processor
+ *
+ *  @param  index         scl_ipc_tx_t index, below SCL_LATENCY_TX_INDEX_MAX.
+ *  @param  stats         Receives a snapshot of the statistics.
+ *
+ *  @return SCL_SUCCESS, SCL_BADARG or SCL_UNSUPPORTED if SCL_LATENCY_STATS_ENABLE is not set
+ */
+extern scl_result_t scl_get_tx_latency_stats(int index, scl_tx_latency_stats_t *stats);
+
+/** Gets the latency statistics of a message received from the Network Processor
+ *
+ *  @param  index         scl_ipc_rx_t index, below SCL_LATENCY_RX_INDEX_MAX.
+ *  @param  stats         Receives a snapshot of the statistics.
+ *
+ *  @return SCL_SUCCESS, SCL_BADARG or SCL_UNSUPPORTED if SCL_LATENCY_STATS_ENABLE is not set
+ */
+extern scl_result_t scl_get_rx_latency_stats(int index, scl_rx_latency_stats_t *stats);
+
+/** Clears the latency statistics of all indexes
+ */
+extern void scl_reset_latency_stats(void);
+
+/** Gets the data-plane counters
+ *
+ *  The counters are always maintained and wrap around; they are cleared only at power up.
+ *
+ *  @param  stats         Receives a snapshot of the counters.
+ *
+ *  @return SCL_SUCCESS or SCL_BADARG
+ */
+extern scl_result_t scl_get_stats(scl_stats_t *stats);
+
+/** Writes the trace buffer, oldest event first, in the binary format read by tools/scl_trace_decode.py
+ *
+ *  Events keep being recorded during the dump; entries overwritten meanwhile are written as empty entries.
+ *
+ *  @param  write         Called with each piece of the dump, from the calling thread.
+ *  @param  user_data     Passed to write.
+ *
+ *  @return SCL_SUCCESS, SCL_BADARG or SCL_UNSUPPORTED if SCL_TRACE_ENABLE is not set
+ */
+extern scl_result_t scl_trace_dump(scl_trace_write_t write, void *user_data);
+
+/** Starts or stops recording trace events
+ *
+ *  @param  enabled       SCL_TRUE to record events.
+ *
+ *  @return SCL_SUCCESS or SCL_UNSUPPORTED if SCL_TRACE_ENABLE is not set
+ */
+extern scl_result_t scl_trace_set_enabled(scl_bool_t enabled);
+
+/** Discards the recorded trace events
+ *
+ *  @return SCL_SUCCESS or SCL_UNSUPPORTED if SCL_TRACE_ENABLE is not set
+ */
+extern scl_result_t scl_trace_reset(void);
+
+/** Sets the RX interrupt moderation parameters
+ *
+ *  Under high packet rates the SCL thread stops asking the Network Processor for RX
+ *  interrupts and polls the RX ring instead; it returns to interrupt mode when the
+ *  traffic becomes idle. Only applies when the RX ring is active.
+ *
+ *  @param  config        Moderation parameters.
+ *
+ *  @return SCL_SUCCESS or SCL_BADARG
+ */
+extern scl_result_t scl_rx_set_moderation(const scl_rx_moderation_config_t *config);
+
+/** Sets the TX doorbell coalescing parameters
+ *
+ *  While the Network Processor waits for a doorbell, the frames queued in the TX ring are
+ *  notified together once the batch is complete or the window of the oldest one elapses.
+ *  Only applies when the TX ring is active.
+ *
+ *  @param  config        Coalescing parameters.
+ *
+ *  @return SCL_SUCCESS, SCL_BADARG or SCL_UNSUPPORTED if SCL_TX_DOORBELL_COALESCE_ENABLE is not set
+ */
+extern scl_result_t scl_tx_set_doorbell_coalescing(const scl_tx_doorbell_config_t *config);
+
+/** Sends the frames waiting in an aggregate or for the TX ring doorbell
+ *
+ *  The network stack calls it when it has no more frames to send or after a latency-critical frame.
+ *
+ *  @return SCL_SUCCESS, also when no frame is waiting, or SCL_ERROR
+ */
+extern scl_result_t scl_tx_flush(void);
+
+/** Gets the statistics of the TX ring doorbells
+ *
+ *  @param  stats         Receives a snapshot of the statistics.
+ *
+ *  @return SCL_SUCCESS, SCL_BADARG or SCL_UNSUPPORTED if SCL_TX_RING_ENABLE is not set
+ */
+extern scl_result_t scl_get_tx_doorbell_stats(scl_tx_doorbell_stats_t *stats);
+
+/** Gets the statistics of the small-frame aggregation
+ *
+ *  @param  stats         Receives a snapshot of the statistics.
+ *
+ *  @return SCL_SUCCESS, SCL_BADARG or SCL_UNSUPPORTED if SCL_AGG_ENABLE is not set
+ */
+extern scl_result_t scl_get_agg_stats(scl_agg_stats_t *stats);
+
+/** Registers the callback called when transmission can resume after SCL_FLOW_CONTROLLED
+ *
+ *  @param  callback      Callback to be called, NULL to unregister.
+ *  @param  user_data     Passed back to the callback.
+ *
+ *  @return SCL_SUCCESS
+ */
+extern scl_result_t scl_register_tx_resume_callback(scl_tx_resume_callback_t callback, void *user_data);
+
+/** Takes a TX credit for one SCL_TX_SEND_OUT frame
+ *
+ *  @return SCL_SUCCESS, also when flow control is not active, or SCL_FLOW_CONTROLLED if no credit is left
+ */
+extern scl_result_t scl_tx_credit_take(void);
+
+/** Gives back the credit of a frame that could not be sent */
+extern void scl_tx_credit_return(void);
+
+/** Tells whether the caller runs on the SCL thread
+ *
+ *  @return SCL_TRUE on the SCL thread, SCL_FALSE on any other thread or before scl_init()
+ */
+extern scl_bool_t scl_is_scl_thread(void);
+
 /** Terminates the SCL thread and disables the interrupts
  *
  *  @return SCL_SUCCESS on successful termination of SCL thread and disabling of interrupts or SCL_ERROR on timeout
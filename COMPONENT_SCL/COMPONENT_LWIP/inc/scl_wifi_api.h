@@ -35,12 +35,19 @@ extern "C"
 {
 #endif
 
+/**
+ * Highest 802.1D user priority of a frame
+ */
+#define SCL_MAX_USER_PRIORITY (7)
+
 /**
  * SCL transmit buffer structure
  */
 typedef struct scl_tx_buf {
     scl_buffer_t buffer; /**< pointer to the buffer */
     uint32_t size;       /**< size of the buffer */
+    uint32_t priority;   /**< 802.1D user priority (1-7), 0 to take it from the VLAN tag or IP DSCP of the frame.
+                              Set by SCL from the priority passed to scl_network_send_ethernet_data_prio(). */
 } scl_tx_buf_t;
 
 /**
@@ -136,15 +143,29 @@ extern scl_result_t scl_wifi_is_ready_to_transceive(void);
  *
  *  This function takes ethernet data from the network stack and transmits over the wireless network.
  *  This function returns immediately after the packet has been queued for transmission,
- *  NOT after it has been transmitted. Packet buffers passed to the SCL
- *  are released inside the SCL once they have been transmitted.
+ *  NOT after it has been transmitted. SCL takes its own reference on the packet buffer
+ *  when it keeps it beyond the call, and drops it once the buffer has been transmitted.
+ *  The caller always releases its own reference, whatever is returned.
+ *
+ *  @note The priority of @a buffer is ignored, the frame is prioritized from its VLAN tag or IP DSCP.
  *
  *  @param buffer        Handle of the packet buffer to be sent.
  *
- *  @return SCL_SUCCESS or Error code.
+ *  @return SCL_SUCCESS, SCL_FLOW_CONTROLLED if the Network Processor has no TX credit left
+ *          (the buffer is not consumed, see scl_register_tx_resume_callback) or Error code.
  */
 extern scl_result_t scl_network_send_ethernet_data(scl_tx_buf_t buffer);
 
+/** Sends an ethernet frame to SCL with an explicit priority, see scl_network_send_ethernet_data()
+ *
+ *  @param buffer        Handle of the packet buffer to be sent, its priority is ignored.
+ *  @param priority      802.1D user priority of the frame, up to SCL_MAX_USER_PRIORITY,
+ *                       0 to take it from the VLAN tag or IP DSCP of the frame.
+ *
+ *  @return SCL_SUCCESS, SCL_BADARG, SCL_FLOW_CONTROLLED or Error code, as scl_network_send_ethernet_data()
+ */
+extern scl_result_t scl_network_send_ethernet_data_prio(scl_tx_buf_t buffer, uint32_t priority);
+
 /** Retrieves the latest RSSI value
  *
  *  @note This API must be called after the device is connected to a network.
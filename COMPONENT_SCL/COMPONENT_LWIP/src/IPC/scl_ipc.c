@@ -28,18 +28,24 @@
 #include "string.h"
 #include "scl_wifi_api.h"
 #include "scl_types.h"
+#include "scl_ipc_ring.h"
+#include "scl_ipc_queue.h"
+#include "scl_ipc_stats.h"
+#include "scl_ipc_trace.h"
+#include "scl_ipc_hal.h"
+#include "scl_rx_input.h"
+#include "scl_tx_queue.h"
 /******************************************************
  **                      Macros
  *******************************************************/
 #define SCL_THREAD_STACK_SIZE      (4096)
 #define SCL_THREAD_PRIORITY        (CY_RTOS_PRIORITY_HIGH)
-#define SCL_INTR_SRC               (cpuss_interrupts_ipc_11_IRQn)
-#define SCL_INTR_PRI               (1)
 #define SCL_RX_CHANNEL             (11)
 #define SCL_CHANNEL_NOTIFY_INTR    ((1 << SCL_RX_CHANNEL) << 16)
-#define SCL_NOTIFY                 (1 << SCL_TX_CHANNEL)
-#define SCL_LOCK_ACQUIRE_STATUS    (0x80000000)
+#define SCL_CHANNEL_NOTIFY(ch)     (1 << (ch))
+#define SCL_NOTIFY                 SCL_CHANNEL_NOTIFY(SCL_TX_CHANNEL)
 #define SCL_TX_CHANNEL             (10)
+#define SCL_TX_DATA_CHANNEL        (12)
 #define SCL_RELEASE                (0)
 #define DELAY_TIME                 (1000)
 #define DELAY_TIME_MS              (1)
@@ -48,25 +54,145 @@
 #define INTIAL_VALUE               (0)
 #define SCL_THREAD_WAIT_MS_MAX     (0xffffffff)
 #define SCL_MUTEX_TIMEOUT          (10)
+/* Holders of the TX ring and aggregation mutexes never block longer than a frame may wait, nor does a sender */
+#define SCL_TX_LOCK_TIMEOUT(timeout) (((timeout) > SCL_MUTEX_TIMEOUT) ? (timeout) : SCL_MUTEX_TIMEOUT)
+#define SCL_CHANNEL_IDLE           (0)
+#define SCL_CHANNEL_BUSY           (1)
+#define SCL_IN_ISR()               (scl_ipc_hal_in_isr())
+#define SCL_REQUEST_QUEUED         (0)
+#define SCL_REQUEST_POSTED         (1)
+#define SCL_REQUEST_CANCELLED      (2)
+#define SCL_WAIT_PENDING           (0)
+#define SCL_WAIT_RESUMED           (1)
+#define SCL_WAIT_ABANDONED         (2)
+#define SCL_IPC_TAGGED             (0x00008000)
+#define SCL_IPC_TAG_SHIFT          (16)
+#define SCL_IPC_TAG_MASK           (0xff)
+#define SCL_TAG_REFS               (2)
+#define SCL_IPC_INDEX_MASK         (0x7fff)
+#define SCL_RX_NO_MESSAGE          (0xffffffff)
+#define SCL_TX_CREDIT_FLAG_RESUME  (0x00000001)
 
-/* The SCL deep sleep callback shall be the last callback that is executed before
- * entry into deep sleep mode and the first one upon exit the deep sleep mode.
- */
-#define SCL_PM_CALLBACK_ORDER      (255u)
+#if (SCL_MAX_BLOCKING_SENDERS > 32)
+#error "SCL_MAX_BLOCKING_SENDERS must not exceed 32"
+#endif
+#if (SCL_RX_POST_ENABLE) && !(SCL_RX_RING_ENABLE)
+#error "SCL_RX_POST_ENABLE requires SCL_RX_RING_ENABLE"
+#endif
+#if (SCL_TX_COMPLETE_ENABLE) && !(SCL_TX_RING_ENABLE)
+#error "SCL_TX_COMPLETE_ENABLE requires SCL_TX_RING_ENABLE"
+#endif
+#if (SCL_TX_COMPLETE_ENABLE) && (SCL_TX_INFLIGHT_MAX > SCL_TX_COMPLETE_RING_SIZE)
+#error "SCL_TX_INFLIGHT_MAX must fit in the TX completion ring"
+#endif
+#if (SCL_TX_DOORBELL_COALESCE_ENABLE) && !(SCL_TX_RING_ENABLE)
+#error "SCL_TX_DOORBELL_COALESCE_ENABLE requires SCL_TX_RING_ENABLE"
+#endif
+#if (SCL_AGG_ENABLE) && ((SCL_AGG_BUFFERS == 0) || (SCL_AGG_MAX_FRAMES == 0))
+#error "SCL_AGG_BUFFERS and SCL_AGG_MAX_FRAMES must not be 0"
+#endif
+#if (SCL_AGG_ENABLE) && (SCL_AGG_RECORD_SIZE(SCL_AGG_THRESHOLD) > SCL_AGG_BUFFER_SIZE)
+#error "SCL_AGG_BUFFER_SIZE must hold a frame of SCL_AGG_THRESHOLD bytes"
+#endif
 
 /******************************************************
  **               Function Declarations
  *******************************************************/
+struct scl_tx_channel_t;
+struct scl_command_layout;
+struct scl_command_data;
 static void scl_isr(void);
 static void scl_config(void);
 static void scl_rx_handler(void);
+static scl_result_t scl_send_data_wait(int index, char *buffer, const struct scl_command_layout *layout,
+                                       uint32_t timeout);
 static void scl_rel_isr(void);
+#if (SCL_DATA_CHANNEL_ENABLE)
+static void scl_data_rel_isr(void);
+static scl_result_t scl_data_channel_init(void);
+#endif
+static void scl_complete_request(scl_ipc_request_t *request, scl_result_t result);
+static void scl_send_data_complete(scl_ipc_request_t *request, scl_result_t result, void *user_data);
+static struct scl_tx_channel_t *scl_select_channel(int index);
+static char *scl_command_stage(struct scl_command_data *data, const struct scl_command_layout *layout,
+                               char *buffer);
+static void scl_command_unstage(struct scl_command_data *data, const struct scl_command_layout *layout,
+                                char *buffer);
+static scl_buffer_t scl_command_frame(int index, struct scl_command_data *data);
+static scl_result_t scl_post_request(struct scl_tx_channel_t *tx_channel, scl_ipc_request_t *request);
 static scl_result_t scl_thread_init(void);
 static scl_result_t scl_check_version_compatibility(void);
+#if (SCL_TAGGED_CONTROL_ENABLE)
+static scl_result_t scl_tag_init(void);
+static scl_result_t scl_send_tagged(int index, char *buffer, const struct scl_command_layout *layout,
+                                    uint32_t timeout);
+static void scl_tag_complete(uint32_t tag);
+static void scl_tag_release(uint32_t tag);
+static void scl_tag_request_complete(scl_ipc_request_t *request, scl_result_t result, void *user_data);
+#endif
+#if (SCL_RX_RING_ENABLE)
+static scl_result_t scl_rx_ring_init(void);
+static void scl_rx_ring_poll(scl_bool_t polled);
+#endif
+#if (SCL_RX_POST_ENABLE)
+static scl_result_t scl_rx_post_init(void);
+static void scl_rx_post_refill(bool force);
+#endif
+#if (SCL_TX_SG_ENABLE)
+struct scl_tx_sg;
+static scl_result_t scl_tx_sg_init(void);
+static scl_result_t scl_tx_sg_build(scl_tx_buf_t *tx_buf, struct scl_tx_sg *sg);
+static scl_result_t scl_send_chain(scl_tx_buf_t *tx_buf, uint32_t timeout);
+#endif
+#if (SCL_TX_RING_ENABLE)
+static scl_result_t scl_tx_ring_init(void);
+static scl_result_t scl_tx_ring_send(int index, scl_tx_buf_t *tx_buf, uint32_t timeout);
+static void scl_tx_ring_reclaim(void);
+static void scl_tx_ring_poll(void);
+static void scl_tx_doorbell_ring(uint32_t *reason);
+static void scl_tx_doorbell_complete(scl_ipc_request_t *request, scl_result_t result, void *user_data);
+#endif
+#if (SCL_TX_DOORBELL_COALESCE_ENABLE)
+static void scl_tx_doorbell_arm(void);
+static void scl_tx_doorbell_timeout(cy_timer_callback_arg_t arg);
+#endif
+#if (SCL_TX_CREDIT_ENABLE)
+static scl_result_t scl_tx_credit_init(void);
+static void scl_tx_credit_poll(void);
+#endif
+#if (SCL_TX_COMPLETE_ENABLE)
+static scl_result_t scl_tx_complete_init(void);
+static void scl_tx_complete_poll(void);
+#endif
+#if (SCL_AGG_ENABLE)
+static scl_result_t scl_agg_init(void);
+static scl_result_t scl_agg_send(scl_tx_buf_t *tx_buf, uint32_t timeout);
+static scl_result_t scl_agg_post(uint32_t timeout);
+static void scl_agg_flush(uint32_t timeout);
+static void scl_agg_timeout(cy_timer_callback_arg_t arg);
+static void scl_agg_receive(scl_buffer_t aggregate, uint32_t length);
+#endif
 scl_result_t scl_get_nw_parameters(network_params_t *nw_param);
+scl_result_t scl_get_channel_stats(scl_ipc_channel_t channel, scl_ipc_channel_stats_t *stats);
+scl_result_t scl_get_rx_stats(scl_rx_stats_t *stats);
+scl_result_t scl_rx_set_moderation(const scl_rx_moderation_config_t *config);
+scl_result_t scl_register_tx_resume_callback(scl_tx_resume_callback_t callback, void *user_data);
+scl_result_t scl_tx_credit_take(void);
+void scl_tx_credit_return(void);
+scl_bool_t scl_tx_ring_is_active(void);
+scl_result_t scl_tx_set_doorbell_coalescing(const scl_tx_doorbell_config_t *config);
+scl_result_t scl_tx_flush(void);
+scl_result_t scl_get_tx_doorbell_stats(scl_tx_doorbell_stats_t *stats);
+scl_result_t scl_get_agg_stats(scl_agg_stats_t *stats);
 scl_result_t scl_send_data(int index, char *buffer, uint32_t timeout);
+scl_result_t scl_send_command(int index, void *command, uint32_t size, uint32_t result_offset,
+                              uint32_t result_size, uint32_t timeout);
+scl_result_t scl_get_send_timeouts(int index, uint32_t *count);
+scl_result_t scl_send_data_async(int index, char *buffer, scl_ipc_request_t *request,
+                                 scl_send_callback_t callback, void *user_data);
 scl_result_t scl_end(void);
 scl_result_t scl_init(void);
+scl_bool_t scl_is_scl_thread(void);
 /******************************************************
  *        Variables Definitions
  *****************************************************/
@@ -112,6 +238,9 @@ struct scl_version {
 };
 struct scl_thread_info_t g_scl_thread_info;
 
+/* Timestamp of the last RX interrupt, for the latency statistics */
+static volatile uint32_t scl_rx_isr_time;
+
 /* Structure of SCL scan callback data
  *   result_ptr:         Pointer to the scan result
  *   user_data:                 Pointer to the data for the user
@@ -132,9 +261,379 @@ struct event_callback_data {
     const uint8_t *event_data;
 };
 
-cy_mutex_t scl_ipc_send_mutex; /* Mutex for scl_send_data */
-cy_semaphore_t scl_channel_release; /* semaphore to wait for IPC release by NP */
-static volatile bool scl_mutex_aquired = false;
+/* Structure of SCL ring configuration sent to NP
+ *   ring_id:              identifier of the ring (scl_ipc_ring_id_t)
+ *   ring:                 pointer to the ring header in shared memory
+ *   retval:               set to SCL_SUCCESS by NP if it services the ring
+ */
+struct scl_ring_config {
+    uint32_t ring_id;
+    scl_ipc_ring_t *ring;
+    uint32_t retval;
+};
+
+/* Structure of SCL TX channel info
+ *   channel:              IPC channel number
+ *   busy:                 SCL_CHANNEL_BUSY while a drainer owns the IPC channel
+ *   active:               request posted to the channel and not yet released by NP
+ *   queue:                lock-free queue of the requests waiting for the channel
+ *   depth:                number of requests waiting for the channel
+ *   abandoned:            requests NP has not finished although their caller gave up on them,
+ *                         the channel is unresponsive while it is not 0
+ *   stats:                statistics of the channel
+ */
+struct scl_tx_channel_t {
+    uint32_t channel;
+    volatile uint32_t busy;
+    scl_ipc_request_t *volatile active;
+    scl_ipc_queue_t queue;
+    volatile uint32_t depth;
+    volatile uint32_t abandoned;
+    scl_ipc_channel_stats_t stats;
+};
+
+#if (SCL_TX_SG_ENABLE)
+/* Structure of SCL scatter-gather segment
+ *   data:                 start of the segment
+ *   length:               length of the segment
+ */
+struct scl_tx_sg_entry {
+    void *data;
+    uint32_t length;
+};
+
+/* Structure of SCL scatter-gather list sent with SCL_TX_SEND_OUT_SG
+ *   buffer:               head of the chain, owned like an SCL_TX_SEND_OUT buffer
+ *   size:                 length of the frame
+ *   count:                number of valid entries
+ *   entry:                segments of the frame, in order
+ */
+struct scl_tx_sg {
+    scl_buffer_t buffer;
+    uint32_t size;
+    uint32_t count;
+    struct scl_tx_sg_entry entry[SCL_TX_SG_MAX_ENTRIES];
+};
+#endif
+
+/* Structure of the layout of a command sent with scl_send_command
+ *   size:                 size of the command
+ *   result_offset:        offset of the pointer NP writes the result through, SCL_COMMAND_NO_RESULT if none
+ *   result_size:          size of the result
+ */
+struct scl_command_layout {
+    uint32_t size;
+    uint32_t result_offset;
+    uint32_t result_size;
+};
+
+/* Structure of the storage of SCL for a command sent with scl_send_command or a frame,
+ * NP reads and writes it instead of the memory of the caller
+ *   command:              copy of the command
+ *   result:               result NP writes through the pointer of the command
+ */
+struct scl_command_data {
+    union {
+        uint8_t bytes[SCL_COMMAND_SIZE];
+        void *pointer;
+        scl_tx_buf_t tx_buf;
+#if (SCL_TX_SG_ENABLE)
+        struct scl_tx_sg sg;
+#endif
+    } command;
+    union {
+        scl_mac_t mac;
+        int32_t rssi;
+        scl_wl_bss_info_t bss_info;
+    } result;
+};
+
+/* Structure of SCL blocking sender info
+ *   request:              request of each waiter, kept until the drainer is done with it
+ *   done:                 semaphore given when the request of each waiter completes
+ *   wait:                 SCL_WAIT_ABANDONED once the caller of each waiter gave up on its posted request
+ *   data:                 command storage of each waiter, kept until NP is done with it
+ *   free:                 counting semaphore of the unused waiters
+ *   in_use:               bitmap of the waiters allocated to a caller
+ *   reclaim:              bitmap of the abandoned waiters whose frame is released by the next caller
+ */
+static struct scl_waiter_info_t {
+    scl_ipc_request_t request[SCL_MAX_BLOCKING_SENDERS];
+    cy_semaphore_t done[SCL_MAX_BLOCKING_SENDERS];
+    volatile uint32_t wait[SCL_MAX_BLOCKING_SENDERS];
+    struct scl_command_data data[SCL_MAX_BLOCKING_SENDERS];
+    cy_semaphore_t free;
+    volatile uint32_t in_use;
+    volatile uint32_t reclaim;
+} scl_waiter_info;
+
+/* Number of scl_send_data calls that timed out, per command index */
+static uint32_t scl_send_timeouts[SCL_SEND_TIMEOUT_INDEX_MAX];
+
+/* Channel for control commands */
+static struct scl_tx_channel_t scl_control_channel = { .channel = SCL_TX_CHANNEL };
+#if (SCL_DATA_CHANNEL_ENABLE)
+/* Channel for SCL_TX_SEND_OUT frames */
+static struct scl_tx_channel_t scl_data_channel = { .channel = SCL_TX_DATA_CHANNEL };
+
+/* Structure of SCL channel configuration sent to NP
+ *   channel:              IPC channel to be used for the data path
+ *   retval:               set to SCL_SUCCESS by NP if it serves the channel
+ */
+struct scl_channel_config {
+    uint32_t channel;
+    uint32_t retval;
+};
+#endif
+/* Channel used by the data path, the control channel unless NP accepts the data channel */
+static struct scl_tx_channel_t *scl_data_path = &scl_control_channel;
+
+#if (SCL_TAGGED_CONTROL_ENABLE)
+/* Structure of SCL tagged control request info
+ *   request:              request used to post the command of each tag
+ *   done:                 semaphore given when NP replies to the tag or the request fails
+ *   result:               result of each tag, set before done is given
+ *   wait:                 SCL_WAIT_ABANDONED once the caller of each tag gave up on its posted request
+ *   data:                 command storage of each tag, kept until NP is done with it
+ *   refs:                 references to each tag, held by its caller, or by the reply once the caller
+ *                         gave up, and by its IPC request
+ *   free:                 counting semaphore of the unused tags, given when the last reference is dropped
+ *   in_use:               bitmap of the tags allocated to a caller
+ *   active:               flag set once NP has accepted tagged requests
+ */
+static struct scl_tag_info_t {
+    scl_ipc_request_t request[SCL_MAX_OUTSTANDING_CONTROL];
+    cy_semaphore_t done[SCL_MAX_OUTSTANDING_CONTROL];
+    volatile scl_result_t result[SCL_MAX_OUTSTANDING_CONTROL];
+    volatile uint32_t wait[SCL_MAX_OUTSTANDING_CONTROL];
+    struct scl_command_data data[SCL_MAX_OUTSTANDING_CONTROL];
+    volatile uint32_t refs[SCL_MAX_OUTSTANDING_CONTROL];
+    cy_semaphore_t free;
+    uint32_t in_use;
+    volatile bool active;
+} scl_tag_info;
+
+/* Structure of SCL tag configuration sent to NP
+ *   max_tags:             number of tags CP may have outstanding
+ *   retval:               set to SCL_SUCCESS by NP if it supports tagged requests
+ */
+struct scl_tag_config {
+    uint32_t max_tags;
+    uint32_t retval;
+};
+#endif
+
+/* Statistics of the RX ring processing */
+static scl_rx_stats_t scl_rx_stats;
+
+/* Structure of SCL RX interrupt moderation info
+ *   config:               moderation parameters
+ *   polling:              flag set while the RX ring is polled instead of interrupting
+ *   idle_polls:           consecutive polls below the low threshold
+ */
+static struct scl_rx_moderation_info_t {
+    scl_rx_moderation_config_t config;
+    volatile bool polling;
+    uint32_t idle_polls;
+} scl_rx_moderation = {
+    .config = {
+        .poll_interval_ms = SCL_RX_POLL_INTERVAL_MS,
+        .high_threshold = SCL_RX_MODERATION_HIGH,
+        .low_threshold = SCL_RX_MODERATION_LOW,
+        .idle_polls = SCL_RX_MODERATION_IDLE_POLLS
+    }
+};
+
+#if (SCL_RX_RING_ENABLE)
+/* Structure of SCL RX ring info
+ *   ring:                 ring header shared with NP
+ *   desc:                 descriptor storage of the ring
+ *   active:               flag set once NP has accepted the ring
+ */
+static struct scl_rx_ring_info_t {
+    scl_ipc_ring_t ring;
+    scl_ipc_desc_t desc[SCL_RX_RING_SIZE];
+    volatile bool active;
+} scl_rx_ring_info;
+#endif
+
+#if (SCL_RX_POST_ENABLE)
+/* Structure of SCL RX buffer post ring info
+ *   ring:                 ring header shared with NP, filled by the SCL thread
+ *   desc:                 descriptor storage of the ring
+ *   active:               flag set once NP has accepted the ring
+ */
+static struct scl_rx_post_info_t {
+    scl_ipc_ring_t ring;
+    scl_ipc_desc_t desc[SCL_RX_POST_RING_SIZE];
+    volatile bool active;
+} scl_rx_post_info;
+
+/* Structure of SCL RX buffer post configuration sent to NP
+ *   ring:                 pointer to the post ring header in shared memory
+ *   low_watermark:        NP sends SCL_RX_POST_LOW when fewer buffers are posted
+ *   retval:               set to SCL_SUCCESS by NP if it takes buffers from the ring
+ */
+struct scl_rx_post_config {
+    scl_ipc_ring_t *ring;
+    uint32_t low_watermark;
+    uint32_t retval;
+};
+#endif
+
+#if (SCL_TX_SG_ENABLE)
+/* Structure of SCL scatter-gather configuration sent to NP
+ *   max_entries:          largest list SCL sends
+ *   retval:               set to SCL_SUCCESS by NP if it accepts SCL_TX_SEND_OUT_SG
+ */
+struct scl_sg_config {
+    uint32_t max_entries;
+    uint32_t retval;
+};
+
+/* Flag set once NP has accepted scatter-gather lists */
+static volatile bool scl_tx_sg_active;
+#endif
+
+/* Callback telling the network stack to retry after SCL_FLOW_CONTROLLED, and its user data */
+static scl_tx_resume_callback_t scl_tx_resume_callback;
+static void *scl_tx_resume_user_data;
+
+#if (SCL_TX_CREDIT_ENABLE)
+/* Structure of SCL TX credits shared with NP
+ *   granted:              credits granted by NP since the start, written by NP only
+ *   consumed:             credits spent by SCL since the start, written by SCL only
+ *   flags:                SCL_TX_CREDIT_FLAG_RESUME set by SCL while it waits for credits
+ */
+struct scl_tx_credits {
+    volatile uint32_t granted;
+    volatile uint32_t consumed;
+    volatile uint32_t flags;
+};
+
+/* Structure of SCL TX credit info
+ *   shared:               credit counters shared with NP
+ *   active:               flag set once NP grants credits
+ *   stalled:              flag set after a sender got SCL_FLOW_CONTROLLED
+ */
+static struct scl_tx_credit_info_t {
+    struct scl_tx_credits shared;
+    volatile bool active;
+    volatile bool stalled;
+} scl_tx_credit_info;
+
+/* Structure of SCL credit configuration sent to NP
+ *   credits:              pointer to the shared credit counters
+ *   retval:               set to SCL_SUCCESS by NP if it grants credits
+ */
+struct scl_credit_config {
+    struct scl_tx_credits *credits;
+    uint32_t retval;
+};
+#endif
+
+#if (SCL_TX_RING_ENABLE)
+/* Structure of SCL TX ring info
+ *   ring:                 ring header shared with NP
+ *   desc:                 descriptor storage of the ring
+ *   sg:                   scatter-gather list of each descriptor
+ *   reclaim:              oldest descriptor whose buffer is not yet released
+ *   complete:             ring of buffers NP has finished with
+ *   complete_desc:        descriptor storage of the completion ring
+ *   inflight:             buffers queued in the TX ring and not yet completed
+ *   complete_active:      flag set once NP reports completions
+ *   mutex:                serializes the producers of the ring, never held while waiting
+ *   room:                 semaphore given by the SCL thread once NP has freed descriptors
+ *   waiters:              senders waiting for room, counted under the mutex
+ *   doorbell:             request used to notify NP, pending until NP releases it
+ *   active:               flag set once NP has accepted the ring
+ */
+static struct scl_tx_ring_info_t {
+    scl_ipc_ring_t ring;
+    scl_ipc_desc_t desc[SCL_TX_RING_SIZE];
+#if (SCL_TX_SG_ENABLE)
+    struct scl_tx_sg sg[SCL_TX_RING_SIZE];
+#endif
+    uint32_t reclaim;
+#if (SCL_TX_COMPLETE_ENABLE)
+    scl_ipc_ring_t complete;
+    scl_ipc_desc_t complete_desc[SCL_TX_COMPLETE_RING_SIZE];
+    uint32_t inflight;
+    volatile bool complete_active;
+#endif
+    cy_mutex_t mutex;
+    cy_semaphore_t room;
+    volatile uint32_t waiters;
+    scl_ipc_request_t doorbell;
+    volatile bool active;
+} scl_tx_ring_info;
+
+/* Structure of SCL TX doorbell info
+ *   config:               coalescing parameters
+ *   waiting:              frames queued since NP asked for a doorbell, not yet notified
+ *   deferred:             set when frames wait for the completion of the pending doorbell
+ *   timer:                ends the window of the oldest waiting frame
+ *   stats:                statistics of the doorbells
+ */
+static struct scl_tx_doorbell_info_t {
+    scl_tx_doorbell_config_t config;
+    uint32_t waiting;
+    volatile uint32_t deferred;
+#if (SCL_TX_DOORBELL_COALESCE_ENABLE)
+    cy_timer_t timer;
+#endif
+    scl_tx_doorbell_stats_t stats;
+} scl_tx_doorbell = {
+    .config = {
+        .window_ms = SCL_TX_DOORBELL_WINDOW_MS,
+        .batch = SCL_TX_DOORBELL_BATCH
+    }
+};
+#endif
+
+#if (SCL_AGG_ENABLE)
+/* Structure of SCL aggregation configuration sent to NP
+ *   threshold:            largest frame SCL aggregates
+ *   buffer_size:          largest aggregate SCL sends
+ *   max_frames:           largest number of frames in an aggregate
+ *   retval:               set to SCL_SUCCESS by NP if it accepts SCL_TX_SEND_OUT_AGG,
+ *                         NP may then send SCL_RX_DATA_AGG
+ */
+struct scl_agg_config {
+    uint32_t threshold;
+    uint32_t buffer_size;
+    uint32_t max_frames;
+    uint32_t retval;
+};
+
+/* Structure of an SCL aggregate
+ *   request:              request sending the aggregate, pending until NP has read it
+ *   tx_buf:               aggregate buffer, NULL while the slot is free; size is the length filled
+ *   frames:               number of frames in the aggregate
+ */
+struct scl_agg {
+    scl_ipc_request_t request;
+    scl_tx_buf_t tx_buf;
+    uint32_t frames;
+};
+
+/* Structure of SCL aggregation info
+ *   agg:                  aggregates being filled or sent
+ *   current:              aggregate being filled, NULL if none
+ *   mutex:                serializes the senders, taken before the TX ring mutex
+ *   timer:                ends the window of the oldest frame of the current aggregate
+ *   stats:                statistics of the aggregation
+ *   active:               flag set once NP has accepted aggregates
+ */
+static struct scl_agg_info_t {
+    struct scl_agg agg[SCL_AGG_BUFFERS];
+    struct scl_agg *volatile current;
+    cy_mutex_t mutex;
+    cy_timer_t timer;
+    scl_agg_stats_t stats;
+    volatile bool active;
+} scl_agg_info;
+#endif
 /******************************************************
  *               Function Definitions
  ******************************************************/
@@ -143,11 +642,10 @@ static volatile bool scl_mutex_aquired = false;
  */
 static void scl_isr(void)
 {
-    IPC_INTR_STRUCT_Type *scl_rx_intr = NULL;
-    scl_rx_intr = Cy_IPC_Drv_GetIntrBaseAddr(SCL_RX_CHANNEL);
     /* Check if the RX channel interrupt is set and clear it */
-    if (REG_IPC_INTR_STRUCT_INTR_MASKED(scl_rx_intr) & SCL_CHANNEL_NOTIFY_INTR) {
-        REG_IPC_INTR_STRUCT_INTR(scl_rx_intr) |= SCL_CHANNEL_NOTIFY_INTR;
+    if (scl_ipc_hal_clear_interrupt(SCL_RX_CHANNEL, SCL_CHANNEL_NOTIFY_INTR)) {
+        scl_rx_isr_time = SCL_LATENCY_NOW();
+        SCL_TRACE(SCL_TRACE_RX_ISR, 0, 0);
         /* Check if the SCL thread is initialized or not */
         if (g_scl_thread_info.scl_inited == SCL_TRUE) {
             cy_rtos_set_semaphore(&g_scl_thread_info.scl_rx_ready, true);
@@ -155,46 +653,172 @@ static void scl_isr(void)
     }
 }
 
+/** Writes the request to the TX channel and notifies NP
+ *  Called by the owner of the channel.
+ *
+ *  @return  SCL_SUCCESS or SCL_ERROR if the IPC lock could not be acquired
+ */
+static scl_result_t scl_post_request(struct scl_tx_channel_t *tx_channel, scl_ipc_request_t *request)
+{
+    uint32_t index = (uint32_t) request->index & SCL_IPC_INDEX_MASK;
+    uint32_t start;
+
+    start = SCL_LATENCY_NOW();
+    if (scl_ipc_hal_is_locked(tx_channel->channel)) {
+        tx_channel->stats.errors++;
+        scl_stats_count(SCL_STATS_LOCK_FAILURES);
+        scl_latency_lock_failure(index);
+        return SCL_ERROR;
+    }
+    if (!scl_ipc_hal_acquire(tx_channel->channel)) {
+        tx_channel->stats.errors++;
+        scl_stats_count(SCL_STATS_LOCK_FAILURES);
+        scl_latency_lock_failure(index);
+        return SCL_ERROR;
+    }
+    request->posted = SCL_LATENCY_NOW();
+    SCL_TRACE(SCL_TRACE_POST, index, tx_channel->channel);
+    scl_latency_record_tx(index, SCL_LATENCY_TX_ACQUIRE, start, request->posted);
+    scl_latency_record_tx(index, SCL_LATENCY_TX_QUEUE, request->submitted, request->posted);
+    tx_channel->active = request;
+    tx_channel->stats.posted++;
+    scl_ipc_hal_write(tx_channel->channel, request->index, (uintptr_t) request->buffer);
+    scl_ipc_hal_notify(tx_channel->channel, SCL_CHANNEL_NOTIFY(tx_channel->channel));
+    return SCL_SUCCESS;
+}
+
+/** Sets the final status of a request and calls its completion callback */
+static void scl_complete_request(scl_ipc_request_t *request, scl_result_t result)
+{
+    request->status = result;
+    if (request->callback != NULL) {
+        request->callback(request, result, request->user_data);
+    }
+}
+
+static void scl_waiter_put(uint32_t waiter);
+
+/** Completion callback used by scl_send_data to resume the blocked caller,
+ *  or to free the waiter of a caller that gave up on the request
+ */
+static void scl_send_data_complete(scl_ipc_request_t *request, scl_result_t result, void *user_data)
+{
+    uint32_t waiter = (uint32_t) (uintptr_t) user_data;
+    uint32_t reclaim;
+
+    UNUSED_PARAMETER(result);
+    if (request->state == SCL_REQUEST_CANCELLED) {
+        scl_waiter_put(waiter);
+        return;
+    }
+    if (scl_ipc_atomic_cas(&scl_waiter_info.wait[waiter], SCL_WAIT_PENDING, SCL_WAIT_RESUMED)) {
+        cy_rtos_set_semaphore(&scl_waiter_info.done[waiter], SCL_IN_ISR());
+        return;
+    }
+    /* The caller timed out after the request was posted, NP is done with it now */
+    scl_ipc_atomic_add(&scl_select_channel(request->index)->abandoned, -1);
+    if (scl_command_frame(request->index, &scl_waiter_info.data[waiter]) == NULL) {
+        scl_waiter_put(waiter);
+        return;
+    }
+    /* The frame cannot be released from interrupt context, the next caller releases it */
+    do {
+        reclaim = scl_waiter_info.reclaim;
+    } while (!scl_ipc_atomic_cas(&scl_waiter_info.reclaim, reclaim, reclaim | (1UL << waiter)));
+}
+
+/** Posts the oldest queued request, or gives up the channel if none is left
+ *
+ *  Called by the owner of the channel only: the caller that switched busy to
+ *  SCL_CHANNEL_BUSY, or the release ISR while a request is active.
+ */
+static void scl_channel_drain(struct scl_tx_channel_t *tx_channel)
+{
+    scl_ipc_request_t *next = NULL;
+    scl_result_t result;
+
+    while (SCL_TRUE) {
+        result = scl_ipc_queue_pop(&tx_channel->queue, &next);
+        if (result == SCL_SUCCESS) {
+            scl_ipc_atomic_add(&tx_channel->depth, -1);
+            /* The caller gave up on the request before it reached the channel */
+            if (!scl_ipc_atomic_cas(&next->state, SCL_REQUEST_QUEUED, SCL_REQUEST_POSTED)) {
+                scl_complete_request(next, SCL_TIMEOUT);
+                continue;
+            }
+            if (scl_post_request(tx_channel, next) == SCL_SUCCESS) {
+                return;
+            }
+            scl_complete_request(next, SCL_ERROR);
+            continue;
+        }
+        scl_ipc_atomic_store(&tx_channel->busy, SCL_CHANNEL_IDLE);
+        /* A producer interrupted while queueing drains the channel itself once it resumes */
+        if (result == SCL_PENDING) {
+            return;
+        }
+        /* Take the channel back if a request was queued after the queue was found empty */
+        if (((int32_t) tx_channel->depth <= 0) ||
+            !scl_ipc_atomic_cas(&tx_channel->busy, SCL_CHANNEL_IDLE, SCL_CHANNEL_BUSY)) {
+            return;
+        }
+    }
+}
+
+/** Retires the request released by NP and posts the next queued one
+ *  Called from the release ISR of the channel.
+ */
+static void scl_channel_released(struct scl_tx_channel_t *tx_channel)
+{
+    scl_ipc_request_t *done = NULL;
+
+    done = tx_channel->active;
+    tx_channel->active = NULL;
+    SCL_TRACE(SCL_TRACE_RELEASE, (done != NULL) ? ((uint32_t) done->index & SCL_IPC_INDEX_MASK) : 0,
+              tx_channel->channel);
+    if (done != NULL) {
+        tx_channel->stats.completed++;
+        scl_latency_record_tx((uint32_t) done->index & SCL_IPC_INDEX_MASK, SCL_LATENCY_TX_TURNAROUND,
+                              done->posted, SCL_LATENCY_NOW());
+    }
+    scl_channel_drain(tx_channel);
+    if (done != NULL) {
+        scl_complete_request(done, SCL_SUCCESS);
+    }
+}
+
 /** ISR for IPC release from NP */
 static void scl_rel_isr() {
-    IPC_INTR_STRUCT_Type *scl_tx_intr = NULL;
-    scl_tx_intr = Cy_IPC_Drv_GetIntrBaseAddr(SCL_TX_CHANNEL);
-
     /* Check if the interrupt pertains to TX Channel (in this case 10) and clear it */
-    if (REG_IPC_INTR_STRUCT_INTR_MASKED(scl_tx_intr) & (SCL_NOTIFY)) {
-        REG_IPC_INTR_STRUCT_INTR(scl_tx_intr) |= (SCL_NOTIFY);
-        /* Release the semaphore to resume scl_send_data function */
-        cy_rtos_set_semaphore(&scl_channel_release, true);
+    if (scl_ipc_hal_clear_interrupt(SCL_TX_CHANNEL, SCL_NOTIFY)) {
+        scl_channel_released(&scl_control_channel);
+    }
+}
+
+#if (SCL_DATA_CHANNEL_ENABLE)
+/** ISR for IPC release of the data channel from NP */
+static void scl_data_rel_isr(void)
+{
+    if (scl_ipc_hal_clear_interrupt(SCL_TX_DATA_CHANNEL, SCL_CHANNEL_NOTIFY(SCL_TX_DATA_CHANNEL))) {
+        scl_channel_released(&scl_data_channel);
     }
 }
+#endif
 
 /** Configures the IPC interrupt channel
  */
 static void scl_config(void)
 {
     /* Configure the interrupt for SCL RX channel */
-    IPC_INTR_STRUCT_Type *scl_rx_intr = NULL;
-    cy_stc_sysint_t intrCfg = {
-        .intrSrc = SCL_INTR_SRC,
-        .intrPriority = SCL_INTR_PRI
-    };
-
-    scl_rx_intr = Cy_IPC_Drv_GetIntrBaseAddr(SCL_RX_CHANNEL);
-    REG_IPC_INTR_STRUCT_INTR_MASK(scl_rx_intr) |= SCL_CHANNEL_NOTIFY_INTR;
-    Cy_SysInt_Init(&intrCfg, &scl_isr);
-    NVIC_EnableIRQ(intrCfg.intrSrc);
+    scl_ipc_hal_enable_interrupt(SCL_RX_CHANNEL, SCL_CHANNEL_NOTIFY_INTR, &scl_isr);
 
     /* Configure the release interrupt for SCL TX channel */
-    IPC_INTR_STRUCT_Type *scl_tx_intr = NULL;
-    cy_stc_sysint_t intrrCfg = {
-        .intrSrc = cpuss_interrupts_ipc_10_IRQn,
-        .intrPriority = SCL_INTR_PRI
-    };
+    scl_ipc_hal_enable_interrupt(SCL_TX_CHANNEL, SCL_NOTIFY, &scl_rel_isr);
 
-    scl_tx_intr = Cy_IPC_Drv_GetIntrBaseAddr(SCL_TX_CHANNEL);
-    REG_IPC_INTR_STRUCT_INTR_MASK(scl_tx_intr) |= (1 << SCL_TX_CHANNEL);
-    Cy_SysInt_Init(&intrrCfg, &scl_rel_isr);
-    NVIC_EnableIRQ(intrrCfg.intrSrc);
+#if (SCL_DATA_CHANNEL_ENABLE)
+    /* Configure the release interrupt for SCL data channel */
+    scl_ipc_hal_enable_interrupt(SCL_TX_DATA_CHANNEL, SCL_CHANNEL_NOTIFY(SCL_TX_DATA_CHANNEL), &scl_data_rel_isr);
+#endif
 }
 /** Create the SCL thread and initialize the semaphore for handling the events from Network Processor
  *
@@ -219,7 +843,7 @@ static scl_result_t scl_thread_init(void)
         retval = cy_rtos_create_thread(&g_scl_thread_info.scl_thread, (cy_thread_entry_fn_t) scl_rx_handler,
                                        "SCL_thread", g_scl_thread_info.scl_thread_stack_start,
                                        g_scl_thread_info.scl_thread_stack_size,
-                                       g_scl_thread_info.scl_thread_priority, (cy_thread_arg_t) tmp);
+                                       g_scl_thread_info.scl_thread_priority, (cy_thread_arg_t) (uintptr_t) tmp);
         if (retval != SCL_SUCCESS) {
             return SCL_ERROR;
         }
@@ -235,7 +859,8 @@ static scl_result_t scl_check_version_compatibility(void) {
 
     printf("SCL Version: %d.%d.%d\r\n",scl_version_number.major,scl_version_number.minor,scl_version_number.patch);
 
-    retval = scl_send_data(SCL_TX_SCL_VERSION_NUMBER, (char *) &scl_version_number, TIMER_DEFAULT_VALUE);
+    retval = scl_send_command(SCL_TX_SCL_VERSION_NUMBER, &scl_version_number, sizeof(scl_version_number),
+                              SCL_COMMAND_NO_RESULT, 0, SCL_SEND_TIMEOUT_DEFAULT);
 
     if (retval == SCL_SUCCESS) {
         if (scl_version_number.scl_version_compatibility == NOT_COMPATIBLE) {
@@ -254,172 +879,1889 @@ static scl_result_t scl_check_version_compatibility(void) {
     return retval;
 }
 
-cy_en_syspm_status_t scl_deepsleep_callback(cy_stc_syspm_callback_params_t * callbackParams, cy_en_syspm_callback_mode_t mode)
+/** Checks whether SCL is ready to enter deep-sleep
+ *
+ *  @return  SCL_TRUE if no request is in flight or queued
+ */
+static scl_bool_t scl_idle(void)
 {
-    (void)callbackParams;
-    cy_en_syspm_status_t retStatus = CY_SYSPM_FAIL;
-
-    switch (mode)
-    {
-        case CY_SYSPM_CHECK_READY:
-            /* SCL in ready to enter deep-sleep if the mutex is free. */
-            if (!scl_mutex_aquired) {
-                retStatus = CY_SYSPM_SUCCESS;
-            }
-            break;
-
-        case CY_SYSPM_BEFORE_TRANSITION:
-            /* fall-through */
-        case CY_SYSPM_CHECK_FAIL:
-            /* fall-through */
-        case CY_SYSPM_AFTER_TRANSITION:
-            /* do nothing. */
-            retStatus = CY_SYSPM_SUCCESS;
-            break;
+#if (SCL_AGG_ENABLE)
+    /* Frames of the aggregate being filled are not sent yet */
+    if (scl_agg_info.current != NULL) {
+        return SCL_FALSE;
     }
-
-    return retStatus;
+#endif
+#if (SCL_TX_RING_ENABLE)
+    /* Frames waiting for the doorbell are not seen by NP yet */
+    if (scl_tx_doorbell.waiting != 0) {
+        return SCL_FALSE;
+    }
+#endif
+#if (SCL_TX_WMM_ENABLE)
+    /* Frames queued for the TX drain thread are not sent yet */
+    if (scl_tx_queue_is_idle() != SCL_TRUE) {
+        return SCL_FALSE;
+    }
+#endif
+    return ((scl_control_channel.busy == SCL_CHANNEL_IDLE) && (scl_control_channel.depth == 0) &&
+            (scl_data_path->busy == SCL_CHANNEL_IDLE) && (scl_data_path->depth == 0)) ? SCL_TRUE : SCL_FALSE;
 }
 
-/**
- * Register deep-sleep callback to check if SCL is OK to enter deep-sleep.
+/** Initializes the semaphores of the callers blocked in scl_send_data
+ *
+ *  @return  SCL_SUCCESS or SCL_ERROR
  */
-static scl_result_t scl_register_deepsleep_callback(void)
+static scl_result_t scl_waiter_init(void)
 {
-    scl_result_t result = SCL_SUCCESS;
-    static cy_stc_syspm_callback_params_t scl_deepsleep_pm_callback_param = {NULL, NULL};
-    static cy_stc_syspm_callback_t scl_deepsleep_pm_callback = {
-        .callback = &scl_deepsleep_callback,
-        .type = CY_SYSPM_DEEPSLEEP,
-        .callbackParams = &scl_deepsleep_pm_callback_param,
-        .order = SCL_PM_CALLBACK_ORDER
-    };
-
-    if (!Cy_SysPm_RegisterCallback(&scl_deepsleep_pm_callback))
-    {
-        result = SCL_ERROR;
+    uint32_t waiter;
+
+    if (cy_rtos_init_semaphore(&scl_waiter_info.free, SCL_MAX_BLOCKING_SENDERS,
+                               SCL_MAX_BLOCKING_SENDERS) != CY_RSLT_SUCCESS) {
+        return SCL_ERROR;
     }
-    return result;
+    for (waiter = 0; waiter < SCL_MAX_BLOCKING_SENDERS; waiter++) {
+        if (cy_rtos_init_semaphore(&scl_waiter_info.done[waiter], SEMAPHORE_MAXCOUNT,
+                                   SEMAPHORE_INITCOUNT) != CY_RSLT_SUCCESS) {
+            return SCL_ERROR;
+        }
+    }
+    scl_waiter_info.in_use = 0;
+    return SCL_SUCCESS;
 }
 
-static cy_rslt_t scl_acquire_mutex(void)
+/** Releases the frames of the abandoned requests NP has completed and frees their waiters */
+static void scl_waiter_reclaim(void)
 {
-    cy_rslt_t retval = CY_RTOS_GENERAL_ERROR;
+    uint32_t reclaim;
+    uint32_t waiter;
 
-    retval = cy_rtos_get_mutex(&scl_ipc_send_mutex, SCL_MUTEX_TIMEOUT);
-    if (retval == CY_RSLT_SUCCESS) {
-        scl_mutex_aquired = true;
+    do {
+        reclaim = scl_waiter_info.reclaim;
+    } while ((reclaim != 0) && !scl_ipc_atomic_cas(&scl_waiter_info.reclaim, reclaim, 0));
+    for (waiter = 0; reclaim != 0; waiter++) {
+        if (reclaim & (1UL << waiter)) {
+            reclaim &= ~(1UL << waiter);
+            scl_buffer_release(scl_command_frame(scl_waiter_info.request[waiter].index,
+                                                 &scl_waiter_info.data[waiter]), SCL_NETWORK_TX);
+            scl_waiter_put(waiter);
+        }
     }
+}
 
-    return retval;
+/** Allocates a waiter to the caller, waiting for one to be freed if needed
+ *
+ *  @param   timeout   Maximum time (in ms) to wait for a free waiter.
+ *  @param   waiter    Receives the index of the waiter.
+ *
+ *  @return  SCL_SUCCESS or SCL_TIMEOUT
+ */
+static scl_result_t scl_waiter_get(uint32_t timeout, uint32_t *waiter_index)
+{
+    uint32_t in_use;
+    uint32_t waiter;
+
+    scl_waiter_reclaim();
+    if (cy_rtos_get_semaphore(&scl_waiter_info.free, timeout, SCL_FALSE) != CY_RSLT_SUCCESS) {
+        return SCL_TIMEOUT;
+    }
+    while (SCL_TRUE) {
+        in_use = scl_waiter_info.in_use;
+        for (waiter = 0; waiter < SCL_MAX_BLOCKING_SENDERS; waiter++) {
+            if (!(in_use & (1UL << waiter))) {
+                break;
+            }
+        }
+        /* The free semaphore guarantees a clear bit, retry if another caller took it first */
+        if ((waiter < SCL_MAX_BLOCKING_SENDERS) &&
+            scl_ipc_atomic_cas(&scl_waiter_info.in_use, in_use, in_use | (1UL << waiter))) {
+            *waiter_index = waiter;
+            return SCL_SUCCESS;
+        }
+    }
 }
 
-static void scl_release_mutex(void)
+/** Returns a waiter allocated by scl_waiter_get */
+static void scl_waiter_put(uint32_t waiter)
 {
-    cy_rtos_set_mutex(&scl_ipc_send_mutex);
-    scl_mutex_aquired = false;
+    uint32_t in_use;
+
+    do {
+        in_use = scl_waiter_info.in_use;
+    } while (!scl_ipc_atomic_cas(&scl_waiter_info.in_use, in_use, in_use & ~(1UL << waiter)));
+    cy_rtos_set_semaphore(&scl_waiter_info.free, SCL_IN_ISR());
 }
 
-scl_result_t scl_init(void)
+/** Copies a command to the storage of SCL, which NP reads and writes in place of the caller's memory
+ *
+ *  The result the command points to is copied as well, and the copy of the command points to
+ *  the copy of the result.
+ *
+ *  @return  the copy of the command, or buffer if the command is not copied
+ */
+static char *scl_command_stage(struct scl_command_data *data, const struct scl_command_layout *layout,
+                               char *buffer)
 {
-    scl_result_t retval = SCL_SUCCESS;
-    cy_rslt_t result = CY_RSLT_SUCCESS;
-    uint32_t configuration_parameters = INTIAL_VALUE;
+    uint8_t *command = (uint8_t *) &data->command;
+    void *result;
 
-#ifdef MBED_CONF_TARGET_NP_CLOUD_DISABLE
-    configuration_parameters = (MBED_CONF_TARGET_NP_CLOUD_DISABLE << 1);
-#else
-    configuration_parameters = (false << 1);
-#endif
-#ifdef MBED_CONF_TARGET_NP_WIFI_ENABLE
-    configuration_parameters |= MBED_CONF_TARGET_NP_WIFI_ENABLE;
-#else
-    configuration_parameters |= false;
-#endif
-    /* Intialize the semaphore to be used for waiting in scl_send_data */
-    retval = cy_rtos_init_semaphore(&scl_channel_release, SEMAPHORE_MAXCOUNT, SEMAPHORE_INITCOUNT);
-    if (retval != SCL_SUCCESS) {
-        return SCL_ERROR;
+    if (layout == NULL) {
+        return buffer;
     }
-
-    /* Intialize the Mutex to be used for around IPC registers in scl_send_data */
-    result = cy_rtos_init_mutex(&scl_ipc_send_mutex);
-    if (result != CY_RSLT_SUCCESS) {
-        return SCL_ERROR;
+    memcpy(command, buffer, layout->size);
+    if (layout->result_offset != SCL_COMMAND_NO_RESULT) {
+        memcpy(&result, &command[layout->result_offset], sizeof(result));
+        if (result != NULL) {
+            memcpy(&data->result, result, layout->result_size);
+            result = &data->result;
+            memcpy(&command[layout->result_offset], &result, sizeof(result));
+        }
     }
+    return (char *) command;
+}
 
-    scl_config();
-
-    if (g_scl_thread_info.scl_inited != SCL_TRUE) {
-        retval = scl_check_version_compatibility();
-        if (retval != SCL_SUCCESS) {
-            printf("SCL handshake failed, please try again\n");
-            return retval;
-        }
-        retval = scl_thread_init();
-        if (retval != SCL_SUCCESS) {
-            SCL_LOG(("Thread init failed\r\n"));
-            return SCL_ERROR;
-        } else {
-            retval = scl_send_data(SCL_TX_CONFIG_PARAMETERS, (char *) &configuration_parameters, TIMER_DEFAULT_VALUE);
-        }
+/** Copies a command completed by NP and its result back to the caller */
+static void scl_command_unstage(struct scl_command_data *data, const struct scl_command_layout *layout,
+                                char *buffer)
+{
+    void *result = NULL;
 
-        /* Register deep-sleep callback. */
-        retval = scl_register_deepsleep_callback();
-        if (retval != SCL_SUCCESS) {
-            printf("Failed to register SCL PM callback\n");
-        }
+    if (layout == NULL) {
+        return;
+    }
+    if (layout->result_offset != SCL_COMMAND_NO_RESULT) {
+        memcpy(&result, &buffer[layout->result_offset], sizeof(result));
+    }
+    memcpy(buffer, &data->command, layout->size);
+    if (result != NULL) {
+        /* Keep the caller's pointer in place of the one to the copy */
+        memcpy(&buffer[layout->result_offset], &result, sizeof(result));
+        memcpy(result, &data->result, layout->result_size);
     }
-    return retval;
 }
 
-scl_result_t scl_send_data(int index, char *buffer, uint32_t timeout)
+/** Returns the layout of a frame copied to the storage of SCL, NULL for other commands */
+static const struct scl_command_layout *scl_frame_layout(int index)
 {
-    uint32_t acquire_state;
-    IPC_STRUCT_Type *scl_send = NULL;
-    cy_rslt_t retval = CY_RSLT_SUCCESS;
+    static const struct scl_command_layout frame = { sizeof(scl_tx_buf_t), SCL_COMMAND_NO_RESULT, 0 };
+#if (SCL_TX_SG_ENABLE)
+    static const struct scl_command_layout sg = { sizeof(struct scl_tx_sg), SCL_COMMAND_NO_RESULT, 0 };
+#endif
 
-    SCL_LOG(("scl_send_data index = %d\r\n", index));
-    CHECK_BUFFER_NULL(buffer);
-    /* Acquire the mutex for IPC registers */
-    retval = scl_acquire_mutex();
-    if (retval == CY_RSLT_SUCCESS) {
-        SCL_LOG(("scl_send_data index = %d\r\n", index));
-        scl_send = Cy_IPC_Drv_GetIpcBaseAddress(SCL_TX_CHANNEL);
-
-        if (!(REG_IPC_STRUCT_LOCK_STATUS(scl_send) & SCL_LOCK_ACQUIRE_STATUS)) {
-            acquire_state = REG_IPC_STRUCT_ACQUIRE(scl_send);
-            if (!(acquire_state & SCL_LOCK_ACQUIRE_STATUS)) {
-                SCL_LOG(("SCL IPC Lock Acquire Failed\r\n"));
-                /* Release the Mutex */
-                scl_release_mutex();
-                return SCL_ERROR;
-            }
-            REG_IPC_STRUCT_DATA0(scl_send) = index;
-            REG_IPC_STRUCT_DATA1(scl_send) = (uint32_t) buffer;
-            REG_IPC_STRUCT_NOTIFY(scl_send) = SCL_NOTIFY;
-            /* Wait until the IPC Channel is released by NP */
-            cy_rtos_get_semaphore(&scl_channel_release, CY_RTOS_NEVER_TIMEOUT, SCL_FALSE);
-            /* Release the Mutex */
-            scl_release_mutex();
-            return SCL_SUCCESS;
-        } else {
-            SCL_LOG(("unable to acquire lock\r\n"));
-            /* Release the Mutex */
-            scl_release_mutex();
-            return SCL_ERROR;
-        }
+    switch (index) {
+        case SCL_TX_SEND_OUT:
+            return &frame;
+#if (SCL_TX_SG_ENABLE)
+        case SCL_TX_SEND_OUT_SG:
+            return &sg;
+#endif
+        default:
+            return NULL;
     }
-    else {
-        SCL_LOG(("Failed to acquire mutex for Writing to IPC\r\n"));
-        return SCL_ERROR;
+}
+
+/** Returns the buffer of a frame copied to the storage of SCL, NULL for other commands */
+static scl_buffer_t scl_command_frame(int index, struct scl_command_data *data)
+{
+    switch (index & SCL_IPC_INDEX_MASK) {
+        case SCL_TX_SEND_OUT:
+            return data->command.tx_buf.buffer;
+#if (SCL_TX_SG_ENABLE)
+        case SCL_TX_SEND_OUT_SG:
+            return data->command.sg.buffer;
+#endif
+        default:
+            return NULL;
     }
 }
 
-scl_result_t scl_end(void)
+/** Returns the timeout to be used for a command
+ *
+ *  @return  timeout, or the default timeout of the command for SCL_SEND_TIMEOUT_DEFAULT
+ */
+static uint32_t scl_send_timeout(int index, uint32_t timeout)
 {
-    scl_result_t retval = SCL_SUCCESS;
-    if (g_scl_thread_info.scl_inited == SCL_TRUE) {
+    if (timeout != SCL_SEND_TIMEOUT_DEFAULT) {
+        return timeout;
+    }
+    switch (index) {
+        case SCL_TX_WIFI_ON:
+            return WIFI_ON_TIMEOUT;
+        case SCL_TX_CONNECT:
+        case SCL_TX_WIFI_JOIN:
+            return NW_CONNECT_TIMEOUT * 1000;
+        case SCL_TX_DISCONNECT:
+            return NW_DISCONNECT_TIMEOUT * 1000;
+        case SCL_TX_WIFI_SET_UP:
+        case SCL_TX_GET_MAC:
+        case SCL_TX_REGISTER_MULTICAST_ADDRESS:
+        case SCL_TX_WIFI_GET_RSSI:
+        case SCL_TX_WIFI_GET_BSSID:
+        case SCL_TX_GET_BSS_INFO:
+        case SCL_TX_SET_IOCTL_VALUE:
+        case SCL_TX_TRANSCEIVE_READY:
+        case SCL_TX_SCL_VERSION_NUMBER:
+        case SCL_TX_WIFI_NW_PARAM:
+            return SCL_IOCTL_TIMEOUT;
+        case SCL_TX_SCAN:
+            return SCL_SCAN_TIMEOUT;
+        default:
+            return TIMER_DEFAULT_VALUE;
+    }
+}
+
+/** Returns the part of timeout left since start
+ *
+ *  @return  Remaining time (in ms), 0 once the timeout has expired
+ */
+static uint32_t scl_remaining_time(cy_time_t start, uint32_t timeout)
+{
+    cy_time_t now;
+
+    if (timeout == CY_RTOS_NEVER_TIMEOUT) {
+        return timeout;
+    }
+    cy_rtos_get_time(&now);
+    if ((uint32_t) (now - start) >= timeout) {
+        return 0;
+    }
+    return timeout - (uint32_t) (now - start);
+}
+
+/** Counts a timeout of the command */
+static void scl_count_timeout(int index)
+{
+    index &= SCL_IPC_INDEX_MASK;
+    SCL_TRACE(SCL_TRACE_TIMEOUT, index, 0);
+    if (index < SCL_SEND_TIMEOUT_INDEX_MAX) {
+        scl_ipc_atomic_add(&scl_send_timeouts[index], 1);
+    }
+}
+
+/** Gives up waiting for a request of scl_send_data
+ *
+ *  A request still queued is dropped by the drainer, which frees the waiter. A request
+ *  already written to the IPC channel cannot be taken back: it is abandoned with its waiter,
+ *  whose storage NP may still read or write, and with a reference to its frame. Both are
+ *  freed once NP releases the channel, which stays unresponsive until then.
+ *
+ *  @return  SCL_TIMEOUT, or the final status of a request completed meanwhile
+ */
+static scl_result_t scl_cancel_request(int index, uint32_t waiter)
+{
+    scl_ipc_request_t *request = &scl_waiter_info.request[waiter];
+    struct scl_tx_channel_t *tx_channel = scl_select_channel(index);
+    scl_buffer_t frame = scl_command_frame(index, &scl_waiter_info.data[waiter]);
+
+    if (scl_ipc_atomic_cas(&request->state, SCL_REQUEST_QUEUED, SCL_REQUEST_CANCELLED)) {
+        return SCL_TIMEOUT;
+    }
+    if (frame != NULL) {
+        scl_buffer_ref(frame);
+    }
+    scl_ipc_atomic_add(&tx_channel->abandoned, 1);
+    if (scl_ipc_atomic_cas(&scl_waiter_info.wait[waiter], SCL_WAIT_PENDING, SCL_WAIT_ABANDONED)) {
+        return SCL_TIMEOUT;
+    }
+    /* The completion is already running, it gives the semaphore right away */
+    scl_ipc_atomic_add(&tx_channel->abandoned, -1);
+    if (frame != NULL) {
+        scl_buffer_release(frame, SCL_NETWORK_TX);
+    }
+    cy_rtos_get_semaphore(&scl_waiter_info.done[waiter], CY_RTOS_NEVER_TIMEOUT, SCL_FALSE);
+    return request->status;
+}
+
+scl_result_t scl_get_send_timeouts(int index, uint32_t *count)
+{
+    CHECK_BUFFER_NULL(count);
+    if ((index < 0) || (index >= SCL_SEND_TIMEOUT_INDEX_MAX)) {
+        return SCL_BADARG;
+    }
+    *count = scl_send_timeouts[index];
+    return SCL_SUCCESS;
+}
+
+/** Initializes the request queue of a TX channel
+ *
+ *  @return  SCL_SUCCESS
+ */
+static scl_result_t scl_channel_init(struct scl_tx_channel_t *tx_channel)
+{
+    scl_ipc_queue_init(&tx_channel->queue);
+    tx_channel->depth = 0;
+    tx_channel->abandoned = 0;
+    tx_channel->active = NULL;
+    tx_channel->busy = SCL_CHANNEL_IDLE;
+    return SCL_SUCCESS;
+}
+
+/** Returns the TX channel that carries the command */
+static struct scl_tx_channel_t *scl_select_channel(int index)
+{
+    if ((index == SCL_TX_SEND_OUT) || (index == SCL_TX_SEND_OUT_SG) || (index == SCL_TX_RING_DOORBELL) ||
+        (index == SCL_TX_SEND_OUT_AGG)) {
+        return scl_data_path;
+    }
+    return &scl_control_channel;
+}
+
+#if (SCL_DATA_CHANNEL_ENABLE)
+/** Moves the data path to its own IPC channel if NP supports it
+ *
+ *  @return  SCL_SUCCESS if NP serves the data channel or error code
+ */
+static scl_result_t scl_data_channel_init(void)
+{
+    scl_result_t retval = SCL_SUCCESS;
+    struct scl_channel_config channel_config;
+
+    retval = scl_channel_init(&scl_data_channel);
+    if (retval != SCL_SUCCESS) {
+        return retval;
+    }
+    channel_config.channel = SCL_TX_DATA_CHANNEL;
+    channel_config.retval = SCL_UNSUPPORTED;
+    retval = scl_send_command(SCL_TX_CHANNEL_CONFIG, &channel_config, sizeof(channel_config), SCL_COMMAND_NO_RESULT, 0,
+                              SCL_SEND_TIMEOUT_DEFAULT);
+    if ((retval == SCL_SUCCESS) && (channel_config.retval == SCL_SUCCESS)) {
+        scl_data_path = &scl_data_channel;
+        return SCL_SUCCESS;
+    }
+    return SCL_UNSUPPORTED;
+}
+#endif
+
+scl_result_t scl_get_channel_stats(scl_ipc_channel_t channel, scl_ipc_channel_stats_t *stats)
+{
+    struct scl_tx_channel_t *tx_channel = &scl_control_channel;
+    uint32_t state;
+
+    CHECK_BUFFER_NULL(stats);
+    if (channel == SCL_IPC_DATA_CHANNEL) {
+        tx_channel = scl_data_path;
+    } else if (channel != SCL_IPC_CONTROL_CHANNEL) {
+        return SCL_BADARG;
+    }
+    state = cyhal_system_critical_section_enter();
+    *stats = tx_channel->stats;
+    cyhal_system_critical_section_exit(state);
+    return SCL_SUCCESS;
+}
+
+#if (SCL_TAGGED_CONTROL_ENABLE)
+/** Enables tagged control requests if NP supports them
+ *
+ *  @return  SCL_SUCCESS if NP accepted tagged requests or error code
+ */
+static scl_result_t scl_tag_init(void)
+{
+    scl_result_t retval = SCL_SUCCESS;
+    struct scl_tag_config tag_config;
+    uint32_t tag;
+
+    if (cy_rtos_init_semaphore(&scl_tag_info.free, SCL_MAX_OUTSTANDING_CONTROL,
+                               SCL_MAX_OUTSTANDING_CONTROL) != CY_RSLT_SUCCESS) {
+        return SCL_ERROR;
+    }
+    for (tag = 0; tag < SCL_MAX_OUTSTANDING_CONTROL; tag++) {
+        if (cy_rtos_init_semaphore(&scl_tag_info.done[tag], SEMAPHORE_MAXCOUNT,
+                                   SEMAPHORE_INITCOUNT) != CY_RSLT_SUCCESS) {
+            return SCL_ERROR;
+        }
+    }
+    scl_tag_info.in_use = 0;
+
+    tag_config.max_tags = SCL_MAX_OUTSTANDING_CONTROL;
+    tag_config.retval = SCL_UNSUPPORTED;
+    retval = scl_send_command(SCL_TX_TAG_CONFIG, &tag_config, sizeof(tag_config), SCL_COMMAND_NO_RESULT, 0,
+                              SCL_SEND_TIMEOUT_DEFAULT);
+    if ((retval == SCL_SUCCESS) && (tag_config.retval == SCL_SUCCESS)) {
+        scl_tag_info.active = true;
+        return SCL_SUCCESS;
+    }
+    return SCL_UNSUPPORTED;
+}
+
+/** Returns true for the commands that are sent as tagged control requests */
+static bool scl_is_tagged_command(int index)
+{
+    switch (index) {
+        case SCL_TX_SEND_OUT:
+        case SCL_TX_SEND_OUT_SG:
+        case SCL_TX_SG_CONFIG:
+        case SCL_TX_CREDIT_CONFIG:
+        case SCL_TX_RING_CONFIG:
+        case SCL_TX_RING_DOORBELL:
+        case SCL_TX_TAG_CONFIG:
+        case SCL_TX_RX_POST_CONFIG:
+        case SCL_TX_AGG_CONFIG:
+        case SCL_TX_SEND_OUT_AGG:
+            return false;
+        default:
+            return scl_tag_info.active;
+    }
+}
+
+/** Sends a control command with a tag and waits for the reply of NP
+ *
+ *  The IPC channel is released by NP as soon as it has read the command,
+ *  so other requests can be sent while this one is processed. At the timeout, a command
+ *  NP has read is abandoned with its tag, which the reply frees.
+ *
+ *  @return  SCL_SUCCESS once NP replied, SCL_TIMEOUT or error code
+ */
+static scl_result_t scl_send_tagged(int index, char *buffer, const struct scl_command_layout *layout,
+                                    uint32_t timeout)
+{
+    scl_result_t retval = SCL_SUCCESS;
+    uint32_t tag;
+    uint32_t state;
+    uint32_t tagged_index;
+    cy_time_t start;
+
+    cy_rtos_get_time(&start);
+    if (cy_rtos_get_semaphore(&scl_tag_info.free, timeout, SCL_FALSE) != CY_RSLT_SUCCESS) {
+        scl_count_timeout(index);
+        return SCL_TIMEOUT;
+    }
+    /* The free semaphore is given once both references are dropped, so a clear bit is reusable */
+    state = cyhal_system_critical_section_enter();
+    for (tag = 0; tag < SCL_MAX_OUTSTANDING_CONTROL; tag++) {
+        if (!(scl_tag_info.in_use & (1 << tag))) {
+            scl_tag_info.in_use |= (1 << tag);
+            break;
+        }
+    }
+    cyhal_system_critical_section_exit(state);
+
+    scl_tag_info.refs[tag] = SCL_TAG_REFS;
+    scl_tag_info.result[tag] = SCL_PENDING;
+    scl_tag_info.wait[tag] = SCL_WAIT_PENDING;
+    tagged_index = (uint32_t) index | SCL_IPC_TAGGED | (tag << SCL_IPC_TAG_SHIFT);
+    retval = scl_send_data_async((int) tagged_index, scl_command_stage(&scl_tag_info.data[tag], layout, buffer),
+                                 &scl_tag_info.request[tag], scl_tag_request_complete, (void *) (uintptr_t) tag);
+    if (retval != SCL_SUCCESS) {
+        /* The callback will not be called, drop its reference as well */
+        scl_tag_release(tag);
+        scl_tag_release(tag);
+        return retval;
+    }
+    /* Wait for the reply of NP on the RX channel */
+    if (cy_rtos_get_semaphore(&scl_tag_info.done[tag], scl_remaining_time(start, timeout),
+                              SCL_FALSE) != CY_RSLT_SUCCESS) {
+        if (scl_ipc_atomic_cas(&scl_tag_info.request[tag].state, SCL_REQUEST_QUEUED, SCL_REQUEST_CANCELLED)) {
+            /* Never posted, the drainer completes the request and drops its reference */
+            SCL_LOG(("tagged index = %d timed out\r\n", index));
+            scl_count_timeout(index);
+            scl_tag_release(tag);
+            return SCL_TIMEOUT;
+        }
+        /* NP has the command, it may still write the storage of the tag until it replies */
+        scl_ipc_atomic_add(&scl_control_channel.abandoned, 1);
+        if (scl_ipc_atomic_cas(&scl_tag_info.wait[tag], SCL_WAIT_PENDING, SCL_WAIT_ABANDONED)) {
+            /* The reply drops the reference of the caller */
+            SCL_LOG(("tagged index = %d abandoned\r\n", index));
+            scl_count_timeout(index);
+            return SCL_TIMEOUT;
+        }
+        /* The reply is already being handled, it gives the semaphore right away */
+        scl_ipc_atomic_add(&scl_control_channel.abandoned, -1);
+        cy_rtos_get_semaphore(&scl_tag_info.done[tag], CY_RTOS_NEVER_TIMEOUT, SCL_FALSE);
+    }
+    retval = scl_tag_info.result[tag];
+    if (retval == SCL_SUCCESS) {
+        scl_command_unstage(&scl_tag_info.data[tag], layout, buffer);
+    }
+    scl_tag_release(tag);
+    return retval;
+}
+
+/** Drops a reference to a tag, the last one returns the tag to the free tags */
+static void scl_tag_release(uint32_t tag)
+{
+    uint32_t state;
+
+    if (scl_ipc_atomic_add(&scl_tag_info.refs[tag], -1) != 0) {
+        return;
+    }
+    state = cyhal_system_critical_section_enter();
+    scl_tag_info.in_use &= ~(1 << tag);
+    cyhal_system_critical_section_exit(state);
+    cy_rtos_set_semaphore(&scl_tag_info.free, SCL_IN_ISR());
+}
+
+/** Resumes the caller of the tag with the result of its command,
+ *  or drops the reference of a caller that gave up on it
+ */
+static void scl_tag_resume(uint32_t tag, scl_result_t result)
+{
+    if (scl_ipc_atomic_cas(&scl_tag_info.wait[tag], SCL_WAIT_PENDING, SCL_WAIT_RESUMED)) {
+        scl_tag_info.result[tag] = result;
+        cy_rtos_set_semaphore(&scl_tag_info.done[tag], SCL_IN_ISR());
+    } else if (scl_ipc_atomic_cas(&scl_tag_info.wait[tag], SCL_WAIT_ABANDONED, SCL_WAIT_RESUMED)) {
+        scl_ipc_atomic_add(&scl_control_channel.abandoned, -1);
+        scl_tag_release(tag);
+    }
+}
+
+/** Completion callback of a tagged request
+ *
+ *  Resumes the caller if the request could not be written to the IPC channel,
+ *  then drops the reference of the request.
+ */
+static void scl_tag_request_complete(scl_ipc_request_t *request, scl_result_t result, void *user_data)
+{
+    uint32_t tag = (uint32_t) (uintptr_t) user_data;
+
+    if ((result != SCL_SUCCESS) && (request->state != SCL_REQUEST_CANCELLED)) {
+        scl_tag_resume(tag, result);
+    }
+    scl_tag_release(tag);
+}
+
+/** Resumes the caller waiting for the reply to the tag */
+static void scl_tag_complete(uint32_t tag)
+{
+    if ((tag < SCL_MAX_OUTSTANDING_CONTROL) && (scl_tag_info.in_use & (1 << tag))) {
+        scl_tag_resume(tag, SCL_SUCCESS);
+    } else {
+        SCL_LOG(("reply for unknown tag %lu\r\n", (unsigned long) tag));
+    }
+}
+#endif
+
+#if (SCL_RX_RING_ENABLE)
+/** Registers the RX ring with NP
+ *
+ *  @return  SCL_SUCCESS if NP posts to the ring or error code
+ */
+static scl_result_t scl_rx_ring_init(void)
+{
+    scl_result_t retval = SCL_SUCCESS;
+    struct scl_ring_config ring_config;
+
+    retval = scl_ipc_ring_init(&scl_rx_ring_info.ring, scl_rx_ring_info.desc, SCL_RX_RING_SIZE);
+    if (retval != SCL_SUCCESS) {
+        return retval;
+    }
+    /* The SCL thread sleeps until NP rings the doorbell for the first descriptors */
+    scl_ipc_ring_arm_doorbell(&scl_rx_ring_info.ring);
+
+    ring_config.ring_id = SCL_IPC_RING_RX;
+    ring_config.ring = &scl_rx_ring_info.ring;
+    ring_config.retval = SCL_UNSUPPORTED;
+    retval = scl_send_command(SCL_TX_RING_CONFIG, &ring_config, sizeof(ring_config), SCL_COMMAND_NO_RESULT, 0,
+                              SCL_SEND_TIMEOUT_DEFAULT);
+    if ((retval == SCL_SUCCESS) && (ring_config.retval == SCL_SUCCESS)) {
+        scl_rx_ring_info.active = true;
+        return SCL_SUCCESS;
+    }
+    return SCL_UNSUPPORTED;
+}
+#endif
+
+#if (SCL_RX_POST_ENABLE)
+/** Posts RX buffers to NP until the post ring is full
+ *  Called from the SCL thread only, which is the single producer of the ring.
+ *
+ *  @param   force      Refill even if fewer than SCL_RX_POST_BATCH descriptors are free.
+ */
+static void scl_rx_post_refill(bool force)
+{
+    scl_ipc_ring_t *ring = &scl_rx_post_info.ring;
+    scl_ipc_desc_t desc;
+    scl_buffer_t buffer;
+    uint32_t free_desc = ring->size - scl_ipc_ring_count(ring);
+
+    if (!force && (free_desc < SCL_RX_POST_BATCH)) {
+        return;
+    }
+    desc.index = SCL_RX_DATA;
+    desc.length = SCL_RX_POST_BUFFER_SIZE;
+    while (free_desc > 0) {
+        if (scl_host_buffer_get(&buffer, SCL_NETWORK_RX, SCL_RX_POST_BUFFER_SIZE, SCL_FALSE) != SCL_SUCCESS) {
+            /* NP falls back to SCL_RX_GET_BUFFER until the next refill */
+            scl_rx_stats.post_alloc_failures++;
+            break;
+        }
+        desc.buffer = buffer;
+        if (scl_ipc_ring_put(ring, &desc) != SCL_SUCCESS) {
+            scl_buffer_release(buffer, SCL_NETWORK_RX);
+            break;
+        }
+        scl_rx_stats.posted_buffers++;
+        free_desc--;
+    }
+}
+
+/** Fills the RX buffer post ring and registers it with NP
+ *
+ *  @return  SCL_SUCCESS if NP takes its RX buffers from the ring or error code
+ */
+static scl_result_t scl_rx_post_init(void)
+{
+    scl_result_t retval = SCL_SUCCESS;
+    struct scl_rx_post_config post_config;
+    scl_ipc_desc_t desc;
+
+    if (!scl_rx_ring_info.active) {
+        return SCL_UNSUPPORTED;
+    }
+    retval = scl_ipc_ring_init(&scl_rx_post_info.ring, scl_rx_post_info.desc, SCL_RX_POST_RING_SIZE);
+    if (retval != SCL_SUCCESS) {
+        return retval;
+    }
+    scl_rx_post_refill(true);
+
+    post_config.ring = &scl_rx_post_info.ring;
+    post_config.low_watermark = SCL_RX_POST_LOW_WATERMARK;
+    post_config.retval = SCL_UNSUPPORTED;
+    retval = scl_send_command(SCL_TX_RX_POST_CONFIG, &post_config, sizeof(post_config), SCL_COMMAND_NO_RESULT, 0,
+                              SCL_SEND_TIMEOUT_DEFAULT);
+    if ((retval == SCL_SUCCESS) && (post_config.retval == SCL_SUCCESS)) {
+        scl_rx_post_info.active = true;
+        return SCL_SUCCESS;
+    }
+    /* NP does not use the ring, give the buffers back */
+    while (scl_ipc_ring_get(&scl_rx_post_info.ring, &desc) == SCL_SUCCESS) {
+        scl_buffer_release(desc.buffer, SCL_NETWORK_RX);
+    }
+    return SCL_UNSUPPORTED;
+}
+#endif
+
+#if (SCL_TX_CREDIT_ENABLE)
+/** Enables credit-based TX flow control if NP supports it
+ *
+ *  @return  SCL_SUCCESS if NP grants credits or error code
+ */
+static scl_result_t scl_tx_credit_init(void)
+{
+    scl_result_t retval = SCL_SUCCESS;
+    struct scl_credit_config credit_config;
+
+    scl_tx_credit_info.shared.granted = 0;
+    scl_tx_credit_info.shared.consumed = 0;
+    scl_tx_credit_info.shared.flags = 0;
+    credit_config.credits = &scl_tx_credit_info.shared;
+    credit_config.retval = SCL_UNSUPPORTED;
+    retval = scl_send_command(SCL_TX_CREDIT_CONFIG, &credit_config, sizeof(credit_config), SCL_COMMAND_NO_RESULT, 0,
+                              SCL_SEND_TIMEOUT_DEFAULT);
+    if ((retval == SCL_SUCCESS) && (credit_config.retval == SCL_SUCCESS)) {
+        scl_tx_credit_info.active = true;
+        return SCL_SUCCESS;
+    }
+    return SCL_UNSUPPORTED;
+}
+
+/** Calls the resume callback once NP granted credits to a flow controlled sender
+ *  Called from the SCL thread.
+ */
+static void scl_tx_credit_poll(void)
+{
+    struct scl_tx_credits *credits = &scl_tx_credit_info.shared;
+    uint32_t state;
+
+    if (!scl_tx_credit_info.stalled || ((credits->granted - credits->consumed) == 0)) {
+        return;
+    }
+    state = cyhal_system_critical_section_enter();
+    scl_tx_credit_info.stalled = false;
+    credits->flags &= ~SCL_TX_CREDIT_FLAG_RESUME;
+    cyhal_system_critical_section_exit(state);
+    if (scl_tx_resume_callback != NULL) {
+        scl_tx_resume_callback(scl_tx_resume_user_data);
+    }
+}
+#endif
+
+scl_result_t scl_tx_credit_take(void)
+{
+#if (SCL_TX_CREDIT_ENABLE)
+    struct scl_tx_credits *credits = &scl_tx_credit_info.shared;
+    scl_result_t retval = SCL_SUCCESS;
+    uint32_t state;
+
+    if (!scl_tx_credit_info.active) {
+        return SCL_SUCCESS;
+    }
+    state = cyhal_system_critical_section_enter();
+    if ((credits->granted - credits->consumed) == 0) {
+        /* Ask NP for SCL_RX_CREDIT_UPDATE, then look again for credits granted meanwhile */
+        credits->flags |= SCL_TX_CREDIT_FLAG_RESUME;
+        SCL_IPC_MEMORY_BARRIER();
+        if ((credits->granted - credits->consumed) == 0) {
+            scl_tx_credit_info.stalled = true;
+            retval = SCL_FLOW_CONTROLLED;
+        }
+    }
+    if (retval == SCL_SUCCESS) {
+        credits->consumed++;
+    }
+    cyhal_system_critical_section_exit(state);
+    return retval;
+#else
+    return SCL_SUCCESS;
+#endif
+}
+
+void scl_tx_credit_return(void)
+{
+#if (SCL_TX_CREDIT_ENABLE)
+    uint32_t state;
+
+    if (scl_tx_credit_info.active) {
+        state = cyhal_system_critical_section_enter();
+        scl_tx_credit_info.shared.consumed--;
+        cyhal_system_critical_section_exit(state);
+    }
+#endif
+}
+
+scl_result_t scl_register_tx_resume_callback(scl_tx_resume_callback_t callback, void *user_data)
+{
+    uint32_t state;
+
+    state = cyhal_system_critical_section_enter();
+    scl_tx_resume_callback = callback;
+    scl_tx_resume_user_data = user_data;
+    cyhal_system_critical_section_exit(state);
+    return SCL_SUCCESS;
+}
+
+#if (SCL_TX_SG_ENABLE)
+/** Enables scatter-gather transmit if NP supports it
+ *
+ *  @return  SCL_SUCCESS if NP accepts SCL_TX_SEND_OUT_SG or error code
+ */
+static scl_result_t scl_tx_sg_init(void)
+{
+    scl_result_t retval = SCL_SUCCESS;
+    struct scl_sg_config sg_config;
+
+    sg_config.max_entries = SCL_TX_SG_MAX_ENTRIES;
+    sg_config.retval = SCL_UNSUPPORTED;
+    retval = scl_send_command(SCL_TX_SG_CONFIG, &sg_config, sizeof(sg_config), SCL_COMMAND_NO_RESULT, 0,
+                              SCL_SEND_TIMEOUT_DEFAULT);
+    if ((retval == SCL_SUCCESS) && (sg_config.retval == SCL_SUCCESS)) {
+        scl_tx_sg_active = true;
+        return SCL_SUCCESS;
+    }
+    return SCL_UNSUPPORTED;
+}
+
+/** Describes the pieces of a chained frame in a scatter-gather list
+ *
+ *  @return  SCL_SUCCESS or SCL_UNSUPPORTED if the frame has to be flattened
+ */
+static scl_result_t scl_tx_sg_build(scl_tx_buf_t *tx_buf, struct scl_tx_sg *sg)
+{
+    scl_buffer_t piece = tx_buf->buffer;
+
+    if (!scl_tx_sg_active) {
+        return SCL_UNSUPPORTED;
+    }
+    sg->buffer = tx_buf->buffer;
+    sg->size = tx_buf->size;
+    sg->count = 0;
+    while (piece != NULL) {
+        if (sg->count == SCL_TX_SG_MAX_ENTRIES) {
+            return SCL_UNSUPPORTED;
+        }
+        sg->entry[sg->count].data = scl_buffer_get_current_piece_data_pointer(piece);
+        sg->entry[sg->count].length = scl_buffer_get_current_piece_size(piece);
+        sg->count++;
+        piece = scl_buffer_get_next_piece(piece);
+    }
+    return SCL_SUCCESS;
+}
+
+/** Sends a chained frame through the IPC channel, as a scatter-gather list if possible
+ *
+ *  @return  SCL_SUCCESS or error code
+ */
+static scl_result_t scl_send_chain(scl_tx_buf_t *tx_buf, uint32_t timeout)
+{
+    struct scl_tx_sg sg;
+    scl_tx_buf_t flat;
+    scl_result_t retval;
+
+    if (scl_tx_sg_build(tx_buf, &sg) == SCL_SUCCESS) {
+        /* NP has read all the segments once it releases the channel */
+        return scl_send_data_wait(SCL_TX_SEND_OUT_SG, (char *) &sg, NULL, timeout);
+    }
+    retval = scl_buffer_flatten(tx_buf->buffer, &flat.buffer);
+    if (retval != SCL_SUCCESS) {
+        return retval;
+    }
+    flat.size = tx_buf->size;
+    flat.priority = tx_buf->priority;
+    retval = scl_send_data_wait(SCL_TX_SEND_OUT, (char *) &flat, NULL, timeout);
+    scl_buffer_release(flat.buffer, SCL_NETWORK_TX);
+    return retval;
+}
+#endif
+
+#if (SCL_TX_RING_ENABLE)
+/** Registers the TX ring with NP
+ *
+ *  @return  SCL_SUCCESS if NP services the ring or error code
+ */
+static scl_result_t scl_tx_ring_init(void)
+{
+    scl_result_t retval = SCL_SUCCESS;
+    struct scl_ring_config ring_config;
+
+    if (cy_rtos_init_mutex(&scl_tx_ring_info.mutex) != CY_RSLT_SUCCESS) {
+        return SCL_ERROR;
+    }
+    if (cy_rtos_init_semaphore(&scl_tx_ring_info.room, SEMAPHORE_MAXCOUNT, SEMAPHORE_INITCOUNT) != CY_RSLT_SUCCESS) {
+        return SCL_ERROR;
+    }
+#if (SCL_TX_DOORBELL_COALESCE_ENABLE)
+    if (cy_rtos_init_timer(&scl_tx_doorbell.timer, CY_TIMER_TYPE_ONCE, scl_tx_doorbell_timeout,
+                           (cy_timer_callback_arg_t) 0) != CY_RSLT_SUCCESS) {
+        return SCL_ERROR;
+    }
+#endif
+    retval = scl_ipc_ring_init(&scl_tx_ring_info.ring, scl_tx_ring_info.desc, SCL_TX_RING_SIZE);
+    if (retval != SCL_SUCCESS) {
+        return retval;
+    }
+    scl_tx_ring_info.reclaim = 0;
+    scl_tx_ring_info.doorbell.status = SCL_SUCCESS;
+
+    ring_config.ring_id = SCL_IPC_RING_TX;
+    ring_config.ring = &scl_tx_ring_info.ring;
+    ring_config.retval = SCL_UNSUPPORTED;
+    retval = scl_send_command(SCL_TX_RING_CONFIG, &ring_config, sizeof(ring_config), SCL_COMMAND_NO_RESULT, 0,
+                              SCL_SEND_TIMEOUT_DEFAULT);
+    if ((retval == SCL_SUCCESS) && (ring_config.retval == SCL_SUCCESS)) {
+        scl_tx_ring_info.active = true;
+        return SCL_SUCCESS;
+    }
+    return SCL_UNSUPPORTED;
+}
+
+#if (SCL_TX_COMPLETE_ENABLE)
+/** Registers the TX completion ring with NP
+ *
+ *  @return  SCL_SUCCESS if NP reports completed buffers in the ring or error code
+ */
+static scl_result_t scl_tx_complete_init(void)
+{
+    scl_result_t retval = SCL_SUCCESS;
+    struct scl_ring_config ring_config;
+
+    if (!scl_tx_ring_info.active) {
+        return SCL_UNSUPPORTED;
+    }
+    retval = scl_ipc_ring_init(&scl_tx_ring_info.complete, scl_tx_ring_info.complete_desc,
+                               SCL_TX_COMPLETE_RING_SIZE);
+    if (retval != SCL_SUCCESS) {
+        return retval;
+    }
+    if (cy_rtos_get_mutex(&scl_tx_ring_info.mutex, SCL_MUTEX_TIMEOUT) != CY_RSLT_SUCCESS) {
+        return SCL_ERROR;
+    }
+    /* Frames queued before the switch are still reclaimed when their descriptor is consumed */
+    scl_tx_ring_reclaim();
+    while (scl_tx_ring_info.reclaim != scl_tx_ring_info.ring.head) {
+        cy_rtos_set_mutex(&scl_tx_ring_info.mutex);
+        cy_rtos_delay_milliseconds(DELAY_TIME_MS);
+        if (cy_rtos_get_mutex(&scl_tx_ring_info.mutex, SCL_MUTEX_TIMEOUT) != CY_RSLT_SUCCESS) {
+            return SCL_ERROR;
+        }
+        scl_tx_ring_reclaim();
+    }
+    ring_config.ring_id = SCL_IPC_RING_TX_COMPLETE;
+    ring_config.ring = &scl_tx_ring_info.complete;
+    ring_config.retval = SCL_UNSUPPORTED;
+    retval = scl_send_command(SCL_TX_RING_CONFIG, &ring_config, sizeof(ring_config), SCL_COMMAND_NO_RESULT, 0,
+                              SCL_SEND_TIMEOUT_DEFAULT);
+    if ((retval == SCL_SUCCESS) && (ring_config.retval == SCL_SUCCESS)) {
+        scl_tx_ring_info.inflight = 0;
+        scl_tx_ring_info.complete_active = true;
+    } else {
+        retval = SCL_UNSUPPORTED;
+    }
+    cy_rtos_set_mutex(&scl_tx_ring_info.mutex);
+    return retval;
+}
+
+/** Releases the completed TX buffers from the SCL thread unless a sender is doing it */
+static void scl_tx_complete_poll(void)
+{
+    if (scl_ipc_ring_count(&scl_tx_ring_info.complete) == 0) {
+        return;
+    }
+    if (cy_rtos_get_mutex(&scl_tx_ring_info.mutex, 0) == CY_RSLT_SUCCESS) {
+        scl_tx_ring_reclaim();
+        cy_rtos_set_mutex(&scl_tx_ring_info.mutex);
+    }
+}
+#endif
+
+/** Releases the buffers of the descriptors already consumed by NP,
+ *  or the buffers NP reported in the completion ring if it is active.
+ *  Called with the TX ring mutex held.
+ */
+static void scl_tx_ring_reclaim(void)
+{
+    scl_ipc_ring_t *ring = &scl_tx_ring_info.ring;
+    uint32_t tail = ring->tail;
+    scl_ipc_desc_t *desc;
+    scl_buffer_t buffer;
+
+#if (SCL_TX_COMPLETE_ENABLE)
+    scl_ipc_desc_t complete;
+
+    if (scl_tx_ring_info.complete_active) {
+        /* Release in one batch every buffer NP has reported */
+        while (scl_ipc_ring_get(&scl_tx_ring_info.complete, &complete) == SCL_SUCCESS) {
+            scl_buffer_release(complete.buffer, SCL_NETWORK_TX);
+            scl_tx_ring_info.inflight--;
+        }
+        return;
+    }
+#endif
+    while (scl_tx_ring_info.reclaim != tail) {
+        desc = SCL_IPC_RING_DESC(ring, scl_tx_ring_info.reclaim);
+        buffer = desc->buffer;
+#if (SCL_TX_SG_ENABLE)
+        if (desc->index == SCL_TX_SEND_OUT_SG) {
+            buffer = ((struct scl_tx_sg *) desc->buffer)->buffer;
+        }
+#endif
+        scl_buffer_release(buffer, SCL_NETWORK_TX);
+        scl_tx_ring_info.reclaim++;
+    }
+}
+
+/** Returns true if a frame can be queued in the TX ring
+ *  Called with the TX ring mutex held.
+ */
+static bool scl_tx_ring_has_room(void)
+{
+    scl_ipc_ring_t *ring = &scl_tx_ring_info.ring;
+
+#if (SCL_TX_COMPLETE_ENABLE)
+    if (scl_tx_ring_info.complete_active) {
+        /* Buffers are tracked by the completion ring, only the in-flight budget limits senders */
+        return (scl_ipc_ring_count(ring) < ring->size) && (scl_tx_ring_info.inflight < SCL_TX_INFLIGHT_MAX);
+    }
+#endif
+    /* A slot is reusable only after its previous buffer was released */
+    return ((ring->head - scl_tx_ring_info.reclaim) < ring->size);
+}
+
+/** Asks NP to notify the SCL thread once it frees what the sender is waiting for
+ *  Called with the TX ring mutex held, after scl_tx_ring_has_room() failed.
+ *
+ *  @return  true if nothing was freed in the meantime and the sender can sleep
+ */
+static bool scl_tx_ring_arm_room(void)
+{
+    scl_ipc_ring_t *ring = &scl_tx_ring_info.ring;
+
+#if (SCL_TX_COMPLETE_ENABLE)
+    if (scl_tx_ring_info.complete_active && (scl_ipc_ring_count(ring) < ring->size)) {
+        /* Only the in-flight budget is exhausted, room comes back with the completions */
+        return scl_ipc_ring_arm_doorbell(&scl_tx_ring_info.complete) ? true : false;
+    }
+#endif
+    return scl_ipc_ring_arm_room(ring) ? true : false;
+}
+
+/** Stops the notifications asked by scl_tx_ring_arm_room()
+ *  Called with the TX ring mutex held, once no sender waits.
+ */
+static void scl_tx_ring_disarm_room(void)
+{
+#if (SCL_TX_COMPLETE_ENABLE)
+    if (scl_tx_ring_info.complete_active) {
+        scl_ipc_ring_disarm_doorbell(&scl_tx_ring_info.complete);
+    }
+#endif
+    scl_ipc_ring_disarm_room(&scl_tx_ring_info.ring);
+}
+
+/** Releases the completed TX buffers and wakes a sender waiting for room
+ *  Called from the SCL thread.
+ */
+static void scl_tx_ring_poll(void)
+{
+#if (SCL_TX_COMPLETE_ENABLE)
+    if (scl_tx_ring_info.complete_active) {
+        scl_tx_complete_poll();
+    }
+#endif
+    /* The woken sender reclaims and passes the wakeup on if room is left */
+    if (scl_tx_ring_info.waiters != 0) {
+        cy_rtos_set_semaphore(&scl_tx_ring_info.room, SCL_FALSE);
+    }
+}
+
+/** Rings the TX ring doorbell for the waiting frames unless NP polls the ring again
+ *  Called with the TX ring mutex held.
+ *
+ *  @param   reason     Counter of the cause of the doorbell, incremented if it is rung.
+ */
+static void scl_tx_doorbell_ring(uint32_t *reason)
+{
+    struct scl_tx_doorbell_info_t *doorbell = &scl_tx_doorbell;
+
+    if (doorbell->waiting == 0) {
+        return;
+    }
+    if (!scl_ipc_ring_doorbell_needed(&scl_tx_ring_info.ring)) {
+        doorbell->stats.polled_frames += doorbell->waiting;
+        doorbell->waiting = 0;
+        return;
+    }
+    if (scl_tx_ring_info.doorbell.status == SCL_PENDING) {
+        /* NP may have read the pending doorbell and stopped polling before releasing it,
+         * so its completion rings again unless it completed meanwhile
+         */
+        scl_ipc_atomic_store(&doorbell->deferred, 1);
+        if ((scl_tx_ring_info.doorbell.status == SCL_PENDING) || !scl_ipc_atomic_cas(&doorbell->deferred, 1, 0)) {
+            doorbell->waiting = 0;
+            return;
+        }
+    }
+    if (scl_send_data_async(SCL_TX_RING_DOORBELL, (char *) &scl_tx_ring_info.ring, &scl_tx_ring_info.doorbell,
+                            scl_tx_doorbell_complete, NULL) != SCL_SUCCESS) {
+        /* The channel is unavailable */
+        SCL_LOG(("TX ring doorbell deferred\r\n"));
+#if (SCL_TX_DOORBELL_COALESCE_ENABLE)
+        /* Try again after a window */
+        scl_tx_doorbell_arm();
+#else
+        /* Without a window to retry in, the frames wait for the next doorbell */
+        doorbell->waiting = 0;
+#endif
+        return;
+    }
+    doorbell->stats.doorbells++;
+    doorbell->stats.frames += doorbell->waiting;
+    if (doorbell->waiting > doorbell->stats.max_frames_per_doorbell) {
+        doorbell->stats.max_frames_per_doorbell = doorbell->waiting;
+    }
+    (*reason)++;
+    doorbell->waiting = 0;
+}
+
+/** Completion of the TX ring doorbell, rings it again for the frames deferred meanwhile
+ *  Called from the IPC release interrupt or from the sender that found the channel idle.
+ */
+static void scl_tx_doorbell_complete(scl_ipc_request_t *request, scl_result_t result, void *user_data)
+{
+    UNUSED_PARAMETER(result);
+    UNUSED_PARAMETER(user_data);
+    if (scl_ipc_atomic_cas(&scl_tx_doorbell.deferred, 1, 0)) {
+        /* Like a doorbell the channel refuses, a failed one leaves the frames to the next doorbell */
+        (void) scl_send_data_async(SCL_TX_RING_DOORBELL, (char *) &scl_tx_ring_info.ring, request,
+                                   scl_tx_doorbell_complete, NULL);
+    }
+}
+
+/** Rings the doorbell for a frame just queued in the TX ring, or lets it wait for more frames
+ *  Called with the TX ring mutex held.
+ *
+ *  @param   priority   802.1D user priority of the frame.
+ */
+static void scl_tx_doorbell_queued(uint8_t priority)
+{
+    struct scl_tx_doorbell_info_t *doorbell = &scl_tx_doorbell;
+
+    /* NP is still polling the ring and finds the frame by itself */
+    if ((doorbell->waiting == 0) && !scl_ipc_ring_doorbell_needed(&scl_tx_ring_info.ring)) {
+        doorbell->stats.polled_frames++;
+        return;
+    }
+    doorbell->waiting++;
+#if (SCL_TX_DOORBELL_COALESCE_ENABLE)
+    if (priority >= SCL_TX_DOORBELL_URGENT_PRIORITY) {
+        scl_tx_doorbell_ring(&doorbell->stats.urgent_doorbells);
+    } else if ((doorbell->waiting >= doorbell->config.batch) || (doorbell->config.window_ms == 0)) {
+        scl_tx_doorbell_ring(&doorbell->stats.batch_doorbells);
+    } else if (doorbell->waiting == 1) {
+        scl_tx_doorbell_arm();
+    }
+#else
+    UNUSED_PARAMETER(priority);
+    scl_tx_doorbell_ring(&doorbell->stats.batch_doorbells);
+#endif
+}
+
+#if (SCL_TX_DOORBELL_COALESCE_ENABLE)
+/** Starts the window after which the waiting frames are notified */
+static void scl_tx_doorbell_arm(void)
+{
+    uint32_t window_ms = scl_tx_doorbell.config.window_ms;
+
+    cy_rtos_start_timer(&scl_tx_doorbell.timer, (window_ms != 0) ? window_ms : DELAY_TIME_MS);
+}
+
+/** Rings the doorbell once the window of the oldest waiting frame has elapsed
+ *  Called from the timer thread, which must not block on the TX ring mutex.
+ */
+static void scl_tx_doorbell_timeout(cy_timer_callback_arg_t arg)
+{
+    UNUSED_PARAMETER(arg);
+    if (cy_rtos_get_mutex(&scl_tx_ring_info.mutex, 0) != CY_RSLT_SUCCESS) {
+        /* A sender owns the ring, look again after another window */
+        scl_tx_doorbell_arm();
+        return;
+    }
+    scl_tx_doorbell_ring(&scl_tx_doorbell.stats.window_doorbells);
+    cy_rtos_set_mutex(&scl_tx_ring_info.mutex);
+}
+#endif
+
+/** Queues a frame in the TX ring and rings the doorbell if NP is idle
+ *
+ *  A sender that finds the ring full releases the mutex and sleeps until the
+ *  SCL thread reports that NP has freed descriptors, or until the timeout.
+ *
+ *  @param   index      SCL_TX_SEND_OUT or SCL_TX_SEND_OUT_AGG.
+ *  @param   tx_buf     Frame to be sent, the caller keeps its reference and the ring takes its own.
+ *  @param   timeout    Time (in ms) to wait for a free descriptor.
+ *
+ *  @return  SCL_SUCCESS if the frame was queued or error code
+ */
+static scl_result_t scl_tx_ring_send(int index, scl_tx_buf_t *tx_buf, uint32_t timeout)
+{
+    scl_ipc_ring_t *ring = &scl_tx_ring_info.ring;
+    scl_ipc_desc_t desc;
+    scl_buffer_t frame = tx_buf->buffer;
+    uint32_t remaining;
+    cy_time_t start;
+    scl_result_t retval = SCL_BUFFER_UNAVAILABLE_TEMPORARY;
+#if (SCL_TX_SG_ENABLE)
+    struct scl_tx_sg sg;
+    bool chained = false;
+    scl_buffer_t flat = NULL;
+#endif
+
+    desc.index = (uint32_t) index;
+    desc.length = tx_buf->size;
+    desc.buffer = tx_buf->buffer;
+#if (SCL_TX_SG_ENABLE)
+    if (scl_buffer_get_next_piece(tx_buf->buffer) != NULL) {
+        if (scl_tx_sg_build(tx_buf, &sg) == SCL_SUCCESS) {
+            chained = true;
+        } else {
+            retval = scl_buffer_flatten(tx_buf->buffer, &flat);
+            if (retval != SCL_SUCCESS) {
+                return retval;
+            }
+            retval = SCL_BUFFER_UNAVAILABLE_TEMPORARY;
+            desc.buffer = flat;
+            frame = flat;
+        }
+    }
+#endif
+
+    cy_rtos_get_time(&start);
+    if (cy_rtos_get_mutex(&scl_tx_ring_info.mutex, SCL_TX_LOCK_TIMEOUT(timeout)) != CY_RSLT_SUCCESS) {
+        SCL_LOG(("Failed to acquire mutex for TX ring\r\n"));
+        scl_stats_count(SCL_STATS_LOCK_FAILURES);
+#if (SCL_TX_SG_ENABLE)
+        if (flat != NULL) {
+            scl_buffer_release(flat, SCL_NETWORK_TX);
+        }
+#endif
+        return SCL_ERROR;
+    }
+    while (SCL_TRUE) {
+        scl_tx_ring_reclaim();
+        if (scl_tx_ring_has_room()) {
+#if (SCL_TX_SG_ENABLE)
+            if (chained) {
+                /* The list lives next to the descriptor until NP has consumed it */
+                desc.index = SCL_TX_SEND_OUT_SG;
+                desc.buffer = &scl_tx_ring_info.sg[ring->head & (ring->size - 1)];
+                *(struct scl_tx_sg *) desc.buffer = sg;
+            }
+#endif
+            retval = scl_ipc_ring_put(ring, &desc);
+            if (retval != SCL_SUCCESS) {
+                break;
+            }
+            /* The ring keeps its own reference until the reclaim, which the mutex holds off */
+            scl_buffer_ref(frame);
+#if (SCL_TX_COMPLETE_ENABLE)
+            scl_tx_ring_info.inflight++;
+#endif
+            break;
+        }
+        remaining = scl_remaining_time(start, timeout);
+        if (remaining == 0) {
+            SCL_LOG(("TX ring full\r\n"));
+            break;
+        }
+        if (!scl_tx_ring_arm_room()) {
+            /* NP freed descriptors while the notification was being armed */
+            continue;
+        }
+        scl_tx_ring_info.waiters++;
+        cy_rtos_set_mutex(&scl_tx_ring_info.mutex);
+        cy_rtos_get_semaphore(&scl_tx_ring_info.room, remaining, SCL_FALSE);
+        /* Holders of the mutex never wait, so it is taken back without a timeout */
+        cy_rtos_get_mutex(&scl_tx_ring_info.mutex, CY_RTOS_NEVER_TIMEOUT);
+        if (--scl_tx_ring_info.waiters == 0) {
+            scl_tx_ring_disarm_room();
+        }
+    }
+
+    if (retval == SCL_SUCCESS) {
+        scl_tx_doorbell_queued(tx_buf->priority);
+    }
+    if ((scl_tx_ring_info.waiters != 0) && scl_tx_ring_has_room()) {
+        /* Room is left for the next waiting sender */
+        cy_rtos_set_semaphore(&scl_tx_ring_info.room, SCL_FALSE);
+    }
+    cy_rtos_set_mutex(&scl_tx_ring_info.mutex);
+#if (SCL_TX_SG_ENABLE)
+    if (flat != NULL) {
+        /* The ring has its own reference on the copy if it was queued */
+        scl_buffer_release(flat, SCL_NETWORK_TX);
+    }
+#endif
+    return retval;
+}
+#endif
+
+scl_bool_t scl_tx_ring_is_active(void)
+{
+#if (SCL_TX_RING_ENABLE)
+    return scl_tx_ring_info.active ? SCL_TRUE : SCL_FALSE;
+#else
+    return SCL_FALSE;
+#endif
+}
+
+scl_result_t scl_tx_set_doorbell_coalescing(const scl_tx_doorbell_config_t *config)
+{
+#if (SCL_TX_DOORBELL_COALESCE_ENABLE)
+    CHECK_BUFFER_NULL(config);
+    if (config->batch == 0) {
+        return SCL_BADARG;
+    }
+    /* Frames already waiting are notified by the timer started for them */
+    scl_tx_doorbell.config = *config;
+    return SCL_SUCCESS;
+#else
+    UNUSED_PARAMETER(config);
+    return SCL_UNSUPPORTED;
+#endif
+}
+
+scl_result_t scl_tx_flush(void)
+{
+#if (SCL_AGG_ENABLE)
+    /* The aggregate goes first, its frames are then notified with the others */
+    if (scl_agg_info.current != NULL) {
+        if (cy_rtos_get_mutex(&scl_agg_info.mutex, SCL_MUTEX_TIMEOUT) != CY_RSLT_SUCCESS) {
+            return SCL_ERROR;
+        }
+        scl_agg_flush(scl_send_timeout(SCL_TX_SEND_OUT, SCL_SEND_TIMEOUT_DEFAULT));
+        cy_rtos_set_mutex(&scl_agg_info.mutex);
+    }
+#endif
+#if (SCL_TX_RING_ENABLE)
+    if (!scl_tx_ring_info.active || (scl_tx_doorbell.waiting == 0)) {
+        return SCL_SUCCESS;
+    }
+    if (cy_rtos_get_mutex(&scl_tx_ring_info.mutex, SCL_MUTEX_TIMEOUT) != CY_RSLT_SUCCESS) {
+        return SCL_ERROR;
+    }
+    scl_tx_doorbell_ring(&scl_tx_doorbell.stats.flush_doorbells);
+    cy_rtos_set_mutex(&scl_tx_ring_info.mutex);
+#endif
+    return SCL_SUCCESS;
+}
+
+scl_result_t scl_get_tx_doorbell_stats(scl_tx_doorbell_stats_t *stats)
+{
+#if (SCL_TX_RING_ENABLE)
+    CHECK_BUFFER_NULL(stats);
+    *stats = scl_tx_doorbell.stats;
+    return SCL_SUCCESS;
+#else
+    UNUSED_PARAMETER(stats);
+    return SCL_UNSUPPORTED;
+#endif
+}
+
+#if (SCL_AGG_ENABLE)
+/** Enables small-frame aggregation if NP supports it
+ *
+ *  @return  SCL_SUCCESS if NP accepts SCL_TX_SEND_OUT_AGG or error code
+ */
+static scl_result_t scl_agg_init(void)
+{
+    scl_result_t retval = SCL_SUCCESS;
+    struct scl_agg_config agg_config;
+    uint32_t slot;
+
+    if (cy_rtos_init_mutex(&scl_agg_info.mutex) != CY_RSLT_SUCCESS) {
+        return SCL_ERROR;
+    }
+    if (cy_rtos_init_timer(&scl_agg_info.timer, CY_TIMER_TYPE_ONCE, scl_agg_timeout,
+                           (cy_timer_callback_arg_t) 0) != CY_RSLT_SUCCESS) {
+        return SCL_ERROR;
+    }
+    for (slot = 0; slot < SCL_AGG_BUFFERS; slot++) {
+        scl_agg_info.agg[slot].request.status = SCL_SUCCESS;
+    }
+
+    agg_config.threshold = SCL_AGG_THRESHOLD;
+    agg_config.buffer_size = SCL_AGG_BUFFER_SIZE;
+    agg_config.max_frames = SCL_AGG_MAX_FRAMES;
+    agg_config.retval = SCL_UNSUPPORTED;
+    retval = scl_send_command(SCL_TX_AGG_CONFIG, &agg_config, sizeof(agg_config), SCL_COMMAND_NO_RESULT, 0,
+                              SCL_SEND_TIMEOUT_DEFAULT);
+    if ((retval == SCL_SUCCESS) && (agg_config.retval == SCL_SUCCESS)) {
+        scl_agg_info.active = true;
+        return SCL_SUCCESS;
+    }
+    return SCL_UNSUPPORTED;
+}
+
+/** Starts the window after which the current aggregate is sent */
+static void scl_agg_arm(void)
+{
+    cy_rtos_start_timer(&scl_agg_info.timer, (SCL_AGG_WINDOW_MS != 0) ? SCL_AGG_WINDOW_MS : DELAY_TIME_MS);
+}
+
+/** Releases the aggregates NP has read
+ *  Called with the aggregation mutex held.
+ */
+static void scl_agg_reclaim(void)
+{
+    struct scl_agg *agg;
+    uint32_t slot;
+
+    for (slot = 0; slot < SCL_AGG_BUFFERS; slot++) {
+        agg = &scl_agg_info.agg[slot];
+        if ((agg->tx_buf.buffer == NULL) || (agg == scl_agg_info.current) || (agg->request.status == SCL_PENDING)) {
+            continue;
+        }
+        if (agg->request.status != SCL_SUCCESS) {
+            scl_agg_info.stats.tx_dropped += agg->frames;
+        }
+        scl_buffer_release(agg->tx_buf.buffer, SCL_NETWORK_TX);
+        agg->tx_buf.buffer = NULL;
+    }
+}
+
+/** Hands the current aggregate to NP, through the TX ring if it is active
+ *  Called with the aggregation mutex held.
+ *
+ *  @param   timeout    Time (in ms) to wait for a free TX ring descriptor.
+ *
+ *  @return  SCL_SUCCESS or error code, the aggregate stays current on error
+ */
+static scl_result_t scl_agg_post(uint32_t timeout)
+{
+    struct scl_agg *agg = scl_agg_info.current;
+    scl_agg_stats_t *stats = &scl_agg_info.stats;
+    scl_result_t retval = SCL_SUCCESS;
+
+    scl_buffer_set_size(agg->tx_buf.buffer, (uint16_t) agg->tx_buf.size);
+#if (SCL_TX_RING_ENABLE)
+    if (scl_tx_ring_info.active) {
+        retval = scl_tx_ring_send(SCL_TX_SEND_OUT_AGG, &agg->tx_buf, timeout);
+        if (retval == SCL_SUCCESS) {
+            /* The ring keeps its own reference until NP consumes the aggregate */
+            scl_buffer_release(agg->tx_buf.buffer, SCL_NETWORK_TX);
+            agg->tx_buf.buffer = NULL;
+        }
+    }
+#endif
+    if (!scl_tx_ring_is_active()) {
+        UNUSED_PARAMETER(timeout);
+        /* The buffer is released by scl_agg_reclaim() once NP has read it */
+        retval = scl_send_data_async(SCL_TX_SEND_OUT_AGG, (char *) &agg->tx_buf, &agg->request, NULL, NULL);
+    }
+    if (retval != SCL_SUCCESS) {
+        return retval;
+    }
+    stats->tx_aggregates++;
+    stats->tx_frames += agg->frames;
+    if (agg->frames > stats->max_frames_per_aggregate) {
+        stats->max_frames_per_aggregate = agg->frames;
+    }
+    scl_agg_info.current = NULL;
+    return SCL_SUCCESS;
+}
+
+/** Sends the current aggregate, or drops its frames if NP cannot take it
+ *  Called with the aggregation mutex held.
+ */
+static void scl_agg_flush(uint32_t timeout)
+{
+    struct scl_agg *agg = scl_agg_info.current;
+
+    if ((agg == NULL) || (scl_agg_post(timeout) == SCL_SUCCESS)) {
+        return;
+    }
+    SCL_LOG(("Aggregate of %u frames dropped\r\n", (unsigned int) agg->frames));
+    scl_agg_info.stats.tx_dropped += agg->frames;
+    scl_buffer_release(agg->tx_buf.buffer, SCL_NETWORK_TX);
+    agg->tx_buf.buffer = NULL;
+    scl_agg_info.current = NULL;
+}
+
+/** Copies a small frame into the current aggregate, which is sent once full or after its window
+ *
+ *  @param   tx_buf     Frame to be sent.
+ *  @param   timeout    Time (in ms) to wait for a free TX ring descriptor when an aggregate is sent.
+ *
+ *  @return  SCL_SUCCESS once the frame is copied, SCL_UNSUPPORTED if it has to be sent alone or error code
+ */
+static scl_result_t scl_agg_send(scl_tx_buf_t *tx_buf, uint32_t timeout)
+{
+    struct scl_agg_info_t *info = &scl_agg_info;
+    struct scl_agg *agg;
+    scl_buffer_t buffer;
+    scl_buffer_t piece;
+    uint8_t *data;
+    uint32_t length = tx_buf->size;
+    uint32_t copied;
+    uint32_t piece_size;
+    uint32_t slot;
+
+    if (cy_rtos_get_mutex(&info->mutex, SCL_TX_LOCK_TIMEOUT(timeout)) != CY_RSLT_SUCCESS) {
+        SCL_LOG(("Failed to acquire mutex for aggregation\r\n"));
+        scl_stats_count(SCL_STATS_LOCK_FAILURES);
+        return SCL_ERROR;
+    }
+    agg = info->current;
+    if ((length > SCL_AGG_THRESHOLD) ||
+        ((agg != NULL) && ((agg->tx_buf.size + SCL_AGG_RECORD_SIZE(length)) > SCL_AGG_BUFFER_SIZE))) {
+        /* The frames already aggregated go first */
+        scl_agg_flush(timeout);
+        agg = NULL;
+    }
+    if (length > SCL_AGG_THRESHOLD) {
+        cy_rtos_set_mutex(&info->mutex);
+        return SCL_UNSUPPORTED;
+    }
+    scl_agg_reclaim();
+    if (agg == NULL) {
+        for (slot = 0; slot < SCL_AGG_BUFFERS; slot++) {
+            if (info->agg[slot].tx_buf.buffer == NULL) {
+                agg = &info->agg[slot];
+                break;
+            }
+        }
+        if ((agg == NULL) ||
+            (scl_host_buffer_get(&buffer, SCL_NETWORK_TX, SCL_AGG_BUFFER_SIZE, SCL_FALSE) != SCL_SUCCESS)) {
+            /* Every aggregate still waits for NP, the frame goes alone behind them */
+            info->stats.tx_unaggregated++;
+            cy_rtos_set_mutex(&info->mutex);
+            return SCL_UNSUPPORTED;
+        }
+        agg->tx_buf.buffer = buffer;
+        agg->tx_buf.size = 0;
+        agg->tx_buf.priority = 0;
+        agg->frames = 0;
+        info->current = agg;
+        scl_agg_arm();
+    }
+
+    /* Record: length of the frame, then the frame padded to 4 bytes */
+    data = scl_buffer_get_current_piece_data_pointer(agg->tx_buf.buffer) + agg->tx_buf.size;
+    memcpy(data, &length, sizeof(length));
+    data += sizeof(length);
+    for (piece = tx_buf->buffer, copied = 0; (piece != NULL) && (copied < length);
+         piece = scl_buffer_get_next_piece(piece)) {
+        piece_size = scl_buffer_get_current_piece_size(piece);
+        if (piece_size > (length - copied)) {
+            piece_size = length - copied;
+        }
+        memcpy(data + copied, scl_buffer_get_current_piece_data_pointer(piece), piece_size);
+        copied += piece_size;
+    }
+    agg->tx_buf.size += SCL_AGG_RECORD_SIZE(length);
+    agg->frames++;
+    if (tx_buf->priority > agg->tx_buf.priority) {
+        agg->tx_buf.priority = tx_buf->priority;
+    }
+    if (agg->frames >= SCL_AGG_MAX_FRAMES) {
+        scl_agg_flush(timeout);
+    }
+    cy_rtos_set_mutex(&info->mutex);
+    return SCL_SUCCESS;
+}
+
+/** Sends the current aggregate once the window of its oldest frame has elapsed
+ *  Called from the timer thread, which must not block on the aggregation mutex.
+ */
+static void scl_agg_timeout(cy_timer_callback_arg_t arg)
+{
+    UNUSED_PARAMETER(arg);
+    if (cy_rtos_get_mutex(&scl_agg_info.mutex, 0) != CY_RSLT_SUCCESS) {
+        /* A sender owns the aggregate, look again after another window */
+        scl_agg_arm();
+        return;
+    }
+    if ((scl_agg_info.current != NULL) && (scl_agg_post(INTIAL_VALUE) != SCL_SUCCESS)) {
+        /* The TX ring is full, the frames stay aggregated until the next window */
+        scl_agg_arm();
+    }
+    cy_rtos_set_mutex(&scl_agg_info.mutex);
+}
+
+/** Splits an aggregate received from NP and delivers its frames to the network stack
+ *
+ *  @param   aggregate  Buffer of the aggregate, released here.
+ *  @param   length     Length of the records in the buffer.
+ */
+static void scl_agg_receive(scl_buffer_t aggregate, uint32_t length)
+{
+    uint8_t *data = scl_buffer_get_current_piece_data_pointer(aggregate);
+    uint32_t offset = 0;
+    uint32_t frame_length;
+    scl_buffer_t frame;
+
+    scl_agg_info.stats.rx_aggregates++;
+    while ((offset + sizeof(frame_length)) <= length) {
+        memcpy(&frame_length, data + offset, sizeof(frame_length));
+        offset += sizeof(frame_length);
+        /* The padding of the last record may be missing */
+        if ((frame_length == 0) || (frame_length > SCL_LINK_MTU) || (frame_length > (length - offset))) {
+            SCL_LOG(("incorrect aggregate from Network Processor\r\n"));
+            scl_stats_count(SCL_STATS_RX_ERRORS);
+            break;
+        }
+        if (scl_host_buffer_get(&frame, SCL_NETWORK_RX, (uint16_t) frame_length, SCL_FALSE) != SCL_SUCCESS) {
+            scl_stats_count(SCL_STATS_RX_DROPPED);
+        } else {
+            memcpy(scl_buffer_get_current_piece_data_pointer(frame), data + offset, frame_length);
+            scl_agg_info.stats.rx_frames++;
+            scl_stats_count_rx(frame_length);
+            scl_rx_input(frame);
+        }
+        offset += SCL_AGG_RECORD_SIZE(frame_length) - sizeof(frame_length);
+    }
+    scl_buffer_release(aggregate, SCL_NETWORK_RX);
+}
+#endif
+
+scl_result_t scl_get_agg_stats(scl_agg_stats_t *stats)
+{
+#if (SCL_AGG_ENABLE)
+    CHECK_BUFFER_NULL(stats);
+    *stats = scl_agg_info.stats;
+    return SCL_SUCCESS;
+#else
+    UNUSED_PARAMETER(stats);
+    return SCL_UNSUPPORTED;
+#endif
+}
+
+scl_result_t scl_init(void)
+{
+    scl_result_t retval = SCL_SUCCESS;
+    uint32_t configuration_parameters = INTIAL_VALUE;
+
+#ifdef MBED_CONF_TARGET_NP_CLOUD_DISABLE
+    configuration_parameters = (MBED_CONF_TARGET_NP_CLOUD_DISABLE << 1);
+#else
+    configuration_parameters = (false << 1);
+#endif
+#ifdef MBED_CONF_TARGET_NP_WIFI_ENABLE
+    configuration_parameters |= MBED_CONF_TARGET_NP_WIFI_ENABLE;
+#else
+    configuration_parameters |= false;
+#endif
+    scl_latency_init();
+    scl_trace_init();
+    retval = scl_channel_init(&scl_control_channel);
+    if (retval != SCL_SUCCESS) {
+        return SCL_ERROR;
+    }
+    retval = scl_waiter_init();
+    if (retval != SCL_SUCCESS) {
+        return SCL_ERROR;
+    }
+
+    scl_config();
+
+    if (g_scl_thread_info.scl_inited != SCL_TRUE) {
+        retval = scl_check_version_compatibility();
+        if (retval != SCL_SUCCESS) {
+            printf("SCL handshake failed, please try again\n");
+            return retval;
+        }
+        retval = scl_buffer_init();
+        if (retval != SCL_SUCCESS) {
+            SCL_LOG(("Buffer init failed\r\n"));
+            return SCL_ERROR;
+        }
+        retval = scl_thread_init();
+        if (retval != SCL_SUCCESS) {
+            SCL_LOG(("Thread init failed\r\n"));
+            return SCL_ERROR;
+        } else {
+            retval = scl_send_command(SCL_TX_CONFIG_PARAMETERS, &configuration_parameters,
+                                      sizeof(configuration_parameters), SCL_COMMAND_NO_RESULT, 0,
+                                      SCL_SEND_TIMEOUT_DEFAULT);
+        }
+
+#if (SCL_DATA_CHANNEL_ENABLE)
+        if (scl_data_channel_init() != SCL_SUCCESS) {
+            SCL_LOG(("Data channel not supported by NP, sharing the control channel\r\n"));
+        }
+#endif
+#if (SCL_TAGGED_CONTROL_ENABLE)
+        if (scl_tag_init() != SCL_SUCCESS) {
+            SCL_LOG(("Tagged control requests not supported by NP\r\n"));
+        }
+#endif
+#if (SCL_TX_SG_ENABLE)
+        if (scl_tx_sg_init() != SCL_SUCCESS) {
+            SCL_LOG(("Scatter-gather not supported by NP, flattening TX chains\r\n"));
+        }
+#endif
+#if (SCL_RX_RING_ENABLE)
+        if (scl_rx_ring_init() != SCL_SUCCESS) {
+            SCL_LOG(("RX ring not supported by NP, using IPC handshake\r\n"));
+        }
+#endif
+#if (SCL_RX_POST_ENABLE)
+        if (scl_rx_post_init() != SCL_SUCCESS) {
+            SCL_LOG(("RX buffer post ring not supported by NP, using SCL_RX_GET_BUFFER\r\n"));
+        }
+#endif
+#if (SCL_TX_RING_ENABLE)
+        if (scl_tx_ring_init() != SCL_SUCCESS) {
+            SCL_LOG(("TX ring not supported by NP, using IPC handshake\r\n"));
+        }
+#endif
+#if (SCL_TX_CREDIT_ENABLE)
+        if (scl_tx_credit_init() != SCL_SUCCESS) {
+            SCL_LOG(("TX credits not supported by NP, no flow control\r\n"));
+        }
+#endif
+#if (SCL_TX_COMPLETE_ENABLE)
+        if (scl_tx_complete_init() != SCL_SUCCESS) {
+            SCL_LOG(("TX completion ring not supported by NP, releasing consumed descriptors\r\n"));
+        }
+#endif
+#if (SCL_AGG_ENABLE)
+        if (scl_agg_init() != SCL_SUCCESS) {
+            SCL_LOG(("Aggregation not supported by NP, sending small frames alone\r\n"));
+        }
+#endif
+#if (SCL_TX_WMM_ENABLE)
+        if (scl_tx_queue_init() != SCL_SUCCESS) {
+            SCL_LOG(("TX drain thread init failed\r\n"));
+            return SCL_ERROR;
+        }
+#endif
+        /* Register deep-sleep callback. */
+        retval = scl_ipc_hal_register_deepsleep(&scl_idle);
+        if (retval != SCL_SUCCESS) {
+            printf("Failed to register SCL PM callback\n");
+        }
+    }
+    return retval;
+}
+
+scl_result_t scl_send_data(int index, char *buffer, uint32_t timeout)
+{
+    scl_result_t result;
+
+    SCL_TRACE(SCL_TRACE_SEND, index, timeout);
+    result = scl_send_data_wait(index, buffer, NULL, timeout);
+    SCL_TRACE(SCL_TRACE_SEND_DONE, index, result);
+    if ((index == SCL_TX_SEND_OUT) && (buffer != NULL)) {
+        if (result == SCL_SUCCESS) {
+            scl_stats_count_tx(((scl_tx_buf_t *) buffer)->size);
+        } else {
+            scl_stats_count(SCL_STATS_TX_ERRORS);
+        }
+    }
+    return result;
+}
+
+scl_result_t scl_send_command(int index, void *command, uint32_t size, uint32_t result_offset,
+                              uint32_t result_size, uint32_t timeout)
+{
+    struct scl_command_layout layout;
+    scl_result_t result;
+
+    CHECK_BUFFER_NULL(command);
+    if ((size == 0) || (size > SCL_COMMAND_SIZE)) {
+        return SCL_BADARG;
+    }
+    if ((result_offset != SCL_COMMAND_NO_RESULT) &&
+        ((size < sizeof(void *)) || (result_offset > size - sizeof(void *)) ||
+         (result_size > sizeof(((struct scl_command_data *) NULL)->result)))) {
+        return SCL_BADARG;
+    }
+    layout.size = size;
+    layout.result_offset = result_offset;
+    layout.result_size = result_size;
+    SCL_TRACE(SCL_TRACE_SEND, index, timeout);
+    result = scl_send_data_wait(index, (char *) command, &layout, timeout);
+    SCL_TRACE(SCL_TRACE_SEND_DONE, index, result);
+    return result;
+}
+
+/** Sends the command and waits for the Network Processor, see scl_send_data()
+ *
+ *  @param   layout    Layout of a command copied to the storage of SCL, NULL to send buffer itself.
+ */
+static scl_result_t scl_send_data_wait(int index, char *buffer, const struct scl_command_layout *layout,
+                                       uint32_t timeout)
+{
+    scl_result_t result = SCL_SUCCESS;
+    uint32_t waiter;
+    cy_time_t start;
+    char *staged;
+
+    SCL_LOG(("scl_send_data index = %d\r\n", index));
+    CHECK_BUFFER_NULL(buffer);
+    timeout = scl_send_timeout(index, timeout);
+#if (SCL_AGG_ENABLE)
+    if ((index == SCL_TX_SEND_OUT) && scl_agg_info.active) {
+        result = scl_agg_send((scl_tx_buf_t *) buffer, timeout);
+        if (result != SCL_UNSUPPORTED) {
+            return result;
+        }
+    }
+#endif
+#if (SCL_TX_RING_ENABLE)
+    if ((index == SCL_TX_SEND_OUT) && scl_tx_ring_info.active) {
+        return scl_tx_ring_send(index, (scl_tx_buf_t *) buffer, timeout);
+    }
+#endif
+#if (SCL_TX_SG_ENABLE)
+    if ((index == SCL_TX_SEND_OUT) && (scl_buffer_get_next_piece(((scl_tx_buf_t *) buffer)->buffer) != NULL)) {
+        return scl_send_chain((scl_tx_buf_t *) buffer, timeout);
+    }
+#endif
+    if (scl_select_channel(index)->abandoned != 0) {
+        /* NP has not completed a request given up on earlier, do not wait behind it */
+        scl_count_timeout(index);
+        return SCL_TIMEOUT;
+    }
+#if (SCL_TAGGED_CONTROL_ENABLE)
+    if (scl_is_tagged_command(index)) {
+        return scl_send_tagged(index, buffer, layout, timeout);
+    }
+#endif
+    cy_rtos_get_time(&start);
+    /* Each blocked caller waits on its own semaphore, the channel itself is not locked */
+    if (scl_waiter_get(timeout, &waiter) != SCL_SUCCESS) {
+        scl_count_timeout(index);
+        return SCL_TIMEOUT;
+    }
+    /* Frames are copied as well, NP reads their descriptor until it releases the channel */
+    scl_waiter_info.wait[waiter] = SCL_WAIT_PENDING;
+    staged = scl_command_stage(&scl_waiter_info.data[waiter], (layout != NULL) ? layout : scl_frame_layout(index),
+                               buffer);
+    result = scl_send_data_async(index, staged, &scl_waiter_info.request[waiter], scl_send_data_complete,
+                                 (void *) (uintptr_t) waiter);
+    if (result != SCL_SUCCESS) {
+        scl_waiter_put(waiter);
+        return result;
+    }
+    /* Wait until the IPC Channel is released by NP */
+    if (cy_rtos_get_semaphore(&scl_waiter_info.done[waiter], scl_remaining_time(start, timeout),
+                              SCL_FALSE) != CY_RSLT_SUCCESS) {
+        result = scl_cancel_request(index, waiter);
+        if (result == SCL_TIMEOUT) {
+            SCL_LOG(("scl_send_data index = %d timed out\r\n", index));
+            scl_count_timeout(index);
+            /* The waiter is freed by the completion of the cancelled or abandoned request */
+            return result;
+        }
+    }
+    result = scl_waiter_info.request[waiter].status;
+    if (result == SCL_SUCCESS) {
+        scl_command_unstage(&scl_waiter_info.data[waiter], layout, buffer);
+    }
+    scl_waiter_put(waiter);
+    return result;
+}
+
+scl_result_t scl_send_data_async(int index, char *buffer, scl_ipc_request_t *request,
+                                 scl_send_callback_t callback, void *user_data)
+{
+    struct scl_tx_channel_t *tx_channel = NULL;
+    scl_result_t retval = SCL_SUCCESS;
+    uint32_t depth;
+
+    CHECK_BUFFER_NULL(buffer);
+    if (request == NULL) {
+        return SCL_BADARG;
+    }
+#if (SCL_TX_RING_ENABLE)
+    if ((index == SCL_TX_SEND_OUT) && scl_tx_ring_info.active && SCL_IN_ISR()) {
+        /* Frames are written to the TX ring under its mutex */
+        return SCL_UNSUPPORTED;
+    }
+#endif
+    request->next = NULL;
+    request->index = index;
+    request->buffer = buffer;
+    request->callback = callback;
+    request->user_data = user_data;
+    request->status = SCL_PENDING;
+    request->state = SCL_REQUEST_QUEUED;
+    request->submitted = SCL_LATENCY_NOW();
+#if (SCL_TX_RING_ENABLE)
+    if ((index == SCL_TX_SEND_OUT) && scl_tx_ring_info.active) {
+        /* The ring holds its own reference on the frame, so the request is done */
+        retval = scl_tx_ring_send(index, (scl_tx_buf_t *) buffer, INTIAL_VALUE);
+        if (retval == SCL_SUCCESS) {
+            scl_complete_request(request, SCL_SUCCESS);
+        }
+        return retval;
+    }
+#endif
+
+    /* Tagged control requests carry the tag above the command index */
+    tx_channel = scl_select_channel(index & SCL_IPC_INDEX_MASK);
+    scl_ipc_queue_push(&tx_channel->queue, request);
+    /* The depth is counted once the request is reachable by the drainer */
+    depth = scl_ipc_atomic_add(&tx_channel->depth, 1);
+    if (scl_ipc_atomic_cas(&tx_channel->busy, SCL_CHANNEL_IDLE, SCL_CHANNEL_BUSY)) {
+        /* This caller owns the IPC channel until the drain posts a request or finds none */
+        scl_channel_drain(tx_channel);
+    } else {
+        scl_ipc_atomic_add(&tx_channel->stats.queued, 1);
+        if ((int32_t) depth > (int32_t) tx_channel->stats.max_queue_depth) {
+            tx_channel->stats.max_queue_depth = depth;
+        }
+    }
+    return retval;
+}
+
+scl_bool_t scl_is_scl_thread(void)
+{
+    cy_thread_t thread;
+
+    if (!g_scl_thread_info.scl_inited || (cy_rtos_get_thread_handle(&thread) != CY_RSLT_SUCCESS)) {
+        return SCL_FALSE;
+    }
+    return (thread == g_scl_thread_info.scl_thread) ? SCL_TRUE : SCL_FALSE;
+}
+
+scl_result_t scl_end(void)
+{
+    scl_result_t retval = SCL_SUCCESS;
+    if (g_scl_thread_info.scl_inited == SCL_TRUE) {
+#if (SCL_TX_WMM_ENABLE)
+        scl_tx_queue_deinit();
+#endif
         retval = (scl_result_t) cy_rtos_terminate_thread(&g_scl_thread_info.scl_thread);
         if (retval == SCL_SUCCESS) {
             retval = (scl_result_t) cy_rtos_join_thread(&g_scl_thread_info.scl_thread);
@@ -434,6 +2776,183 @@ scl_result_t scl_end(void)
     return retval;
 }
 
+/** Delivers an event received from NP to the registered handlers and releases its buffer */
+static void scl_rx_event_callback(scl_buffer_t rx_cp_buffer)
+{
+    struct event_callback_data* event_callback_data_for_cp;
+    char dummy_handler_user_data;
+
+    event_callback_data_for_cp = (struct event_callback_data*) scl_buffer_get_current_piece_data_pointer(rx_cp_buffer);
+    scl_process_events_from_np(&event_callback_data_for_cp->event_header, event_callback_data_for_cp->event_data, (void*) &dummy_handler_user_data);
+    scl_buffer_release(rx_cp_buffer,SCL_NETWORK_RX);
+}
+
+#if (SCL_RX_RING_ENABLE)
+/** Handles one descriptor posted by NP in the RX ring */
+static void scl_rx_ring_dispatch(const scl_ipc_desc_t *desc)
+{
+    uint32_t start = SCL_LATENCY_NOW();
+
+    SCL_TRACE(SCL_TRACE_RX_DESC, desc->index, desc->length);
+    switch (desc->index) {
+        case SCL_RX_DATA: {
+            if (desc->buffer == NULL) {
+                scl_stats_count(SCL_STATS_RX_ERRORS);
+                break;
+            }
+#if (SCL_RX_POST_ENABLE)
+            /* Posted buffers have the full SCL_RX_POST_BUFFER_SIZE, NP reports the frame length */
+            if (scl_rx_post_info.active) {
+                scl_buffer_set_size(desc->buffer, (uint16_t) desc->length);
+            }
+#endif
+            scl_stats_count_rx(scl_buffer_get_current_piece_size(desc->buffer));
+            scl_rx_input(desc->buffer);
+            break;
+        }
+#if (SCL_AGG_ENABLE)
+        case SCL_RX_DATA_AGG: {
+            if (desc->buffer == NULL) {
+                scl_stats_count(SCL_STATS_RX_ERRORS);
+                break;
+            }
+            scl_agg_receive(desc->buffer, desc->length);
+            break;
+        }
+#endif
+        case SCL_RX_EVENT_CALLBACK: {
+            scl_rx_event_callback(desc->buffer);
+            break;
+        }
+        default: {
+            SCL_LOG(("incorrect RX descriptor from Network Processor\r\n"));
+            scl_stats_count(SCL_STATS_UNKNOWN_MESSAGES);
+            break;
+        }
+    }
+    scl_latency_record_rx(desc->index, SCL_LATENCY_RX_HANDLING, start, SCL_LATENCY_NOW());
+}
+
+/** Drains the RX ring, processing at most SCL_RX_BUDGET descriptors per pass
+ *
+ *  @return  Number of descriptors processed
+ */
+static uint32_t scl_rx_ring_drain(scl_ipc_ring_t *ring)
+{
+    scl_ipc_desc_t desc;
+    uint32_t frames = 0;
+    uint32_t pass;
+
+    do {
+        pass = 0;
+        while ((pass < SCL_RX_BUDGET) && (scl_ipc_ring_get(ring, &desc) == SCL_SUCCESS)) {
+            scl_rx_ring_dispatch(&desc);
+            pass++;
+        }
+        frames += pass;
+        if (pass == SCL_RX_BUDGET) {
+            scl_rx_stats.budget_exhausted++;
+            scl_rx_input_flush();
+            /* Let other threads of the same priority run before the next pass */
+            cy_rtos_delay_milliseconds(0);
+        }
+    } while (pass == SCL_RX_BUDGET);
+    return frames;
+}
+
+/** Switches between interrupt and polling mode based on the descriptors of the last wakeup */
+static void scl_rx_moderate(uint32_t frames)
+{
+    struct scl_rx_moderation_info_t *moderation = &scl_rx_moderation;
+
+    if (moderation->config.high_threshold == 0) {
+        moderation->polling = false;
+    } else if (!moderation->polling) {
+        if (frames >= moderation->config.high_threshold) {
+            moderation->polling = true;
+            moderation->idle_polls = 0;
+            scl_rx_stats.switches_to_polling++;
+        }
+    } else if (frames < moderation->config.low_threshold) {
+        if (++moderation->idle_polls >= moderation->config.idle_polls) {
+            moderation->polling = false;
+            scl_rx_stats.switches_to_interrupt++;
+        }
+    } else {
+        moderation->idle_polls = 0;
+    }
+}
+
+/** Processes the RX ring after a wakeup of the SCL thread
+ *
+ *  In interrupt mode the doorbell is armed again once the ring is empty, so NP
+ *  notifies the SCL thread only for the first descriptor of the next burst.
+ *  In polling mode the doorbell stays disarmed and the thread wakes up periodically.
+ *
+ *  @param   polled     SCL_TRUE if the wakeup was caused by the polling interval.
+ */
+static void scl_rx_ring_poll(scl_bool_t polled)
+{
+    scl_ipc_ring_t *ring = &scl_rx_ring_info.ring;
+    uint32_t frames;
+
+    scl_ipc_ring_disarm_doorbell(ring);
+    frames = scl_rx_ring_drain(ring);
+    scl_rx_moderate(frames);
+#if (SCL_RX_POST_ENABLE)
+    if (scl_rx_post_info.active) {
+        scl_rx_post_refill(false);
+    }
+#endif
+    if (!scl_rx_moderation.polling) {
+        /* Sleep only if no descriptor was posted while the doorbell was being armed */
+        while (!scl_ipc_ring_arm_doorbell(ring)) {
+            scl_ipc_ring_disarm_doorbell(ring);
+            frames += scl_rx_ring_drain(ring);
+        }
+    }
+
+    scl_rx_stats.wakeups++;
+    scl_rx_stats.frames += frames;
+    if (frames > scl_rx_stats.max_frames_per_wakeup) {
+        scl_rx_stats.max_frames_per_wakeup = frames;
+    }
+    if (polled) {
+        scl_rx_stats.polls++;
+        scl_rx_stats.poll_frames += frames;
+    } else {
+        scl_rx_stats.interrupts++;
+        scl_rx_stats.interrupt_frames += frames;
+    }
+}
+
+/** Returns the time (in ms) the SCL thread waits for an RX interrupt */
+static uint32_t scl_rx_wait_time(void)
+{
+    if (scl_rx_ring_info.active && scl_rx_moderation.polling) {
+        return scl_rx_moderation.config.poll_interval_ms;
+    }
+    return CY_RTOS_NEVER_TIMEOUT;
+}
+#endif
+
+scl_result_t scl_rx_set_moderation(const scl_rx_moderation_config_t *config)
+{
+    CHECK_BUFFER_NULL(config);
+    if ((config->high_threshold != 0) && ((config->poll_interval_ms == 0) || (config->idle_polls == 0))) {
+        return SCL_BADARG;
+    }
+    scl_rx_moderation.config = *config;
+    return SCL_SUCCESS;
+}
+
+scl_result_t scl_get_rx_stats(scl_rx_stats_t *stats)
+{
+    CHECK_BUFFER_NULL(stats);
+    *stats = scl_rx_stats;
+    return SCL_SUCCESS;
+}
+
 /** Thread to handle the received buffer */
 static void scl_rx_handler(void)
 {
@@ -443,40 +2962,76 @@ static void scl_rx_handler(void)
     scl_buffer_t cp_buffer;
     uint32_t rx_ipc_size;
     int *rx_cp_buffer;
-    struct event_callback_data* event_callback_data_for_cp;
-    char dummy_handler_user_data;
     scl_scan_status_t scan_status;
-    IPC_STRUCT_Type *scl_receive = NULL;
+    scl_bool_t polled = SCL_FALSE;
+    uint32_t start;
+#if (SCL_TAGGED_CONTROL_ENABLE)
+    uint32_t tag;
+#endif
     SCL_LOG(("Starting CP Rx thread\r\n"));
-    /* Get the addresses for Interrupt and IPC channel to be used for direct register access */
-    scl_receive = Cy_IPC_Drv_GetIpcBaseAddress(SCL_RX_CHANNEL);
 
     while (SCL_TRUE) {
+#if (SCL_RX_RING_ENABLE)
+        polled = SCL_FALSE;
+        if (cy_rtos_get_semaphore(&g_scl_thread_info.scl_rx_ready, scl_rx_wait_time(), SCL_FALSE) != CY_RSLT_SUCCESS) {
+            /* Polling interval elapsed, there is no message in the IPC registers */
+            polled = SCL_TRUE;
+        }
+#else
         cy_rtos_get_semaphore(&g_scl_thread_info.scl_rx_ready, CY_RTOS_NEVER_TIMEOUT, SCL_FALSE);
-        index = (uint32_t)REG_IPC_STRUCT_DATA0(scl_receive);
+#endif
+        index = polled ? SCL_RX_NO_MESSAGE : scl_ipc_hal_read_data0(SCL_RX_CHANNEL);
+        start = SCL_LATENCY_NOW();
+        if (!polled) {
+            SCL_TRACE(SCL_TRACE_RX_MESSAGE, index, 0);
+            scl_latency_record_rx(index, SCL_LATENCY_RX_WAKEUP, scl_rx_isr_time, start);
+        } else {
+            SCL_TRACE(SCL_TRACE_RX_POLL, 0, 0);
+        }
         switch (index) {
             case SCL_RX_DATA: {
-                rx_cp_buffer = (int *) REG_IPC_STRUCT_DATA1(scl_receive);
+                rx_cp_buffer = (int *) scl_ipc_hal_read_data1(SCL_RX_CHANNEL);
                 SCL_LOG(("rx_cp_buffer = %p \r\n", rx_cp_buffer));
-                REG_IPC_STRUCT_RELEASE(scl_receive) = SCL_RELEASE;
-                scl_network_process_ethernet_data(rx_cp_buffer);
+                scl_ipc_hal_release(SCL_RX_CHANNEL, SCL_RELEASE);
+                if (rx_cp_buffer == NULL) {
+                    scl_stats_count(SCL_STATS_RX_ERRORS);
+                    break;
+                }
+                scl_stats_count_rx(scl_buffer_get_current_piece_size(rx_cp_buffer));
+                scl_rx_input(rx_cp_buffer);
+                break;
+            }
+#if (SCL_AGG_ENABLE)
+            case SCL_RX_DATA_AGG: {
+                rx_cp_buffer = (int *) scl_ipc_hal_read_data1(SCL_RX_CHANNEL);
+                scl_ipc_hal_release(SCL_RX_CHANNEL, SCL_RELEASE);
+                if (rx_cp_buffer == NULL) {
+                    scl_stats_count(SCL_STATS_RX_ERRORS);
+                    break;
+                }
+                scl_agg_receive(rx_cp_buffer, scl_buffer_get_current_piece_size(rx_cp_buffer));
                 break;
             }
+#endif
             case SCL_RX_TEST_MSG: {
-                buffer = (char *) REG_IPC_STRUCT_DATA1(scl_receive);
+                buffer = (char *) scl_ipc_hal_read_data1(SCL_RX_CHANNEL);
                 SCL_LOG(("%s\r\n", (char *) buffer));
-                REG_IPC_STRUCT_RELEASE(scl_receive) = SCL_RELEASE;
+                scl_ipc_hal_release(SCL_RX_CHANNEL, SCL_RELEASE);
                 break;
             }
             case SCL_RX_GET_BUFFER: {
-                rx_ipc_size = (uint32_t) REG_IPC_STRUCT_DATA1(scl_receive);
-                scl_host_buffer_get(&cp_buffer, SCL_NETWORK_RX, rx_ipc_size, SCL_FALSE);
-                REG_IPC_STRUCT_DATA1(scl_receive) = (uint32_t)cp_buffer;
-                REG_IPC_STRUCT_RELEASE(scl_receive) = SCL_RELEASE;
+                rx_ipc_size = (uint32_t) scl_ipc_hal_read_data1(SCL_RX_CHANNEL);
+                if (scl_host_buffer_get(&cp_buffer, SCL_NETWORK_RX, rx_ipc_size, SCL_FALSE) != SCL_SUCCESS) {
+                    /* NP drops the frame when it gets no buffer */
+                    cp_buffer = NULL;
+                    scl_stats_count(SCL_STATS_RX_DROPPED);
+                }
+                scl_ipc_hal_write_data1(SCL_RX_CHANNEL, (uintptr_t) cp_buffer);
+                scl_ipc_hal_release(SCL_RX_CHANNEL, SCL_RELEASE);
                 break;
             }
             case SCL_RX_GET_CONNECTION_STATUS: {
-                connection_status = (scl_nsapi_connection_status_t) REG_IPC_STRUCT_DATA1(scl_receive);
+                connection_status = (scl_nsapi_connection_status_t) scl_ipc_hal_read_data1(SCL_RX_CHANNEL);
                 if (connection_status == SCL_NSAPI_STATUS_GLOBAL_UP) {
 #ifdef __MBED_CONFIG_DATA__
                     scl_emac_wifi_link_state_changed(true);
@@ -486,40 +3041,94 @@ static void scl_rx_handler(void)
                     scl_emac_wifi_link_state_changed(false);
 #endif
                 }
-                REG_IPC_STRUCT_RELEASE(scl_receive) = SCL_RELEASE;
+                scl_ipc_hal_release(SCL_RX_CHANNEL, SCL_RELEASE);
                 SCL_LOG(("connection status = %d\r\n", connection_status));
                 break;
             }
             case SCL_RX_SCAN_STATUS: {
-                scan_status = (scl_scan_status_t )REG_IPC_STRUCT_DATA1(scl_receive);
+                scan_status = (scl_scan_status_t )scl_ipc_hal_read_data1(SCL_RX_CHANNEL);
                 scl_wifi_scan_callback(scan_status);
-                REG_IPC_STRUCT_RELEASE(scl_receive) = SCL_RELEASE;
+                scl_ipc_hal_release(SCL_RX_CHANNEL, SCL_RELEASE);
                 break;
             }
             case SCL_RX_EVENT_CALLBACK: {
-                rx_cp_buffer = (int*) REG_IPC_STRUCT_DATA1(scl_receive);
-                event_callback_data_for_cp = (struct event_callback_data*) scl_buffer_get_current_piece_data_pointer(rx_cp_buffer);
-                scl_process_events_from_np(&event_callback_data_for_cp->event_header, event_callback_data_for_cp->event_data, (void*) &dummy_handler_user_data);
-                scl_buffer_release(rx_cp_buffer,SCL_NETWORK_RX);
-                REG_IPC_STRUCT_RELEASE(scl_receive) = SCL_RELEASE;
+                rx_cp_buffer = (int*) scl_ipc_hal_read_data1(SCL_RX_CHANNEL);
+                scl_rx_event_callback(rx_cp_buffer);
+                scl_ipc_hal_release(SCL_RX_CHANNEL, SCL_RELEASE);
+                break;
+            }
+#if (SCL_TAGGED_CONTROL_ENABLE)
+            case SCL_RX_CONTROL_COMPLETE: {
+                tag = (uint32_t) scl_ipc_hal_read_data1(SCL_RX_CHANNEL);
+                scl_ipc_hal_release(SCL_RX_CHANNEL, SCL_RELEASE);
+                scl_tag_complete(tag & SCL_IPC_TAG_MASK);
+                break;
+            }
+#endif
+#if (SCL_RX_RING_ENABLE) || (SCL_TX_RING_ENABLE)
+            case SCL_RX_RING_DOORBELL: {
+                /* The rings are polled below, after the channel is released */
+                scl_ipc_hal_release(SCL_RX_CHANNEL, SCL_RELEASE);
+                break;
+            }
+#endif
+#if (SCL_TX_CREDIT_ENABLE)
+            case SCL_RX_CREDIT_UPDATE: {
+                /* The resume callback is called below, after the channel is released */
+                scl_ipc_hal_release(SCL_RX_CHANNEL, SCL_RELEASE);
+                break;
+            }
+#endif
+#if (SCL_RX_POST_ENABLE)
+            case SCL_RX_POST_LOW: {
+                scl_ipc_hal_release(SCL_RX_CHANNEL, SCL_RELEASE);
+                scl_rx_stats.post_low_watermark++;
+                if (scl_rx_post_info.active) {
+                    scl_rx_post_refill(true);
+                }
                 break;
             }
-            case 0xffffffff:{
+#endif
+            case SCL_RX_NO_MESSAGE:{
                 /*NP already release so no need to release*/
+                if (!polled) {
+                    scl_stats_count(SCL_STATS_ALREADY_RELEASED);
+                }
                 break;
             }
             default: {
                 SCL_LOG(("incorrect IPC from Network Processor\r\n"));
-                REG_IPC_STRUCT_RELEASE(scl_receive) = SCL_RELEASE;
+                scl_stats_count(SCL_STATS_UNKNOWN_MESSAGES);
+                scl_ipc_hal_release(SCL_RX_CHANNEL, SCL_RELEASE);
                 break;
             }
         }
+        if (!polled) {
+            SCL_TRACE(SCL_TRACE_RX_DONE, index, 0);
+            scl_latency_record_rx(index, SCL_LATENCY_RX_HANDLING, start, SCL_LATENCY_NOW());
+        }
+#if (SCL_RX_RING_ENABLE)
+        if (scl_rx_ring_info.active) {
+            scl_rx_ring_poll(polled);
+        }
+#endif
+        /* The frames of this pass are handed to the network stack together */
+        scl_rx_input_flush();
+#if (SCL_TX_RING_ENABLE)
+        if (scl_tx_ring_info.active) {
+            scl_tx_ring_poll();
+        }
+#endif
+#if (SCL_TX_CREDIT_ENABLE)
+        scl_tx_credit_poll();
+#endif
     }
 }
 
 scl_result_t scl_get_nw_parameters(network_params_t *nw_param)
 {
     scl_result_t status = SCL_ERROR;
-    status = scl_send_data(SCL_TX_WIFI_NW_PARAM, (char *)nw_param, TIMER_DEFAULT_VALUE);
+    status = scl_send_command(SCL_TX_WIFI_NW_PARAM, nw_param, sizeof(*nw_param), SCL_COMMAND_NO_RESULT, 0,
+                              SCL_SEND_TIMEOUT_DEFAULT);
     return status;
 }
@@ -0,0 +1,171 @@
+/*
+ * Copyright 2018-2020 Cypress Semiconductor Corporation
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ *  Provides the PSoC6 implementation of the IPC hardware access used by the SCL transport
+ */
+#include "scl_ipc_hal.h"
+
+#if !(SCL_IPC_HAL_HOST)
+#include "scl_ipc.h"
+#include "cyhal.h"
+
+/******************************************************
+ **                      Macros
+ *******************************************************/
+#define SCL_HAL_INTR_PRI           (1)
+#define SCL_HAL_LOCK_STATUS        (0x80000000)
+/* The interrupt lines of the IPC interrupt structures are consecutive */
+#define SCL_HAL_IRQN(intr)         ((IRQn_Type) ((uint32_t) cpuss_interrupts_ipc_0_IRQn + (intr)))
+
+/* The SCL deep sleep callback shall be the last callback that is executed before
+ * entry into deep sleep mode and the first one upon exit the deep sleep mode.
+ */
+#define SCL_PM_CALLBACK_ORDER      (255u)
+
+/******************************************************
+ *        Variables Definitions
+ *****************************************************/
+static scl_ipc_hal_idle_t scl_hal_idle;
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+
+scl_bool_t scl_ipc_hal_is_locked(uint32_t channel)
+{
+    IPC_STRUCT_Type *ipc = Cy_IPC_Drv_GetIpcBaseAddress(channel);
+
+    return (REG_IPC_STRUCT_LOCK_STATUS(ipc) & SCL_HAL_LOCK_STATUS) ? SCL_TRUE : SCL_FALSE;
+}
+
+scl_bool_t scl_ipc_hal_acquire(uint32_t channel)
+{
+    IPC_STRUCT_Type *ipc = Cy_IPC_Drv_GetIpcBaseAddress(channel);
+
+    /* Reading ACQUIRE takes the lock if it is free */
+    return (REG_IPC_STRUCT_ACQUIRE(ipc) & SCL_HAL_LOCK_STATUS) ? SCL_TRUE : SCL_FALSE;
+}
+
+uint32_t scl_ipc_hal_read_data0(uint32_t channel)
+{
+    return (uint32_t) REG_IPC_STRUCT_DATA0(Cy_IPC_Drv_GetIpcBaseAddress(channel));
+}
+
+uintptr_t scl_ipc_hal_read_data1(uint32_t channel)
+{
+    return (uintptr_t) REG_IPC_STRUCT_DATA1(Cy_IPC_Drv_GetIpcBaseAddress(channel));
+}
+
+void scl_ipc_hal_write(uint32_t channel, uint32_t data0, uintptr_t data1)
+{
+    IPC_STRUCT_Type *ipc = Cy_IPC_Drv_GetIpcBaseAddress(channel);
+
+    REG_IPC_STRUCT_DATA0(ipc) = data0;
+    REG_IPC_STRUCT_DATA1(ipc) = (uint32_t) data1;
+}
+
+void scl_ipc_hal_write_data1(uint32_t channel, uintptr_t data1)
+{
+    REG_IPC_STRUCT_DATA1(Cy_IPC_Drv_GetIpcBaseAddress(channel)) = (uint32_t) data1;
+}
+
+void scl_ipc_hal_notify(uint32_t channel, uint32_t intr_mask)
+{
+    REG_IPC_STRUCT_NOTIFY(Cy_IPC_Drv_GetIpcBaseAddress(channel)) = intr_mask;
+}
+
+void scl_ipc_hal_release(uint32_t channel, uint32_t intr_mask)
+{
+    REG_IPC_STRUCT_RELEASE(Cy_IPC_Drv_GetIpcBaseAddress(channel)) = intr_mask;
+}
+
+void scl_ipc_hal_enable_interrupt(uint32_t intr, uint32_t mask, scl_ipc_hal_isr_t isr)
+{
+    IPC_INTR_STRUCT_Type *ipc_intr = Cy_IPC_Drv_GetIntrBaseAddr(intr);
+    cy_stc_sysint_t intr_cfg = {
+        .intrSrc = SCL_HAL_IRQN(intr),
+        .intrPriority = SCL_HAL_INTR_PRI
+    };
+
+    REG_IPC_INTR_STRUCT_INTR_MASK(ipc_intr) |= mask;
+    Cy_SysInt_Init(&intr_cfg, isr);
+    NVIC_EnableIRQ(intr_cfg.intrSrc);
+}
+
+scl_bool_t scl_ipc_hal_clear_interrupt(uint32_t intr, uint32_t mask)
+{
+    IPC_INTR_STRUCT_Type *ipc_intr = Cy_IPC_Drv_GetIntrBaseAddr(intr);
+
+    if (REG_IPC_INTR_STRUCT_INTR_MASKED(ipc_intr) & mask) {
+        REG_IPC_INTR_STRUCT_INTR(ipc_intr) |= mask;
+        return SCL_TRUE;
+    }
+    return SCL_FALSE;
+}
+
+scl_bool_t scl_ipc_hal_in_isr(void)
+{
+    return (__get_IPSR() != 0) ? SCL_TRUE : SCL_FALSE;
+}
+
+cy_en_syspm_status_t scl_deepsleep_callback(cy_stc_syspm_callback_params_t * callbackParams, cy_en_syspm_callback_mode_t mode)
+{
+    (void)callbackParams;
+    cy_en_syspm_status_t retStatus = CY_SYSPM_FAIL;
+
+    switch (mode)
+    {
+        case CY_SYSPM_CHECK_READY:
+            /* SCL in ready to enter deep-sleep if no request is in flight or queued. */
+            if ((scl_hal_idle == NULL) || scl_hal_idle()) {
+                retStatus = CY_SYSPM_SUCCESS;
+            }
+            break;
+
+        case CY_SYSPM_BEFORE_TRANSITION:
+            /* fall-through */
+        case CY_SYSPM_CHECK_FAIL:
+            /* fall-through */
+        case CY_SYSPM_AFTER_TRANSITION:
+            /* do nothing. */
+            retStatus = CY_SYSPM_SUCCESS;
+            break;
+    }
+
+    return retStatus;
+}
+
+scl_result_t scl_ipc_hal_register_deepsleep(scl_ipc_hal_idle_t idle)
+{
+    scl_result_t result = SCL_SUCCESS;
+    static cy_stc_syspm_callback_params_t scl_deepsleep_pm_callback_param = {NULL, NULL};
+    static cy_stc_syspm_callback_t scl_deepsleep_pm_callback = {
+        .callback = &scl_deepsleep_callback,
+        .type = CY_SYSPM_DEEPSLEEP,
+        .callbackParams = &scl_deepsleep_pm_callback_param,
+        .order = SCL_PM_CALLBACK_ORDER
+    };
+
+    scl_hal_idle = idle;
+    if (!Cy_SysPm_RegisterCallback(&scl_deepsleep_pm_callback))
+    {
+        result = SCL_ERROR;
+    }
+    return result;
+}
+#endif
@@ -0,0 +1,150 @@
+/*
+ * Copyright 2018-2020 Cypress Semiconductor Corporation
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ *  Provides the lock-free multi-producer/single-consumer queue of IPC requests
+ */
+#include "scl_ipc_queue.h"
+#include "scl_ipc_ring.h"
+#include "stddef.h"
+#if !defined(__GNUC__) && !defined(__clang__)
+#include "cyhal.h"
+#endif
+
+/******************************************************
+ **                      Macros
+ *******************************************************/
+/* Reads the next field of a request written concurrently by a producer */
+#define SCL_IPC_QUEUE_NEXT(request)   (*(scl_ipc_request_t *volatile *) &(request)->next)
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+
+#if defined(__GNUC__) || defined(__clang__)
+void *scl_ipc_atomic_exchange(void *volatile *ptr, void *value)
+{
+    return __atomic_exchange_n(ptr, value, __ATOMIC_SEQ_CST);
+}
+
+scl_bool_t scl_ipc_atomic_cas(volatile uint32_t *ptr, uint32_t expected, uint32_t desired)
+{
+    return __atomic_compare_exchange_n(ptr, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST) ?
+           SCL_TRUE : SCL_FALSE;
+}
+
+uint32_t scl_ipc_atomic_add(volatile uint32_t *ptr, int32_t delta)
+{
+    return __atomic_add_fetch(ptr, (uint32_t) delta, __ATOMIC_SEQ_CST);
+}
+
+void scl_ipc_atomic_store(volatile uint32_t *ptr, uint32_t value)
+{
+    __atomic_store_n(ptr, value, __ATOMIC_SEQ_CST);
+}
+#else
+/* Without compiler atomics the operations are made atomic by masking interrupts */
+void *scl_ipc_atomic_exchange(void *volatile *ptr, void *value)
+{
+    uint32_t state = cyhal_system_critical_section_enter();
+    void *previous = *ptr;
+
+    *ptr = value;
+    cyhal_system_critical_section_exit(state);
+    return previous;
+}
+
+scl_bool_t scl_ipc_atomic_cas(volatile uint32_t *ptr, uint32_t expected, uint32_t desired)
+{
+    uint32_t state = cyhal_system_critical_section_enter();
+    scl_bool_t replaced = SCL_FALSE;
+
+    if (*ptr == expected) {
+        *ptr = desired;
+        replaced = SCL_TRUE;
+    }
+    cyhal_system_critical_section_exit(state);
+    return replaced;
+}
+
+uint32_t scl_ipc_atomic_add(volatile uint32_t *ptr, int32_t delta)
+{
+    uint32_t state = cyhal_system_critical_section_enter();
+    uint32_t value = *ptr + (uint32_t) delta;
+
+    *ptr = value;
+    cyhal_system_critical_section_exit(state);
+    return value;
+}
+
+void scl_ipc_atomic_store(volatile uint32_t *ptr, uint32_t value)
+{
+    SCL_IPC_MEMORY_BARRIER();
+    *ptr = value;
+    SCL_IPC_MEMORY_BARRIER();
+}
+#endif
+
+void scl_ipc_queue_init(scl_ipc_queue_t *queue)
+{
+    queue->stub.next = NULL;
+    queue->head = &queue->stub;
+    queue->tail = &queue->stub;
+    SCL_IPC_MEMORY_BARRIER();
+}
+
+void scl_ipc_queue_push(scl_ipc_queue_t *queue, scl_ipc_request_t *request)
+{
+    scl_ipc_request_t *previous;
+
+    request->next = NULL;
+    previous = scl_ipc_atomic_exchange((void *volatile *) &queue->tail, request);
+    /* Until this store the consumer cannot reach the request nor the ones appended after it */
+    SCL_IPC_MEMORY_BARRIER();
+    previous->next = request;
+}
+
+scl_result_t scl_ipc_queue_pop(scl_ipc_queue_t *queue, scl_ipc_request_t **request)
+{
+    scl_ipc_request_t *head = queue->head;
+    scl_ipc_request_t *next = SCL_IPC_QUEUE_NEXT(head);
+
+    if (head == &queue->stub) {
+        if (next == NULL) {
+            return (queue->tail == head) ? SCL_NO_PACKET_TO_RECEIVE : SCL_PENDING;
+        }
+        queue->head = next;
+        head = next;
+        next = SCL_IPC_QUEUE_NEXT(head);
+    }
+    SCL_IPC_MEMORY_BARRIER();
+    if (next == NULL) {
+        if (queue->tail != head) {
+            return SCL_PENDING;
+        }
+        /* The head is the last element, put the stub behind it so that it can be removed */
+        scl_ipc_queue_push(queue, &queue->stub);
+        next = SCL_IPC_QUEUE_NEXT(head);
+        if (next == NULL) {
+            return SCL_PENDING;
+        }
+    }
+    queue->head = next;
+    head->next = NULL;
+    *request = head;
+    return SCL_SUCCESS;
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright 2018-2020 Cypress Semiconductor Corporation
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ *  Provides the single-producer/single-consumer descriptor ring used between CP and NP
+ */
+#include "scl_ipc_ring.h"
+#include "string.h"
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+
+scl_result_t scl_ipc_ring_init(scl_ipc_ring_t *ring, scl_ipc_desc_t *desc, uint32_t size)
+{
+    if ((ring == NULL) || (desc == NULL) || (size == 0) || ((size & (size - 1)) != 0)) {
+        return SCL_BADARG;
+    }
+    memset(desc, 0, size * sizeof(scl_ipc_desc_t));
+    ring->head = 0;
+    ring->tail = 0;
+    ring->flags = 0;
+    ring->size = size;
+    ring->desc = desc;
+    ring->producer_flags = 0;
+    SCL_IPC_MEMORY_BARRIER();
+    return SCL_SUCCESS;
+}
+
+uint32_t scl_ipc_ring_count(const scl_ipc_ring_t *ring)
+{
+    return ring->head - ring->tail;
+}
+
+scl_result_t scl_ipc_ring_put(scl_ipc_ring_t *ring, const scl_ipc_desc_t *desc)
+{
+    uint32_t head = ring->head;
+
+    if ((head - ring->tail) >= ring->size) {
+        return SCL_BUFFER_UNAVAILABLE_TEMPORARY;
+    }
+    *SCL_IPC_RING_DESC(ring, head) = *desc;
+    /* The descriptor must be visible before the new head */
+    SCL_IPC_MEMORY_BARRIER();
+    ring->head = head + 1;
+    return SCL_SUCCESS;
+}
+
+scl_result_t scl_ipc_ring_get(scl_ipc_ring_t *ring, scl_ipc_desc_t *desc)
+{
+    uint32_t tail = ring->tail;
+
+    if (tail == ring->head) {
+        return SCL_NO_PACKET_TO_RECEIVE;
+    }
+    /* Do not read the descriptor before the head that published it */
+    SCL_IPC_MEMORY_BARRIER();
+    *desc = *SCL_IPC_RING_DESC(ring, tail);
+    /* The slot must be read completely before it is handed back to the producer */
+    SCL_IPC_MEMORY_BARRIER();
+    ring->tail = tail + 1;
+    return SCL_SUCCESS;
+}
+
+scl_bool_t scl_ipc_ring_doorbell_needed(const scl_ipc_ring_t *ring)
+{
+    /* Order the head update against the read of the consumer flags */
+    SCL_IPC_MEMORY_BARRIER();
+    return (ring->flags & SCL_IPC_RING_FLAG_DOORBELL) ? SCL_TRUE : SCL_FALSE;
+}
+
+scl_bool_t scl_ipc_ring_arm_doorbell(scl_ipc_ring_t *ring)
+{
+    ring->flags |= SCL_IPC_RING_FLAG_DOORBELL;
+    SCL_IPC_MEMORY_BARRIER();
+    return (ring->tail == ring->head) ? SCL_TRUE : SCL_FALSE;
+}
+
+void scl_ipc_ring_disarm_doorbell(scl_ipc_ring_t *ring)
+{
+    ring->flags &= ~SCL_IPC_RING_FLAG_DOORBELL;
+    SCL_IPC_MEMORY_BARRIER();
+}
+
+scl_bool_t scl_ipc_ring_arm_room(scl_ipc_ring_t *ring)
+{
+    ring->producer_flags |= SCL_IPC_RING_FLAG_ROOM;
+    SCL_IPC_MEMORY_BARRIER();
+    return ((ring->head - ring->tail) >= ring->size) ? SCL_TRUE : SCL_FALSE;
+}
+
+void scl_ipc_ring_disarm_room(scl_ipc_ring_t *ring)
+{
+    ring->producer_flags &= ~SCL_IPC_RING_FLAG_ROOM;
+    SCL_IPC_MEMORY_BARRIER();
+}
+
+scl_bool_t scl_ipc_ring_room_needed(const scl_ipc_ring_t *ring)
+{
+    /* Order the tail update against the read of the producer flags */
+    SCL_IPC_MEMORY_BARRIER();
+    return (ring->producer_flags & SCL_IPC_RING_FLAG_ROOM) ? SCL_TRUE : SCL_FALSE;
+}
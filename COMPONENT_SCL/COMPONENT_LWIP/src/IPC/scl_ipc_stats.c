@@ -0,0 +1,271 @@
+/*
+ * Copyright 2018-2020 Cypress Semiconductor Corporation
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ *  Provides the data-plane counters and the latency statistics of the IPC commands exchanged with Network Processor
+ */
+#include "scl_ipc_stats.h"
+#include "scl_ipc_queue.h"
+#include "cyhal.h"
+#include "scl_types.h"
+#include "string.h"
+
+/******************************************************
+ *        Variables Definitions
+ *****************************************************/
+/* Structure of SCL data-plane counters
+ *   tx:                   frames sent and their bytes, updated together
+ *   rx:                   frames received and their bytes, updated together
+ *   counter:              the other counters, indexed by scl_stats_counter_t
+ */
+static struct scl_stats_info_t {
+    struct {
+        uint32_t packets;
+        uint64_t bytes;
+    } tx, rx;
+    volatile uint32_t counter[SCL_STATS_COUNTER_MAX];
+} scl_stats_info;
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+
+void scl_stats_count_tx(uint32_t bytes)
+{
+    uint32_t state = cyhal_system_critical_section_enter();
+    scl_stats_info.tx.packets++;
+    scl_stats_info.tx.bytes += bytes;
+    cyhal_system_critical_section_exit(state);
+}
+
+void scl_stats_count_rx(uint32_t bytes)
+{
+    uint32_t state = cyhal_system_critical_section_enter();
+    scl_stats_info.rx.packets++;
+    scl_stats_info.rx.bytes += bytes;
+    cyhal_system_critical_section_exit(state);
+}
+
+void scl_stats_count(scl_stats_counter_t counter)
+{
+    if ((uint32_t) counter < SCL_STATS_COUNTER_MAX) {
+        (void) scl_ipc_atomic_add(&scl_stats_info.counter[counter], 1);
+    }
+}
+
+scl_result_t scl_get_stats(scl_stats_t *stats)
+{
+    uint32_t state;
+
+    if (stats == NULL) {
+        return SCL_BADARG;
+    }
+    state = cyhal_system_critical_section_enter();
+    stats->tx.packets = scl_stats_info.tx.packets;
+    stats->tx.bytes = scl_stats_info.tx.bytes;
+    stats->rx.packets = scl_stats_info.rx.packets;
+    stats->rx.bytes = scl_stats_info.rx.bytes;
+    cyhal_system_critical_section_exit(state);
+    stats->tx.dropped = scl_stats_info.counter[SCL_STATS_TX_DROPPED];
+    stats->tx.errors = scl_stats_info.counter[SCL_STATS_TX_ERRORS];
+    stats->rx.dropped = scl_stats_info.counter[SCL_STATS_RX_DROPPED];
+    stats->rx.errors = scl_stats_info.counter[SCL_STATS_RX_ERRORS];
+    stats->alloc_failures = scl_stats_info.counter[SCL_STATS_ALLOC_FAILURES];
+    stats->lock_failures = scl_stats_info.counter[SCL_STATS_LOCK_FAILURES];
+    stats->unknown_messages = scl_stats_info.counter[SCL_STATS_UNKNOWN_MESSAGES];
+    stats->already_released = scl_stats_info.counter[SCL_STATS_ALREADY_RELEASED];
+    stats->flow_controlled = scl_stats_info.counter[SCL_STATS_FLOW_CONTROLLED];
+    return SCL_SUCCESS;
+}
+
+#if (SCL_LATENCY_STATS_ENABLE)
+/******************************************************
+ *        Variables Definitions
+ *****************************************************/
+/* Structure of SCL latency info
+ *   tx:                   statistics of each scl_ipc_tx_t index
+ *   rx:                   statistics of each scl_ipc_rx_t index
+ *   cycles_per_us:        CPU cycles in one microsecond
+ */
+static struct scl_latency_info_t {
+    scl_tx_latency_stats_t tx[SCL_LATENCY_TX_INDEX_MAX];
+    scl_rx_latency_stats_t rx[SCL_LATENCY_RX_INDEX_MAX];
+    uint32_t cycles_per_us;
+} scl_latency_info = { .cycles_per_us = 1 };
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+
+/** Adds a sample to a histogram */
+static void scl_latency_add(scl_latency_histogram_t *histogram, uint32_t start, uint32_t end)
+{
+    uint32_t us = (end - start) / scl_latency_info.cycles_per_us;
+    uint32_t range = us;
+    uint32_t bucket = 0;
+    uint32_t state;
+
+    while ((range != 0) && (bucket < (SCL_LATENCY_BUCKETS - 1))) {
+        range >>= 1;
+        bucket++;
+    }
+    state = cyhal_system_critical_section_enter();
+    histogram->count++;
+    histogram->total_us += us;
+    if (us > histogram->max_us) {
+        histogram->max_us = us;
+    }
+    histogram->bucket[bucket]++;
+    cyhal_system_critical_section_exit(state);
+}
+
+void scl_latency_init(void)
+{
+    if (SystemCoreClock >= 1000000) {
+        scl_latency_info.cycles_per_us = SystemCoreClock / 1000000;
+    }
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+void scl_latency_record_tx(uint32_t index, scl_latency_tx_phase_t phase, uint32_t start, uint32_t end)
+{
+    scl_tx_latency_stats_t *stats;
+
+    if (index >= SCL_LATENCY_TX_INDEX_MAX) {
+        return;
+    }
+    stats = &scl_latency_info.tx[index];
+    switch (phase) {
+        case SCL_LATENCY_TX_QUEUE:
+            scl_latency_add(&stats->queue, start, end);
+            break;
+        case SCL_LATENCY_TX_ACQUIRE:
+            scl_latency_add(&stats->acquire, start, end);
+            break;
+        case SCL_LATENCY_TX_TURNAROUND:
+            scl_latency_add(&stats->turnaround, start, end);
+            break;
+        default:
+            break;
+    }
+}
+
+void scl_latency_lock_failure(uint32_t index)
+{
+    uint32_t state;
+
+    if (index < SCL_LATENCY_TX_INDEX_MAX) {
+        state = cyhal_system_critical_section_enter();
+        scl_latency_info.tx[index].lock_failures++;
+        cyhal_system_critical_section_exit(state);
+    }
+}
+
+void scl_latency_record_rx(uint32_t index, scl_latency_rx_phase_t phase, uint32_t start, uint32_t end)
+{
+    if (index >= SCL_LATENCY_RX_INDEX_MAX) {
+        return;
+    }
+    if (phase == SCL_LATENCY_RX_WAKEUP) {
+        scl_latency_add(&scl_latency_info.rx[index].wakeup, start, end);
+    } else {
+        scl_latency_add(&scl_latency_info.rx[index].handling, start, end);
+    }
+}
+
+scl_result_t scl_get_tx_latency_stats(int index, scl_tx_latency_stats_t *stats)
+{
+    uint32_t state;
+
+    CHECK_BUFFER_NULL(stats);
+    if ((index < 0) || (index >= SCL_LATENCY_TX_INDEX_MAX)) {
+        return SCL_BADARG;
+    }
+    state = cyhal_system_critical_section_enter();
+    *stats = scl_latency_info.tx[index];
+    cyhal_system_critical_section_exit(state);
+    return SCL_SUCCESS;
+}
+
+scl_result_t scl_get_rx_latency_stats(int index, scl_rx_latency_stats_t *stats)
+{
+    uint32_t state;
+
+    CHECK_BUFFER_NULL(stats);
+    if ((index < 0) || (index >= SCL_LATENCY_RX_INDEX_MAX)) {
+        return SCL_BADARG;
+    }
+    state = cyhal_system_critical_section_enter();
+    *stats = scl_latency_info.rx[index];
+    cyhal_system_critical_section_exit(state);
+    return SCL_SUCCESS;
+}
+
+void scl_reset_latency_stats(void)
+{
+    uint32_t state;
+
+    state = cyhal_system_critical_section_enter();
+    memset(scl_latency_info.tx, 0, sizeof(scl_latency_info.tx));
+    memset(scl_latency_info.rx, 0, sizeof(scl_latency_info.rx));
+    cyhal_system_critical_section_exit(state);
+}
+#else
+void scl_latency_init(void)
+{
+}
+
+void scl_latency_record_tx(uint32_t index, scl_latency_tx_phase_t phase, uint32_t start, uint32_t end)
+{
+    UNUSED_PARAMETER(index);
+    UNUSED_PARAMETER(phase);
+    UNUSED_PARAMETER(start);
+    UNUSED_PARAMETER(end);
+}
+
+void scl_latency_lock_failure(uint32_t index)
+{
+    UNUSED_PARAMETER(index);
+}
+
+void scl_latency_record_rx(uint32_t index, scl_latency_rx_phase_t phase, uint32_t start, uint32_t end)
+{
+    UNUSED_PARAMETER(index);
+    UNUSED_PARAMETER(phase);
+    UNUSED_PARAMETER(start);
+    UNUSED_PARAMETER(end);
+}
+
+scl_result_t scl_get_tx_latency_stats(int index, scl_tx_latency_stats_t *stats)
+{
+    UNUSED_PARAMETER(index);
+    UNUSED_PARAMETER(stats);
+    return SCL_UNSUPPORTED;
+}
+
+scl_result_t scl_get_rx_latency_stats(int index, scl_rx_latency_stats_t *stats)
+{
+    UNUSED_PARAMETER(index);
+    UNUSED_PARAMETER(stats);
+    return SCL_UNSUPPORTED;
+}
+
+void scl_reset_latency_stats(void)
+{
+}
+#endif
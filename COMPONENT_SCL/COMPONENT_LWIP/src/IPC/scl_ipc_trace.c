@@ -0,0 +1,158 @@
+/*
+ * Copyright 2018-2020 Cypress Semiconductor Corporation
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ *  Provides the lock-free binary trace of the IPC path
+ */
+#include "scl_ipc_trace.h"
+#include "scl_ipc_queue.h"
+#include "scl_ipc_ring.h"
+#include "scl_types.h"
+#include "cyhal.h"
+#include "string.h"
+
+#if (SCL_TRACE_ENABLE)
+#if ((SCL_TRACE_ENTRIES & (SCL_TRACE_ENTRIES - 1)) != 0)
+#error "SCL_TRACE_ENTRIES must be a power of two"
+#endif
+
+/******************************************************
+ *        Variables Definitions
+ *****************************************************/
+/* Structure of SCL trace info
+ *   entry:                circular buffer of the events
+ *   head:                 number of events recorded, the next one goes to entry[head % SCL_TRACE_ENTRIES]
+ *   cycles_per_us:        CPU cycles in one microsecond
+ *   enabled:              flag set while events are recorded
+ */
+static struct scl_trace_info_t {
+    scl_trace_entry_t entry[SCL_TRACE_ENTRIES];
+    volatile uint32_t head;
+    uint32_t cycles_per_us;
+    volatile bool enabled;
+} scl_trace_info = { .cycles_per_us = 1, .enabled = true };
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+
+void scl_trace_init(void)
+{
+    if (SystemCoreClock >= 1000000) {
+        scl_trace_info.cycles_per_us = SystemCoreClock / 1000000;
+    }
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+void scl_trace_record(scl_trace_event_t event, uint32_t index, uint32_t arg)
+{
+    scl_trace_entry_t *entry;
+    uint32_t slot;
+
+    if (!scl_trace_info.enabled) {
+        return;
+    }
+    /* Each recorder owns its slot, the sequence tells readers when the slot is complete */
+    slot = scl_ipc_atomic_add(&scl_trace_info.head, 1) - 1;
+    entry = &scl_trace_info.entry[slot & (SCL_TRACE_ENTRIES - 1)];
+    entry->sequence = 0;
+    SCL_IPC_MEMORY_BARRIER();
+    entry->timestamp = DWT->CYCCNT;
+    entry->event = (uint16_t) event;
+    entry->index = (uint16_t) index;
+    entry->arg = arg;
+    SCL_IPC_MEMORY_BARRIER();
+    entry->sequence = slot + 1;
+}
+
+scl_result_t scl_trace_dump(scl_trace_write_t write, void *user_data)
+{
+    scl_trace_header_t header;
+    scl_trace_entry_t entry;
+    uint32_t head;
+    uint32_t slot;
+
+    if (write == NULL) {
+        return SCL_BADARG;
+    }
+    head = scl_trace_info.head;
+    header.magic = SCL_TRACE_MAGIC;
+    header.version = SCL_TRACE_VERSION;
+    header.entry_size = sizeof(scl_trace_entry_t);
+    header.cycles_per_us = scl_trace_info.cycles_per_us;
+    header.count = (head < SCL_TRACE_ENTRIES) ? head : SCL_TRACE_ENTRIES;
+    write(&header, sizeof(header), user_data);
+    for (slot = head - header.count; slot != head; slot++) {
+        entry = scl_trace_info.entry[slot & (SCL_TRACE_ENTRIES - 1)];
+        SCL_IPC_MEMORY_BARRIER();
+        /* Skip the entries being written or already reused by newer events */
+        if ((entry.sequence != (slot + 1)) ||
+            (scl_trace_info.entry[slot & (SCL_TRACE_ENTRIES - 1)].sequence != entry.sequence)) {
+            memset(&entry, 0, sizeof(entry));
+        }
+        write(&entry, sizeof(entry), user_data);
+    }
+    return SCL_SUCCESS;
+}
+
+scl_result_t scl_trace_set_enabled(scl_bool_t enabled)
+{
+    scl_trace_info.enabled = (enabled == SCL_TRUE);
+    return SCL_SUCCESS;
+}
+
+scl_result_t scl_trace_reset(void)
+{
+    uint32_t state;
+
+    state = cyhal_system_critical_section_enter();
+    memset(scl_trace_info.entry, 0, sizeof(scl_trace_info.entry));
+    scl_trace_info.head = 0;
+    cyhal_system_critical_section_exit(state);
+    return SCL_SUCCESS;
+}
+#else
+void scl_trace_init(void)
+{
+}
+
+void scl_trace_record(scl_trace_event_t event, uint32_t index, uint32_t arg)
+{
+    UNUSED_PARAMETER(event);
+    UNUSED_PARAMETER(index);
+    UNUSED_PARAMETER(arg);
+}
+
+scl_result_t scl_trace_dump(scl_trace_write_t write, void *user_data)
+{
+    UNUSED_PARAMETER(write);
+    UNUSED_PARAMETER(user_data);
+    return SCL_UNSUPPORTED;
+}
+
+scl_result_t scl_trace_set_enabled(scl_bool_t enabled)
+{
+    UNUSED_PARAMETER(enabled);
+    return SCL_UNSUPPORTED;
+}
+
+scl_result_t scl_trace_reset(void)
+{
+    return SCL_UNSUPPORTED;
+}
+#endif
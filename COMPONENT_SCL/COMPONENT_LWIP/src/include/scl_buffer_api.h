@@ -40,6 +40,37 @@ extern "C"
 /******************************************************
 *                      Macros
 ******************************************************/
+/**
+ * Enables the fixed-block TX and RX buffer pools.
+ * Allocations that do not fit a block or find their pool empty fall back to the heap.
+ */
+#ifndef SCL_BUFFER_POOL_ENABLE
+#define SCL_BUFFER_POOL_ENABLE       (0)
+#endif
+/**
+ * Number of blocks in the TX pool
+ */
+#ifndef SCL_TX_POOL_COUNT
+#define SCL_TX_POOL_COUNT            (8)
+#endif
+/**
+ * Size of a TX pool block
+ */
+#ifndef SCL_TX_POOL_BUFFER_SIZE
+#define SCL_TX_POOL_BUFFER_SIZE      (SCL_LINK_MTU)
+#endif
+/**
+ * Number of blocks in the RX pool
+ */
+#ifndef SCL_RX_POOL_COUNT
+#define SCL_RX_POOL_COUNT            (16)
+#endif
+/**
+ * Size of an RX pool block
+ */
+#ifndef SCL_RX_POOL_BUFFER_SIZE
+#define SCL_RX_POOL_BUFFER_SIZE      (SCL_LINK_MTU)
+#endif
 
 /******************************************************
 *             Structures and Enumerations
@@ -53,13 +84,54 @@ typedef enum {
     SCL_NETWORK_RX = 1 /**< Receive direction */
 } scl_buffer_dir_t;
 
+/**
+ * Statistics of a buffer pool
+ */
+typedef struct {
+    uint32_t block_size;  /**< Size of a block */
+    uint32_t blocks;      /**< Number of blocks in the pool */
+    uint32_t free_blocks; /**< Blocks currently available */
+    uint32_t high_water;  /**< Largest number of blocks in use at the same time */
+    uint32_t allocations; /**< Buffers allocated from the pool */
+    uint32_t exhausted;   /**< Allocations that found the pool empty and used the heap */
+    uint32_t oversized;   /**< Allocations larger than a block that used the heap */
+} scl_buffer_pool_stats_t;
+
+/**
+ * Memory state changes reported to the registered callback
+ */
+typedef enum {
+    SCL_BUFFER_LOW_MEMORY       = 0, /**< An allocation failed, buffers of this direction are exhausted */
+    SCL_BUFFER_MEMORY_RECOVERED = 1  /**< An allocation succeeded again after a low memory report */
+} scl_buffer_memory_event_t;
+
+/**
+ * Callback for buffer memory state changes.
+ * Called from the allocating context, it must not block.
+ */
+typedef void (*scl_buffer_memory_callback_t)(scl_buffer_dir_t direction, scl_buffer_memory_event_t event,
+                                             void *user_data);
+
 /******************************************************
 *             Function Prototypes
 ******************************************************/
+/** Initializes the buffer management.
+ *
+ *  Creates the signal that wakes the callers of scl_host_buffer_get() waiting for a buffer.
+ *  Until it is called, scl_host_buffer_get() does not wait.
+ *
+ *  @return  SCL_SUCCESS or SCL_ERROR
+ */
+scl_result_t scl_buffer_init(void);
+
 /** Allocates the SCL buffer.
  *
  *  Attempts to allocate a buffer of the requested size. A buffer
  *  is either allocated from a static pool of memory or allocated dynamically.
+ *  If no buffer is available, the caller is blocked until a buffer is released
+ *  with scl_buffer_release(), a pool block or an lwIP pool element is freed, or
+ *  the wait time expires. Heap memory freed by lwIP is not signaled. Must not be
+ *  called with a non-zero wait from an interrupt.
  *
  *  @param   buffer    A pointer which receives the allocated buffer.
  *  @param   direction Indicates transmit/receive direction that the buffer is
@@ -86,6 +158,41 @@ scl_result_t scl_host_buffer_get(scl_buffer_t *buffer, scl_buffer_dir_t directio
  */
 void scl_buffer_release(scl_buffer_t buffer, scl_buffer_dir_t direction);
 
+/** Takes one more reference on the SCL buffer.
+ *
+ *  Used by SCL to keep a buffer of the caller beyond the call; each reference
+ *  is dropped with scl_buffer_release().
+ *
+ *  @param   buffer    The buffer to be kept.
+ */
+void scl_buffer_ref(scl_buffer_t buffer);
+
+/** Wakes up a caller waiting for a buffer once an exhausted lwIP pool has an element again.
+ *
+ *  Installed as LWIP_HOOK_MEMP_AVAILABLE by configs/lwipopts.h; may be called from any context.
+ *
+ *  @param   type      lwIP pool (memp_t) that got an element back.
+ */
+void scl_buffer_memp_available(int type);
+
+/** Registers the callback for low memory and recovered reports.
+ *
+ *  @param   callback  Callback to be called, NULL to unregister.
+ *  @param   user_data Passed back to the callback.
+ *
+ *  @return  SCL_SUCCESS
+ */
+scl_result_t scl_buffer_register_memory_callback(scl_buffer_memory_callback_t callback, void *user_data);
+
+/** Retrieves the statistics of the buffer pool of one direction.
+ *
+ *  @param   direction Pool to be queried.
+ *  @param   stats     Receives a copy of the pool statistics.
+ *
+ *  @return  SCL_SUCCESS, SCL_BADARG or SCL_UNSUPPORTED if the pools are disabled
+ */
+scl_result_t scl_buffer_get_pool_stats(scl_buffer_dir_t direction, scl_buffer_pool_stats_t *stats);
+
 /** Retrieves the pointer to the payload of the buffer.
  *
  *  @param   buffer   The buffer whose payload pointer is to be retrieved.
@@ -94,6 +201,23 @@ void scl_buffer_release(scl_buffer_t buffer, scl_buffer_dir_t direction);
  */
 uint8_t *scl_buffer_get_current_piece_data_pointer(scl_buffer_t buffer);
 
+/** Retrieves the next piece of a chained buffer.
+ *
+ *  @param   buffer   The current piece of the buffer.
+ *
+ *  @return  The next piece or NULL if this is the last piece.
+ */
+scl_buffer_t scl_buffer_get_next_piece(scl_buffer_t buffer);
+
+/** Copies all pieces of a chained buffer into a newly allocated TX buffer.
+ *
+ *  @param   buffer   The chained buffer, left untouched.
+ *  @param   flat     Receives the single-piece copy, to be released with scl_buffer_release().
+ *
+ *  @return  SCL_SUCCESS or SCL_BUFFER_ALLOC_FAIL
+ */
+scl_result_t scl_buffer_flatten(scl_buffer_t buffer, scl_buffer_t *flat);
+
 /** Retrieves the size of the buffer.
  *
  *  @param   buffer   The buffer whose size is to be retrieved.
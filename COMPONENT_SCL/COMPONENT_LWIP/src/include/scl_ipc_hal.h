@@ -0,0 +1,156 @@
+/*
+ * Copyright 2018-2020 Cypress Semiconductor Corporation
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ *  Provides declarations for the access to the IPC hardware used by the SCL transport.
+ *  The PSoC6 implementation drives the IPC_STRUCT registers; a host build provides its own.
+ */
+#ifndef INCLUDED_SCL_IPC_HAL_H_
+#define INCLUDED_SCL_IPC_HAL_H_
+
+#include <stdint.h>
+#include "scl_common.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/******************************************************
+*                      Macros
+******************************************************/
+/**
+ * Set by host builds, which provide their own implementation of this interface
+ * instead of the PSoC6 one in scl_ipc_hal.c
+ */
+#ifndef SCL_IPC_HAL_HOST
+#define SCL_IPC_HAL_HOST              (0)
+#endif
+
+/******************************************************
+*             Structures and Enumerations
+******************************************************/
+/**
+ * Handler of an IPC interrupt
+ */
+typedef void (*scl_ipc_hal_isr_t)(void);
+
+/**
+ * Returns SCL_TRUE when no request is in flight and the system may enter deep sleep
+ */
+typedef scl_bool_t (*scl_ipc_hal_idle_t)(void);
+
+/******************************************************
+*             Function Prototypes
+******************************************************/
+/** Checks whether the lock of an IPC channel is held
+ *
+ *  @param   channel   IPC channel.
+ *
+ *  @return  SCL_TRUE if the channel is locked
+ */
+scl_bool_t scl_ipc_hal_is_locked(uint32_t channel);
+
+/** Tries to acquire the lock of an IPC channel
+ *
+ *  @param   channel   IPC channel.
+ *
+ *  @return  SCL_TRUE if the lock was acquired
+ */
+scl_bool_t scl_ipc_hal_acquire(uint32_t channel);
+
+/** Reads the DATA0 register of an IPC channel
+ *
+ *  @param   channel   IPC channel.
+ *
+ *  @return  Register value
+ */
+uint32_t scl_ipc_hal_read_data0(uint32_t channel);
+
+/** Reads the DATA1 register of an IPC channel, which carries a pointer or a value
+ *
+ *  @param   channel   IPC channel.
+ *
+ *  @return  Register value
+ */
+uintptr_t scl_ipc_hal_read_data1(uint32_t channel);
+
+/** Writes the DATA0 and DATA1 registers of a locked IPC channel
+ *
+ *  @param   channel   IPC channel.
+ *  @param   data0     Value of DATA0.
+ *  @param   data1     Value of DATA1.
+ */
+void scl_ipc_hal_write(uint32_t channel, uint32_t data0, uintptr_t data1);
+
+/** Writes the DATA1 register of an IPC channel, used to answer a message before releasing it
+ *
+ *  @param   channel   IPC channel.
+ *  @param   data1     Value of DATA1.
+ */
+void scl_ipc_hal_write_data1(uint32_t channel, uintptr_t data1);
+
+/** Raises the notify interrupt of a locked IPC channel
+ *
+ *  @param   channel   IPC channel.
+ *  @param   intr_mask IPC interrupt structures to notify.
+ */
+void scl_ipc_hal_notify(uint32_t channel, uint32_t intr_mask);
+
+/** Releases the lock of an IPC channel
+ *
+ *  @param   channel   IPC channel.
+ *  @param   intr_mask IPC interrupt structures receiving the release interrupt, 0 for none.
+ */
+void scl_ipc_hal_release(uint32_t channel, uint32_t intr_mask);
+
+/** Routes an IPC interrupt structure to a handler and unmasks the given events
+ *
+ *  @param   intr      IPC interrupt structure, also selects the interrupt line.
+ *  @param   mask      Release (bits 0-15) and notify (bits 16-31) events to be unmasked.
+ *  @param   isr       Handler of the interrupt line.
+ */
+void scl_ipc_hal_enable_interrupt(uint32_t intr, uint32_t mask, scl_ipc_hal_isr_t isr);
+
+/** Clears pending events of an IPC interrupt structure, called from its handler
+ *
+ *  @param   intr      IPC interrupt structure.
+ *  @param   mask      Events to be checked.
+ *
+ *  @return  SCL_TRUE if one of the events was pending and unmasked
+ */
+scl_bool_t scl_ipc_hal_clear_interrupt(uint32_t intr, uint32_t mask);
+
+/** Checks whether the caller runs in interrupt context
+ *
+ *  @return  SCL_TRUE in an interrupt handler
+ */
+scl_bool_t scl_ipc_hal_in_isr(void);
+
+/** Registers the check done before the system enters deep sleep
+ *
+ *  @param   idle      Called to know whether SCL can enter deep sleep.
+ *
+ *  @return  SCL_SUCCESS or SCL_ERROR
+ */
+scl_result_t scl_ipc_hal_register_deepsleep(scl_ipc_hal_idle_t idle);
+
+#ifdef __cplusplus
+} /*extern "C" */
+#endif
+
+#endif /* ifndef INCLUDED_SCL_IPC_HAL_H_ */
@@ -0,0 +1,99 @@
+/*
+ * Copyright 2018-2020 Cypress Semiconductor Corporation
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ *  Provides declarations for the lock-free multi-producer/single-consumer queue
+ *  of IPC requests and the atomic operations it is built on
+ */
+#ifndef INCLUDED_SCL_IPC_QUEUE_H_
+#define INCLUDED_SCL_IPC_QUEUE_H_
+
+#include <stdint.h>
+#include "scl_ipc.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/******************************************************
+*             Structures and Enumerations
+******************************************************/
+/**
+ * Intrusive queue of requests linked through their next field.
+ * Any thread or ISR may push; a single consumer at a time may pop.
+ */
+typedef struct {
+    scl_ipc_request_t *head;          /**< Oldest element, used by the consumer only */
+    scl_ipc_request_t *volatile tail; /**< Newest element, swapped by the producers */
+    scl_ipc_request_t stub;           /**< Placeholder element, keeps head and tail valid */
+} scl_ipc_queue_t;
+
+/******************************************************
+*             Function Prototypes
+******************************************************/
+/** Atomically replaces a pointer
+ *
+ *  @return  Previous value of the pointer
+ */
+void *scl_ipc_atomic_exchange(void *volatile *ptr, void *value);
+
+/** Atomically replaces a value if it still holds the expected value
+ *
+ *  @return  SCL_TRUE if the value was replaced
+ */
+scl_bool_t scl_ipc_atomic_cas(volatile uint32_t *ptr, uint32_t expected, uint32_t desired);
+
+/** Atomically adds to a value
+ *
+ *  @return  New value
+ */
+uint32_t scl_ipc_atomic_add(volatile uint32_t *ptr, int32_t delta);
+
+/** Atomically stores a value, ordered after all previous memory accesses
+ */
+void scl_ipc_atomic_store(volatile uint32_t *ptr, uint32_t value);
+
+/** Initializes an empty queue
+ *
+ *  @param   queue     Queue to be initialized.
+ */
+void scl_ipc_queue_init(scl_ipc_queue_t *queue);
+
+/** Appends a request (producer side, any context)
+ *
+ *  @param   queue     Queue to be written.
+ *  @param   request   Request to be appended, its next field is overwritten.
+ */
+void scl_ipc_queue_push(scl_ipc_queue_t *queue, scl_ipc_request_t *request);
+
+/** Removes the oldest request (consumer side)
+ *
+ *  @param   queue     Queue to be read.
+ *  @param   request   Receives the oldest request.
+ *
+ *  @return  SCL_SUCCESS, SCL_NO_PACKET_TO_RECEIVE if the queue is empty or SCL_PENDING
+ *           if a producer was interrupted while appending; that producer sees the request
+ *           through once it resumes.
+ */
+scl_result_t scl_ipc_queue_pop(scl_ipc_queue_t *queue, scl_ipc_request_t **request);
+
+#ifdef __cplusplus
+} /*extern "C" */
+#endif
+
+#endif /* ifndef INCLUDED_SCL_IPC_QUEUE_H_ */
@@ -0,0 +1,190 @@
+/*
+ * Copyright 2018-2020 Cypress Semiconductor Corporation
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ *  Provides declarations for the single-producer/single-consumer descriptor ring
+ *  shared between the Connectivity Processor and the Network Processor
+ */
+#ifndef INCLUDED_SCL_IPC_RING_H_
+#define INCLUDED_SCL_IPC_RING_H_
+
+#include <stdint.h>
+#include "scl_common.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/******************************************************
+*                      Macros
+******************************************************/
+/**
+ * Full memory barrier, orders descriptor accesses against index updates
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define SCL_IPC_MEMORY_BARRIER()      __sync_synchronize()
+#else
+#include "cmsis_compiler.h"
+#define SCL_IPC_MEMORY_BARRIER()      __DMB()
+#endif
+
+/**
+ * Set by the consumer in the ring flags before it stops polling the ring.
+ * The producer notifies the consumer when it finds this flag after publishing descriptors.
+ */
+#define SCL_IPC_RING_FLAG_DOORBELL    (0x00000001)
+
+/**
+ * Set by the producer in the producer flags while it waits for free descriptors.
+ * The consumer notifies the producer when it finds this flag after consuming descriptors.
+ */
+#define SCL_IPC_RING_FLAG_ROOM        (0x00000002)
+
+/**
+ * Returns the descriptor stored at free-running position idx of the ring
+ */
+#define SCL_IPC_RING_DESC(ring, idx)  (&(ring)->desc[(idx) & ((ring)->size - 1)])
+
+/******************************************************
+*             Structures and Enumerations
+******************************************************/
+/**
+ * Identifiers of the rings that can be registered with the Network Processor
+ */
+typedef enum {
+    SCL_IPC_RING_TX          = 0, /**< CP to NP transmit ring */
+    SCL_IPC_RING_RX          = 1, /**< NP to CP receive completion ring */
+    SCL_IPC_RING_TX_COMPLETE = 2  /**< NP to CP ring of transmitted buffers */
+} scl_ipc_ring_id_t;
+
+/**
+ * Descriptor exchanged through the ring
+ */
+typedef struct {
+    uint32_t index;  /**< Command index (scl_ipc_tx_t or scl_ipc_rx_t) */
+    uint32_t length; /**< Length of the data referenced by buffer */
+    void *buffer;    /**< Buffer handed over to the other processor */
+} scl_ipc_desc_t;
+
+/**
+ * Ring header placed in memory shared by both processors.
+ * head and tail are free-running; each one is written only by its owner.
+ */
+typedef struct {
+    volatile uint32_t head;  /**< Producer index, written by the producer only */
+    volatile uint32_t tail;  /**< Consumer index, written by the consumer only */
+    volatile uint32_t flags; /**< SCL_IPC_RING_FLAG_* written by the consumer */
+    uint32_t size;           /**< Number of descriptors, a power of two */
+    scl_ipc_desc_t *desc;    /**< Descriptor storage */
+    volatile uint32_t producer_flags; /**< SCL_IPC_RING_FLAG_* written by the producer */
+} scl_ipc_ring_t;
+
+/******************************************************
+*             Function Prototypes
+******************************************************/
+/** Initializes an empty ring over the given descriptor storage
+ *
+ *  @param   ring      Ring to be initialized.
+ *  @param   desc      Array of size descriptors.
+ *  @param   size      Number of descriptors, must be a power of two.
+ *
+ *  @return  SCL_SUCCESS or SCL_BADARG
+ */
+scl_result_t scl_ipc_ring_init(scl_ipc_ring_t *ring, scl_ipc_desc_t *desc, uint32_t size);
+
+/** Returns the number of descriptors published but not yet consumed
+ *
+ *  @param   ring      Ring to be queried.
+ *
+ *  @return  Number of pending descriptors
+ */
+uint32_t scl_ipc_ring_count(const scl_ipc_ring_t *ring);
+
+/** Publishes one descriptor (producer side)
+ *
+ *  @param   ring      Ring to be written.
+ *  @param   desc      Descriptor to be copied into the ring.
+ *
+ *  @return  SCL_SUCCESS or SCL_BUFFER_UNAVAILABLE_TEMPORARY if the ring is full
+ */
+scl_result_t scl_ipc_ring_put(scl_ipc_ring_t *ring, const scl_ipc_desc_t *desc);
+
+/** Consumes one descriptor (consumer side)
+ *
+ *  @param   ring      Ring to be read.
+ *  @param   desc      Receives a copy of the oldest pending descriptor.
+ *
+ *  @return  SCL_SUCCESS or SCL_NO_PACKET_TO_RECEIVE if the ring is empty
+ */
+scl_result_t scl_ipc_ring_get(scl_ipc_ring_t *ring, scl_ipc_desc_t *desc);
+
+/** Checks, after publishing, whether the consumer asked to be notified (producer side)
+ *
+ *  @param   ring      Ring that was written.
+ *
+ *  @return  SCL_TRUE if a doorbell has to be sent to the consumer
+ */
+scl_bool_t scl_ipc_ring_doorbell_needed(const scl_ipc_ring_t *ring);
+
+/** Asks the producer for a doorbell before the consumer stops polling (consumer side)
+ *
+ *  The ring is checked again after the flag is set so that a descriptor
+ *  published concurrently is not missed.
+ *
+ *  @param   ring      Ring that was drained.
+ *
+ *  @return  SCL_TRUE if the ring is still empty and the consumer can sleep
+ */
+scl_bool_t scl_ipc_ring_arm_doorbell(scl_ipc_ring_t *ring);
+
+/** Clears the doorbell request once the consumer is polling again (consumer side)
+ *
+ *  @param   ring      Ring being drained.
+ */
+void scl_ipc_ring_disarm_doorbell(scl_ipc_ring_t *ring);
+
+/** Asks the consumer for a notification before the producer waits for free descriptors (producer side)
+ *
+ *  The ring is checked again after the flag is set so that a descriptor
+ *  consumed concurrently is not missed.
+ *
+ *  @param   ring      Ring found full.
+ *
+ *  @return  SCL_TRUE if the ring is still full and the producer can sleep
+ */
+scl_bool_t scl_ipc_ring_arm_room(scl_ipc_ring_t *ring);
+
+/** Clears the room request once the producer stops waiting (producer side)
+ *
+ *  @param   ring      Ring being filled.
+ */
+void scl_ipc_ring_disarm_room(scl_ipc_ring_t *ring);
+
+/** Checks, after consuming, whether the producer waits for free descriptors (consumer side)
+ *
+ *  @param   ring      Ring that was read.
+ *
+ *  @return  SCL_TRUE if the producer has to be notified
+ */
+scl_bool_t scl_ipc_ring_room_needed(const scl_ipc_ring_t *ring);
+
+#ifdef __cplusplus
+} /*extern "C" */
+#endif
+
+#endif /* ifndef INCLUDED_SCL_IPC_RING_H_ */
@@ -0,0 +1,133 @@
+/*
+ * Copyright 2018-2020 Cypress Semiconductor Corporation
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ *  Provides declarations for recording the data-plane counters and the latency statistics of the IPC commands
+ */
+#ifndef INCLUDED_SCL_IPC_STATS_H_
+#define INCLUDED_SCL_IPC_STATS_H_
+
+#include <stdint.h>
+#include "scl_ipc.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/******************************************************
+*                      Macros
+******************************************************/
+/**
+ * Returns the current timestamp, in CPU cycles
+ */
+#if (SCL_LATENCY_STATS_ENABLE)
+#define SCL_LATENCY_NOW()             (DWT->CYCCNT)
+#else
+#define SCL_LATENCY_NOW()             (0)
+#endif
+
+/******************************************************
+*             Structures and Enumerations
+******************************************************/
+/**
+ * Phases timed for the scl_ipc_tx_t indexes
+ */
+typedef enum {
+    SCL_LATENCY_TX_QUEUE      = 0, /**< Submission until the request is written to the IPC channel */
+    SCL_LATENCY_TX_ACQUIRE    = 1, /**< Acquisition of the IPC lock */
+    SCL_LATENCY_TX_TURNAROUND = 2  /**< IPC notification until NP releases the channel */
+} scl_latency_tx_phase_t;
+
+/**
+ * Phases timed for the scl_ipc_rx_t indexes
+ */
+typedef enum {
+    SCL_LATENCY_RX_WAKEUP     = 0, /**< RX interrupt until the SCL thread reads the message */
+    SCL_LATENCY_RX_HANDLING   = 1  /**< Handling of the message by the SCL thread */
+} scl_latency_rx_phase_t;
+
+/**
+ * Data-plane counters incremented by scl_stats_count()
+ */
+typedef enum {
+    SCL_STATS_TX_DROPPED       = 0, /**< scl_stats_t tx.dropped */
+    SCL_STATS_TX_ERRORS        = 1, /**< scl_stats_t tx.errors */
+    SCL_STATS_RX_DROPPED       = 2, /**< scl_stats_t rx.dropped */
+    SCL_STATS_RX_ERRORS        = 3, /**< scl_stats_t rx.errors */
+    SCL_STATS_ALLOC_FAILURES   = 4, /**< scl_stats_t alloc_failures */
+    SCL_STATS_LOCK_FAILURES    = 5, /**< scl_stats_t lock_failures */
+    SCL_STATS_UNKNOWN_MESSAGES = 6, /**< scl_stats_t unknown_messages */
+    SCL_STATS_ALREADY_RELEASED = 7, /**< scl_stats_t already_released */
+    SCL_STATS_FLOW_CONTROLLED  = 8, /**< scl_stats_t flow_controlled */
+    SCL_STATS_COUNTER_MAX           /**< Number of counters */
+} scl_stats_counter_t;
+
+/******************************************************
+*             Function Prototypes
+******************************************************/
+/** Starts the cycle counter used for the timestamps
+ */
+void scl_latency_init(void);
+
+/** Records a phase of a command sent to NP
+ *
+ *  @param   index     scl_ipc_tx_t index, tagged requests are recorded under their command index.
+ *  @param   phase     Phase being timed.
+ *  @param   start     SCL_LATENCY_NOW() at the start of the phase.
+ *  @param   end       SCL_LATENCY_NOW() at the end of the phase.
+ */
+void scl_latency_record_tx(uint32_t index, scl_latency_tx_phase_t phase, uint32_t start, uint32_t end);
+
+/** Counts a command that could not acquire the IPC lock
+ *
+ *  @param   index     scl_ipc_tx_t index.
+ */
+void scl_latency_lock_failure(uint32_t index);
+
+/** Records a phase of a message received from NP
+ *
+ *  @param   index     scl_ipc_rx_t index.
+ *  @param   phase     Phase being timed.
+ *  @param   start     SCL_LATENCY_NOW() at the start of the phase.
+ *  @param   end       SCL_LATENCY_NOW() at the end of the phase.
+ */
+void scl_latency_record_rx(uint32_t index, scl_latency_rx_phase_t phase, uint32_t start, uint32_t end);
+
+/** Counts a frame handed over to NP
+ *
+ *  @param   bytes     Length of the frame.
+ */
+void scl_stats_count_tx(uint32_t bytes);
+
+/** Counts a frame received from NP
+ *
+ *  @param   bytes     Length of the frame.
+ */
+void scl_stats_count_rx(uint32_t bytes);
+
+/** Increments a data-plane counter, from any thread or ISR
+ *
+ *  @param   counter   Counter to be incremented.
+ */
+void scl_stats_count(scl_stats_counter_t counter);
+
+#ifdef __cplusplus
+} /*extern "C" */
+#endif
+
+#endif /* ifndef INCLUDED_SCL_IPC_STATS_H_ */
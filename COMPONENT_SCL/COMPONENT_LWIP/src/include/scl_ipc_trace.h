@@ -0,0 +1,113 @@
+/*
+ * Copyright 2018-2020 Cypress Semiconductor Corporation
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ *  Provides declarations for recording the binary trace of the IPC path
+ */
+#ifndef INCLUDED_SCL_IPC_TRACE_H_
+#define INCLUDED_SCL_IPC_TRACE_H_
+
+#include <stdint.h>
+#include "scl_ipc.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/******************************************************
+*                      Macros
+******************************************************/
+/**
+ * Identifies a trace dump, "SCLT" in memory order
+ */
+#define SCL_TRACE_MAGIC               (0x544C4353)
+/**
+ * Version of the trace dump format
+ */
+#define SCL_TRACE_VERSION             (1)
+
+/**
+ * Records an event, compiled out unless SCL_TRACE_ENABLE is set
+ */
+#if (SCL_TRACE_ENABLE)
+#define SCL_TRACE(event, index, arg)  scl_trace_record((event), (uint32_t) (index), (uint32_t) (arg))
+#else
+#define SCL_TRACE(event, index, arg)
+#endif
+
+/******************************************************
+*             Structures and Enumerations
+******************************************************/
+/**
+ * Trace events. Keep in sync with tools/scl_trace_decode.py.
+ */
+typedef enum {
+    SCL_TRACE_RX_ISR       = 1,  /**< RX interrupt */
+    SCL_TRACE_RX_MESSAGE   = 2,  /**< SCL thread reads a message, index: scl_ipc_rx_t */
+    SCL_TRACE_RX_DONE      = 3,  /**< SCL thread handled the message, index: scl_ipc_rx_t */
+    SCL_TRACE_RX_POLL      = 4,  /**< SCL thread woken by the polling interval */
+    SCL_TRACE_RX_DESC      = 5,  /**< Descriptor read from the RX ring, index: scl_ipc_rx_t, arg: length */
+    SCL_TRACE_SEND         = 6,  /**< scl_send_data called, index: scl_ipc_tx_t, arg: timeout */
+    SCL_TRACE_SEND_DONE    = 7,  /**< scl_send_data returns, index: scl_ipc_tx_t, arg: result */
+    SCL_TRACE_POST         = 8,  /**< Request written to the IPC channel, index: scl_ipc_tx_t, arg: channel */
+    SCL_TRACE_RELEASE      = 9,  /**< IPC release interrupt, index: scl_ipc_tx_t retired, arg: channel */
+    SCL_TRACE_TIMEOUT      = 10  /**< scl_send_data timed out, index: scl_ipc_tx_t */
+} scl_trace_event_t;
+
+/**
+ * Header of a trace dump
+ */
+typedef struct {
+    uint32_t magic;         /**< SCL_TRACE_MAGIC */
+    uint16_t version;       /**< SCL_TRACE_VERSION */
+    uint16_t entry_size;    /**< Size of scl_trace_entry_t */
+    uint32_t cycles_per_us; /**< Timestamp ticks in one microsecond */
+    uint32_t count;         /**< Number of entries following the header */
+} scl_trace_header_t;
+
+/**
+ * Trace entry
+ */
+typedef struct {
+    uint32_t sequence;      /**< Position of the event in the trace plus one, 0 for an empty entry */
+    uint32_t timestamp;     /**< CPU cycle counter */
+    uint16_t event;         /**< scl_trace_event_t */
+    uint16_t index;         /**< Command or message index */
+    uint32_t arg;           /**< Event specific argument */
+} scl_trace_entry_t;
+
+/******************************************************
+*             Function Prototypes
+******************************************************/
+/** Starts the cycle counter used for the timestamps
+ */
+void scl_trace_init(void);
+
+/** Records an event, from any context
+ *
+ *  @param   event     Event to be recorded.
+ *  @param   index     Command or message index.
+ *  @param   arg       Event specific argument.
+ */
+void scl_trace_record(scl_trace_event_t event, uint32_t index, uint32_t arg);
+
+#ifdef __cplusplus
+} /*extern "C" */
+#endif
+
+#endif /* ifndef INCLUDED_SCL_IPC_TRACE_H_ */
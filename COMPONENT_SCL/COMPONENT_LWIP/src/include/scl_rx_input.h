@@ -0,0 +1,122 @@
+/*
+ * Copyright 2018-2020 Cypress Semiconductor Corporation
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ *  Provides declarations for the delivery of received frames from the SCL thread to lwIP
+ */
+#ifndef INCLUDED_SCL_RX_INPUT_H_
+#define INCLUDED_SCL_RX_INPUT_H_
+
+#include "scl_common.h"
+#include "scl_wifi_api.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/******************************************************
+*                      Macros
+******************************************************/
+/**
+ * Enables the direct input path: once a netif is registered with scl_rx_set_direct_input(), the SCL thread
+ * takes the lwIP core lock and feeds the received frames to the netif in batches, instead of posting each one
+ * to the tcpip thread. Frames go through the tcpip mbox while the core lock is held by another thread.
+ * lwIP may then transmit from the SCL thread, e.g. ARP replies and TCP ACKs. Such a frame waits at most
+ * SCL_RX_DIRECT_TX_TIMEOUT for room in the TX path, plus the TX locks briefly held by other senders, and is
+ * refused otherwise: the SCL thread does not process what frees the room while it waits, and every other lwIP
+ * user waits behind the core lock it holds.
+ * Requires LWIP_TCPIP_CORE_LOCKING and the LOCK_TCPIP_CORE() hooks of configs/lwipopts.h.
+ */
+#ifndef SCL_RX_DIRECT_INPUT_ENABLE
+#define SCL_RX_DIRECT_INPUT_ENABLE   (0)
+#endif
+/**
+ * Time (in ms) a frame sent by lwIP from the SCL thread waits for SCL, instead of the default send timeout.
+ * At least 1, as 0 stands for the default.
+ */
+#ifndef SCL_RX_DIRECT_TX_TIMEOUT
+#define SCL_RX_DIRECT_TX_TIMEOUT     (1)
+#endif
+/**
+ * Largest number of frames fed to lwIP per core lock acquisition
+ */
+#ifndef SCL_RX_INPUT_BATCH
+#define SCL_RX_INPUT_BATCH           (16)
+#endif
+
+/******************************************************
+*             Structures and Enumerations
+******************************************************/
+struct netif;
+
+/**
+ * Statistics of the RX input paths
+ */
+typedef struct {
+    uint32_t direct_frames;  /**< Frames fed to lwIP by the SCL thread holding the core lock */
+    uint32_t direct_batches; /**< Core lock acquisitions by the SCL thread */
+    uint32_t max_batch;      /**< Largest number of frames fed to lwIP in one acquisition */
+    uint32_t mbox_frames;    /**< Frames posted to the tcpip mbox */
+    uint32_t mbox_batches;   /**< Batches posted to the tcpip mbox */
+    uint32_t contended;      /**< Batches posted to the mbox because another thread held the core lock */
+    uint32_t behind_mbox;    /**< Batches posted to the mbox to stay behind frames still queued there */
+    uint32_t mbox_dropped;   /**< Frames dropped because the tcpip mbox was full */
+} scl_rx_input_stats_t;
+
+/******************************************************
+*             Function Prototypes
+******************************************************/
+/** Registers the netif the SCL thread feeds directly
+ *
+ *  Until a netif is registered, received frames are handed to scl_network_process_ethernet_data().
+ *  Call it after tcpip_init(), once the netif is added.
+ *
+ *  @param   netif     Ethernet netif fed with ethernet_input(), NULL to go back to
+ *                     scl_network_process_ethernet_data().
+ *
+ *  @return  SCL_SUCCESS or SCL_UNSUPPORTED if the direct input path is disabled
+ */
+scl_result_t scl_rx_set_direct_input(struct netif *netif);
+
+/** Delivers a received frame, possibly later in the batch of the current pass of the SCL thread
+ *
+ *  Called by the SCL thread only.
+ *
+ *  @param   buffer    Received frame, owned by the network stack from now on.
+ */
+void scl_rx_input(scl_buffer_t buffer);
+
+/** Delivers the frames batched by scl_rx_input()
+ *
+ *  Called by the SCL thread at the end of each pass over the received messages.
+ */
+void scl_rx_input_flush(void);
+
+/** Retrieves the statistics of the RX input paths
+ *
+ *  @param   stats     Receives a copy of the statistics.
+ *
+ *  @return  SCL_SUCCESS, SCL_BADARG or SCL_UNSUPPORTED if the direct input path is disabled
+ */
+scl_result_t scl_rx_input_get_stats(scl_rx_input_stats_t *stats);
+
+#ifdef __cplusplus
+} /*extern "C" */
+#endif
+
+#endif /* ifndef INCLUDED_SCL_RX_INPUT_H_ */
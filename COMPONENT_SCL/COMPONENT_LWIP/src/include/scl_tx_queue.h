@@ -0,0 +1,156 @@
+/*
+ * Copyright 2018-2020 Cypress Semiconductor Corporation
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ *  Provides declarations for the per access category TX queues feeding the Network Processor
+ */
+#ifndef INCLUDED_SCL_TX_QUEUE_H_
+#define INCLUDED_SCL_TX_QUEUE_H_
+
+#include "scl_common.h"
+#include "scl_wifi_api.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/******************************************************
+*                      Macros
+******************************************************/
+/**
+ * Enables the WMM TX queues: frames are queued per access category and sent by a weighted round-robin scheduler
+ * running in the TX drain thread.
+ * The queue takes its own reference on the frames and drops it after transmission.
+ */
+#ifndef SCL_TX_WMM_ENABLE
+#define SCL_TX_WMM_ENABLE            (0)
+#endif
+/**
+ * Priority of the TX drain thread. It should not be below the priority of the threads sending frames,
+ * otherwise their frames wait for the threads in between.
+ */
+#ifndef SCL_TX_DRAIN_THREAD_PRIORITY
+#define SCL_TX_DRAIN_THREAD_PRIORITY (CY_RTOS_PRIORITY_HIGH)
+#endif
+/**
+ * Stack size of the TX drain thread
+ */
+#ifndef SCL_TX_DRAIN_THREAD_STACK_SIZE
+#define SCL_TX_DRAIN_THREAD_STACK_SIZE (2048)
+#endif
+/**
+ * Number of frames each access category queue can hold
+ */
+#ifndef SCL_TX_QUEUE_DEPTH
+#define SCL_TX_QUEUE_DEPTH           (16)
+#endif
+/**
+ * Frames sent from each access category per scheduling round
+ */
+#ifndef SCL_TX_WEIGHT_VO
+#define SCL_TX_WEIGHT_VO             (8)
+#endif
+#ifndef SCL_TX_WEIGHT_VI
+#define SCL_TX_WEIGHT_VI             (4)
+#endif
+#ifndef SCL_TX_WEIGHT_BE
+#define SCL_TX_WEIGHT_BE             (2)
+#endif
+#ifndef SCL_TX_WEIGHT_BK
+#define SCL_TX_WEIGHT_BK             (1)
+#endif
+/**
+ * Enables the express queue: EAPOL, ARP, DHCP and pure TCP ACK frames skip the queued data.
+ * Requires SCL_TX_WMM_ENABLE.
+ */
+#ifndef SCL_TX_EXPRESS_ENABLE
+#define SCL_TX_EXPRESS_ENABLE        (0)
+#endif
+
+/******************************************************
+*             Structures and Enumerations
+******************************************************/
+/**
+ * TX queues, in increasing order of priority
+ */
+typedef enum {
+    SCL_TX_QUEUE_BK = 0, /**< Background */
+    SCL_TX_QUEUE_BE = 1, /**< Best effort */
+    SCL_TX_QUEUE_VI = 2, /**< Video */
+    SCL_TX_QUEUE_VO = 3, /**< Voice */
+    SCL_TX_QUEUE_EXPRESS = 4, /**< Link-critical frames, always sent first */
+    SCL_TX_QUEUE_MAX     /**< Number of TX queues */
+} scl_tx_queue_id_t;
+
+/**
+ * Statistics of a TX queue
+ */
+typedef struct {
+    uint32_t queued;    /**< Frames added to the queue */
+    uint32_t sent;      /**< Frames handed to the Network Processor */
+    uint32_t dropped;   /**< Frames released because the queue was full or the send failed */
+    uint32_t max_depth; /**< Largest number of frames waiting in the queue */
+} scl_tx_queue_stats_t;
+
+/******************************************************
+*             Function Prototypes
+******************************************************/
+/** Queues a frame in the queue of its priority and wakes the TX drain thread
+ *
+ *  The caller returns as soon as the frame is queued, the TX drain thread sends it.
+ *  A caller therefore never sends the frames of other callers, whatever their priority.
+ *  If the queue is full, the caller waits up to timeout for room.
+ *
+ *  @param   tx_buf    Frame to be sent, the caller keeps its reference and the queue takes its own.
+ *  @param   timeout   Time (in ms) to wait for room, SCL_SEND_TIMEOUT_DEFAULT for the default send timeout
+ *                     of a frame.
+ *
+ *  @return  SCL_SUCCESS, SCL_BUFFER_UNAVAILABLE_TEMPORARY if the queue is full or SCL_ERROR if the TX drain
+ *           thread is not started
+ */
+scl_result_t scl_tx_queue_send(scl_tx_buf_t *tx_buf, uint32_t timeout);
+
+/** Starts the TX drain thread
+ *
+ *  @return  SCL_SUCCESS, SCL_ERROR or SCL_UNSUPPORTED if the TX queues are disabled
+ */
+scl_result_t scl_tx_queue_init(void);
+
+/** Stops the TX drain thread and releases the frames left in the queues */
+void scl_tx_queue_deinit(void);
+
+/** Tells whether every queued frame has been handed to the Network Processor
+ *
+ *  @return  SCL_TRUE if the queues are empty
+ */
+scl_bool_t scl_tx_queue_is_idle(void);
+
+/** Retrieves the statistics of a TX queue
+ *
+ *  @param   queue     Queue to be queried.
+ *  @param   stats     Receives a copy of the queue statistics.
+ *
+ *  @return  SCL_SUCCESS, SCL_BADARG or SCL_UNSUPPORTED if the TX queues are disabled
+ */
+scl_result_t scl_tx_queue_get_stats(scl_tx_queue_id_t queue, scl_tx_queue_stats_t *stats);
+
+#ifdef __cplusplus
+} /*extern "C" */
+#endif
+
+#endif /* ifndef INCLUDED_SCL_TX_QUEUE_H_ */
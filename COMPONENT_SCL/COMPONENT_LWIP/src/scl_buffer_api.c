@@ -16,8 +16,13 @@
  */
 
 #include "scl_buffer_api.h"
+#include "scl_ipc_stats.h"
+#include "scl_ipc_hal.h"
 #include "cy_utils.h"
+#include "cyhal.h"
+#include "cyabs_rtos.h"
 #include "stdbool.h"
+#include "stddef.h"
 /******************************************************
 ** @cond               Constants
 *******************************************************/
@@ -26,23 +31,190 @@
 **                   Enumerations
 *******************************************************/
 
+#if (SCL_BUFFER_POOL_ENABLE)
+/******************************************************
+ *                      Macros
+ ******************************************************/
+/* Number of words taken by one pool block, header included */
+#define SCL_BUFFER_BLOCK_WORDS(size)  ((sizeof(scl_buffer_block_t) + LWIP_MEM_ALIGN_SIZE(size) + \
+                                        sizeof(uintptr_t) - 1) / sizeof(uintptr_t))
+
+/******************************************************
+ *             Structures
+ ******************************************************/
+struct scl_buffer_pool;
+
+/* Structure of SCL buffer pool block, followed by its data
+ *   next:                 next free block of the pool
+ *   pool:                 pool owning the block
+ *   custom:               pbuf handed out to lwIP, its payload is the block data
+ */
+typedef struct scl_buffer_block {
+    struct scl_buffer_block *next;
+    struct scl_buffer_pool *pool;
+    struct pbuf_custom custom;
+} scl_buffer_block_t;
+
+/* Structure of SCL buffer pool
+ *   free_list:            LIFO of the free blocks
+ *   memory:               storage of the blocks
+ *   stats:                pool statistics
+ */
+typedef struct scl_buffer_pool {
+    scl_buffer_block_t *free_list;
+    uintptr_t *memory;
+    scl_buffer_pool_stats_t stats;
+} scl_buffer_pool_t;
+#endif
+
 /******************************************************
 **               Function Declarations
 *******************************************************/
+static void scl_buffer_signal(void);
 
 /******************************************************
  *        Variables Definitions
  *****************************************************/
+#if (SCL_BUFFER_POOL_ENABLE)
+static uintptr_t scl_tx_pool_memory[SCL_TX_POOL_COUNT * SCL_BUFFER_BLOCK_WORDS(SCL_TX_POOL_BUFFER_SIZE)];
+static uintptr_t scl_rx_pool_memory[SCL_RX_POOL_COUNT * SCL_BUFFER_BLOCK_WORDS(SCL_RX_POOL_BUFFER_SIZE)];
+
+static scl_buffer_pool_t scl_buffer_pools[] = {
+    [SCL_NETWORK_TX] = {
+        .memory = scl_tx_pool_memory,
+        .stats = { .block_size = SCL_TX_POOL_BUFFER_SIZE, .blocks = SCL_TX_POOL_COUNT }
+    },
+    [SCL_NETWORK_RX] = {
+        .memory = scl_rx_pool_memory,
+        .stats = { .block_size = SCL_RX_POOL_BUFFER_SIZE, .blocks = SCL_RX_POOL_COUNT }
+    }
+};
+
+static bool scl_buffer_pools_inited = false;
+#endif
+
+/* Structure of SCL buffer wait info
+ *   available:            set when a buffer is released and a caller is waiting
+ *   waiters:              number of callers blocked in scl_host_buffer_get()
+ *   inited:               flag set once the semaphore is created
+ *   low_memory:           per direction, set while allocations fail
+ *   callback:             low memory and recovered callback
+ *   user_data:            passed back to the callback
+ */
+static struct scl_buffer_wait_info_t {
+    cy_semaphore_t available;
+    volatile uint32_t waiters;
+    bool inited;
+    volatile bool low_memory[SCL_NETWORK_RX + 1];
+    scl_buffer_memory_callback_t callback;
+    void *user_data;
+} scl_buffer_wait_info;
 
 /******************************************************
 *               Function Definitions
 ******************************************************/
 
-scl_result_t scl_host_buffer_get(scl_buffer_t *buffer, scl_buffer_dir_t direction,
-                                 uint16_t size, uint32_t wait)
+#if (SCL_BUFFER_POOL_ENABLE)
+/** Links all blocks of the pools into their free lists
+ *  Called with interrupts disabled.
+ */
+static void scl_buffer_pool_init(void)
+{
+    scl_buffer_pool_t *pool;
+    scl_buffer_block_t *block;
+    uint32_t words;
+    uint32_t i;
+    uint32_t dir;
+
+    for (dir = 0; dir < (sizeof(scl_buffer_pools) / sizeof(scl_buffer_pools[0])); dir++) {
+        pool = &scl_buffer_pools[dir];
+        words = SCL_BUFFER_BLOCK_WORDS(pool->stats.block_size);
+        pool->free_list = NULL;
+        for (i = 0; i < pool->stats.blocks; i++) {
+            block = (scl_buffer_block_t *) &pool->memory[i * words];
+            block->pool = pool;
+            block->next = pool->free_list;
+            pool->free_list = block;
+        }
+        pool->stats.free_blocks = pool->stats.blocks;
+    }
+    scl_buffer_pools_inited = true;
+}
+
+/** Returns a block to its pool once lwIP frees the last reference of its pbuf
+ *  May be called from any context, including interrupts.
+ */
+static void scl_buffer_pool_free(struct pbuf *p)
+{
+    scl_buffer_block_t *block = (scl_buffer_block_t *) ((uint8_t *) p - offsetof(scl_buffer_block_t, custom));
+    scl_buffer_pool_t *pool = block->pool;
+    uint32_t state;
+
+    state = cyhal_system_critical_section_enter();
+    block->next = pool->free_list;
+    pool->free_list = block;
+    pool->stats.free_blocks++;
+    cyhal_system_critical_section_exit(state);
+    scl_buffer_signal();
+}
+
+/** Takes a block from the pool of the direction
+ *
+ *  @return  pbuf of the requested size or NULL if the pool cannot serve the request
+ */
+static struct pbuf *scl_buffer_pool_alloc(scl_buffer_dir_t direction, uint16_t size)
+{
+    scl_buffer_pool_t *pool = &scl_buffer_pools[direction];
+    scl_buffer_block_t *block;
+    uint32_t in_use;
+    uint32_t state;
+
+    state = cyhal_system_critical_section_enter();
+    if (!scl_buffer_pools_inited) {
+        scl_buffer_pool_init();
+    }
+    if (size > pool->stats.block_size) {
+        pool->stats.oversized++;
+        block = NULL;
+    } else if (pool->free_list == NULL) {
+        pool->stats.exhausted++;
+        block = NULL;
+    } else {
+        block = pool->free_list;
+        pool->free_list = block->next;
+        pool->stats.free_blocks--;
+        pool->stats.allocations++;
+        in_use = pool->stats.blocks - pool->stats.free_blocks;
+        if (in_use > pool->stats.high_water) {
+            pool->stats.high_water = in_use;
+        }
+    }
+    cyhal_system_critical_section_exit(state);
+
+    if (block == NULL) {
+        return NULL;
+    }
+    block->custom.custom_free_function = scl_buffer_pool_free;
+    return pbuf_alloced_custom(PBUF_RAW, size, PBUF_RAM, &block->custom, (uint8_t *) (block + 1),
+                               (u16_t) pool->stats.block_size);
+}
+#endif
+
+/** Allocates a buffer without waiting
+ *
+ *  @return  pbuf of the requested size or NULL
+ */
+static struct pbuf *scl_buffer_alloc(scl_buffer_dir_t direction, uint16_t size)
 {
-    UNUSED_PARAMETER(direction);
     struct pbuf *p = NULL;
+#if (SCL_BUFFER_POOL_ENABLE)
+    if ((direction == SCL_NETWORK_TX) || (direction == SCL_NETWORK_RX)) {
+        p = scl_buffer_pool_alloc(direction, size);
+    }
+    if (p != NULL) {
+        return p;
+    }
+#endif
     if ((direction == SCL_NETWORK_TX) && (size <= PBUF_POOL_BUFSIZE)) {
         p = pbuf_alloc(PBUF_RAW, size, PBUF_POOL);
     } else {
@@ -51,19 +223,152 @@ scl_result_t scl_host_buffer_get(scl_buffer_t *buffer, scl_buffer_dir_t directio
             p->len = size;
         }
     }
-    if (p != NULL) {
-        *buffer = p;
+    return p;
+}
+
+/** Reports a change of the memory state of a direction to the registered callback */
+static void scl_buffer_memory_state(scl_buffer_dir_t direction, bool low_memory)
+{
+    struct scl_buffer_wait_info_t *info = &scl_buffer_wait_info;
+    scl_buffer_memory_callback_t callback;
+    void *user_data;
+    bool changed = false;
+    uint32_t state;
+
+    if (direction > SCL_NETWORK_RX) {
+        return;
+    }
+    state = cyhal_system_critical_section_enter();
+    if (info->low_memory[direction] != low_memory) {
+        info->low_memory[direction] = low_memory;
+        changed = true;
+    }
+    callback = info->callback;
+    user_data = info->user_data;
+    cyhal_system_critical_section_exit(state);
+
+    if (changed && (callback != NULL)) {
+        callback(direction, low_memory ? SCL_BUFFER_LOW_MEMORY : SCL_BUFFER_MEMORY_RECOVERED, user_data);
+    }
+}
+
+/** Wakes up one caller waiting for a buffer, which passes the wakeup on once it got one
+ *  May be called from any context, including interrupts.
+ */
+static void scl_buffer_signal(void)
+{
+    if (scl_buffer_wait_info.inited && (scl_buffer_wait_info.waiters > 0)) {
+        cy_rtos_set_semaphore(&scl_buffer_wait_info.available, scl_ipc_hal_in_isr() ? true : false);
+    }
+}
+
+void scl_buffer_memp_available(int type)
+{
+    UNUSED_PARAMETER(type);
+    scl_buffer_signal();
+}
+
+scl_result_t scl_buffer_init(void)
+{
+    if (scl_buffer_wait_info.inited) {
         return SCL_SUCCESS;
-    } else {
-        return SCL_BUFFER_ALLOC_FAIL;
     }
+    if (cy_rtos_init_semaphore(&scl_buffer_wait_info.available, 1, 0) != CY_RSLT_SUCCESS) {
+        return SCL_ERROR;
+    }
+    scl_buffer_wait_info.inited = true;
+    return SCL_SUCCESS;
+}
 
+scl_result_t scl_host_buffer_get(scl_buffer_t *buffer, scl_buffer_dir_t direction,
+                                 uint16_t size, uint32_t wait)
+{
+    struct scl_buffer_wait_info_t *info = &scl_buffer_wait_info;
+    struct pbuf *p = NULL;
+    cy_time_t start = 0;
+    cy_time_t now = 0;
+    uint32_t elapsed = 0;
+    uint32_t state;
+
+    p = scl_buffer_alloc(direction, size);
+    if ((p == NULL) && (wait > 0) && info->inited) {
+        scl_buffer_memory_state(direction, true);
+        cy_rtos_get_time(&start);
+        /* Counted before the next attempt so that a buffer freed in between wakes this caller */
+        state = cyhal_system_critical_section_enter();
+        info->waiters++;
+        cyhal_system_critical_section_exit(state);
+        while (((p = scl_buffer_alloc(direction, size)) == NULL) && (elapsed < wait)) {
+            cy_rtos_get_semaphore(&info->available, wait - elapsed, false);
+            cy_rtos_get_time(&now);
+            elapsed = (uint32_t) (now - start);
+        }
+        state = cyhal_system_critical_section_enter();
+        info->waiters--;
+        cyhal_system_critical_section_exit(state);
+        /* Several buffers may have been freed for a single wakeup */
+        if (p != NULL) {
+            scl_buffer_signal();
+        }
+    }
+
+    if (p == NULL) {
+        scl_buffer_memory_state(direction, true);
+        scl_stats_count(SCL_STATS_ALLOC_FAILURES);
+        return SCL_BUFFER_ALLOC_FAIL;
+    }
+    if ((direction <= SCL_NETWORK_RX) && info->low_memory[direction]) {
+        scl_buffer_memory_state(direction, false);
+    }
+    *buffer = p;
+    return SCL_SUCCESS;
 }
 
 void scl_buffer_release(scl_buffer_t buffer, scl_buffer_dir_t direction)
 {
     UNUSED_PARAMETER(direction);
     (void) pbuf_free((struct pbuf *)buffer);
+    /* Pool blocks signal from scl_buffer_pool_free(), lwIP pools from scl_buffer_memp_available() */
+    scl_buffer_signal();
+}
+
+void scl_buffer_ref(scl_buffer_t buffer)
+{
+    CY_ASSERT(buffer != NULL);
+    pbuf_ref((struct pbuf *) buffer);
+}
+
+scl_result_t scl_buffer_register_memory_callback(scl_buffer_memory_callback_t callback, void *user_data)
+{
+    uint32_t state;
+
+    state = cyhal_system_critical_section_enter();
+    scl_buffer_wait_info.callback = callback;
+    scl_buffer_wait_info.user_data = user_data;
+    cyhal_system_critical_section_exit(state);
+    return SCL_SUCCESS;
+}
+
+scl_result_t scl_buffer_get_pool_stats(scl_buffer_dir_t direction, scl_buffer_pool_stats_t *stats)
+{
+#if (SCL_BUFFER_POOL_ENABLE)
+    uint32_t state;
+
+    if ((stats == NULL) || ((direction != SCL_NETWORK_TX) && (direction != SCL_NETWORK_RX))) {
+        return SCL_BADARG;
+    }
+    state = cyhal_system_critical_section_enter();
+    if (!scl_buffer_pools_inited) {
+        scl_buffer_pool_init();
+    }
+    *stats = scl_buffer_pools[direction].stats;
+    cyhal_system_critical_section_exit(state);
+    return SCL_SUCCESS;
+#else
+    UNUSED_PARAMETER(direction);
+    UNUSED_PARAMETER(stats);
+    return SCL_UNSUPPORTED;
+#endif
 }
 
 uint8_t *scl_buffer_get_current_piece_data_pointer(scl_buffer_t buffer)
@@ -73,6 +378,27 @@ uint8_t *scl_buffer_get_current_piece_data_pointer(scl_buffer_t buffer)
     return (uint8_t *) pbuffer->payload;
 }
 
+scl_buffer_t scl_buffer_get_next_piece(scl_buffer_t buffer)
+{
+    CY_ASSERT(buffer != NULL);
+    struct pbuf *pbuffer = (struct pbuf *) buffer;
+    return (scl_buffer_t) pbuffer->next;
+}
+
+scl_result_t scl_buffer_flatten(scl_buffer_t buffer, scl_buffer_t *flat)
+{
+    CY_ASSERT(buffer != NULL);
+    struct pbuf *pbuffer = (struct pbuf *) buffer;
+    scl_result_t retval;
+
+    retval = scl_host_buffer_get(flat, SCL_NETWORK_TX, pbuffer->tot_len, SCL_FALSE);
+    if (retval != SCL_SUCCESS) {
+        return retval;
+    }
+    (void) pbuf_copy_partial(pbuffer, ((struct pbuf *) *flat)->payload, pbuffer->tot_len, 0);
+    return SCL_SUCCESS;
+}
+
 uint16_t scl_buffer_get_current_piece_size(scl_buffer_t buffer)
 {
     CY_ASSERT(buffer != NULL);
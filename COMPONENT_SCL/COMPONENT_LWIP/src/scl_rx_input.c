@@ -0,0 +1,208 @@
+/*
+ * Copyright 2018-2020 Cypress Semiconductor Corporation
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ *  Provides the delivery of received frames to lwIP, directly from the SCL thread under the
+ *  core lock or through the tcpip mbox
+ */
+#include "scl_rx_input.h"
+#include "scl_ipc_queue.h"
+#include "scl_ipc_stats.h"
+
+#if (SCL_RX_DIRECT_INPUT_ENABLE)
+#include "lwip/opt.h"
+#if !LWIP_TCPIP_CORE_LOCKING
+#error "SCL_RX_DIRECT_INPUT_ENABLE requires LWIP_TCPIP_CORE_LOCKING"
+#endif
+/* Checked before lwip/tcpip.h provides the default */
+#ifndef LOCK_TCPIP_CORE
+#error "SCL_RX_DIRECT_INPUT_ENABLE requires LOCK_TCPIP_CORE() to call scl_tcpip_core_lock(), see configs/lwipopts.h"
+#endif
+#include "lwip/tcpip.h"
+#include "lwip/netif.h"
+#include "lwip/pbuf.h"
+#include "netif/ethernet.h"
+
+/******************************************************
+ *             Structures
+ ******************************************************/
+/* Structure of SCL RX input info
+ *   netif:                netif fed by the SCL thread, NULL to use scl_network_process_ethernet_data()
+ *   frame:                frames received in the current pass, not yet delivered
+ *   count:                number of frames in the batch
+ *   mbox_pending:         frames posted to the tcpip mbox and not yet processed by the tcpip thread
+ *   stats:                statistics of the input paths
+ */
+static struct scl_rx_input_info_t {
+    struct netif *volatile netif;
+    struct pbuf *frame[SCL_RX_INPUT_BATCH];
+    uint32_t count;
+    volatile uint32_t mbox_pending;
+    scl_rx_input_stats_t stats;
+} scl_rx_input_info;
+
+/* Threads holding or waiting for the lwIP core lock */
+static volatile uint32_t scl_tcpip_core_users;
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+
+void scl_tcpip_core_lock(void)
+{
+    scl_ipc_atomic_add(&scl_tcpip_core_users, 1);
+    sys_mutex_lock(&lock_tcpip_core);
+}
+
+void scl_tcpip_core_unlock(void)
+{
+    sys_mutex_unlock(&lock_tcpip_core);
+    scl_ipc_atomic_add(&scl_tcpip_core_users, -1);
+}
+
+/** Takes the lwIP core lock if no other thread holds or waits for it
+ *
+ *  @return  true if the lock is taken
+ */
+static bool scl_tcpip_core_trylock(void)
+{
+    if (!scl_ipc_atomic_cas(&scl_tcpip_core_users, 0, 1)) {
+        return false;
+    }
+    /* Only a thread that has not yet counted itself can be in the way, and it waits behind this one */
+    sys_mutex_lock(&lock_tcpip_core);
+    return true;
+}
+
+/** Processes a frame posted to the tcpip mbox, on the tcpip thread */
+static err_t scl_rx_input_queued(struct pbuf *p, struct netif *netif)
+{
+    scl_ipc_atomic_add(&scl_rx_input_info.mbox_pending, -1);
+    return ethernet_input(p, netif);
+}
+
+/** Feeds the batch to lwIP with the core lock held */
+static void scl_rx_input_direct(struct netif *netif)
+{
+    struct scl_rx_input_info_t *info = &scl_rx_input_info;
+    uint32_t i;
+
+    for (i = 0; i < info->count; i++) {
+        if (ethernet_input(info->frame[i], netif) != ERR_OK) {
+            pbuf_free(info->frame[i]);
+        }
+    }
+    info->stats.direct_batches++;
+    info->stats.direct_frames += info->count;
+    if (info->count > info->stats.max_batch) {
+        info->stats.max_batch = info->count;
+    }
+}
+
+/** Posts the batch to the tcpip mbox, one message per frame */
+static void scl_rx_input_mbox(struct netif *netif)
+{
+    struct scl_rx_input_info_t *info = &scl_rx_input_info;
+    uint32_t i;
+
+    for (i = 0; i < info->count; i++) {
+        scl_ipc_atomic_add(&info->mbox_pending, 1);
+        if (tcpip_inpkt(info->frame[i], netif, scl_rx_input_queued) != ERR_OK) {
+            scl_ipc_atomic_add(&info->mbox_pending, -1);
+            pbuf_free(info->frame[i]);
+            info->stats.mbox_dropped++;
+            scl_stats_count(SCL_STATS_RX_DROPPED);
+            continue;
+        }
+        info->stats.mbox_frames++;
+    }
+    info->stats.mbox_batches++;
+}
+#endif
+
+scl_result_t scl_rx_set_direct_input(struct netif *netif)
+{
+#if (SCL_RX_DIRECT_INPUT_ENABLE)
+    scl_rx_input_info.netif = netif;
+    return SCL_SUCCESS;
+#else
+    UNUSED_PARAMETER(netif);
+    return SCL_UNSUPPORTED;
+#endif
+}
+
+void scl_rx_input(scl_buffer_t buffer)
+{
+#if (SCL_RX_DIRECT_INPUT_ENABLE)
+    struct scl_rx_input_info_t *info = &scl_rx_input_info;
+
+    if (info->netif == NULL) {
+        scl_network_process_ethernet_data(buffer);
+        return;
+    }
+    info->frame[info->count++] = (struct pbuf *) buffer;
+    if (info->count == SCL_RX_INPUT_BATCH) {
+        scl_rx_input_flush();
+    }
+#else
+    scl_network_process_ethernet_data(buffer);
+#endif
+}
+
+void scl_rx_input_flush(void)
+{
+#if (SCL_RX_DIRECT_INPUT_ENABLE)
+    struct scl_rx_input_info_t *info = &scl_rx_input_info;
+    struct netif *netif = info->netif;
+    uint32_t i;
+
+    if (info->count == 0) {
+        return;
+    }
+    if (netif == NULL) {
+        /* The netif was unregistered while the batch was filled */
+        for (i = 0; i < info->count; i++) {
+            scl_network_process_ethernet_data(info->frame[i]);
+        }
+    } else if (info->mbox_pending != 0) {
+        /* Feeding lwIP now would pass the frames still queued in the mbox */
+        info->stats.behind_mbox++;
+        scl_rx_input_mbox(netif);
+    } else if (!scl_tcpip_core_trylock()) {
+        info->stats.contended++;
+        scl_rx_input_mbox(netif);
+    } else {
+        scl_rx_input_direct(netif);
+        scl_tcpip_core_unlock();
+    }
+    info->count = 0;
+#endif
+}
+
+scl_result_t scl_rx_input_get_stats(scl_rx_input_stats_t *stats)
+{
+#if (SCL_RX_DIRECT_INPUT_ENABLE)
+    if (stats == NULL) {
+        return SCL_BADARG;
+    }
+    *stats = scl_rx_input_info.stats;
+    return SCL_SUCCESS;
+#else
+    UNUSED_PARAMETER(stats);
+    return SCL_UNSUPPORTED;
+#endif
+}
@@ -0,0 +1,486 @@
+/*
+ * Copyright 2018-2020 Cypress Semiconductor Corporation
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ *  Provides the per access category TX queues and their weighted round-robin scheduler
+ */
+#include "scl_tx_queue.h"
+#include "scl_ipc.h"
+#include "scl_buffer_api.h"
+#include "scl_ipc_stats.h"
+#include "cyhal.h"
+#include "cyabs_rtos.h"
+#include "stdbool.h"
+
+#if (SCL_TX_EXPRESS_ENABLE) && !(SCL_TX_WMM_ENABLE)
+#error "SCL_TX_EXPRESS_ENABLE requires SCL_TX_WMM_ENABLE"
+#endif
+
+#if (SCL_TX_WMM_ENABLE)
+/******************************************************
+ *                      Macros
+ ******************************************************/
+#define SCL_ETHERNET_HEADER_LEN    (14)
+#define SCL_ETHERTYPE_OFFSET       (12)
+#define SCL_ETHERTYPE_IPV4         (0x0800)
+#define SCL_ETHERTYPE_IPV6         (0x86DD)
+#define SCL_ETHERTYPE_VLAN         (0x8100)
+#define SCL_ETHERTYPE_ARP          (0x0806)
+#define SCL_ETHERTYPE_EAPOL        (0x888E)
+#define SCL_IPV4_HEADER_LEN        (20)
+#define SCL_IPV6_HEADER_LEN        (40)
+#define SCL_IP_PROTO_TCP           (6)
+#define SCL_IP_PROTO_UDP           (17)
+#define SCL_TCP_HEADER_LEN         (20)
+#define SCL_TCP_FLAG_FIN           (0x01)
+#define SCL_TCP_FLAG_SYN           (0x02)
+#define SCL_TCP_FLAG_RST           (0x04)
+#define SCL_TCP_FLAG_ACK           (0x10)
+#define SCL_UDP_HEADER_LEN         (8)
+#define SCL_DHCP_SERVER_PORT       (67)
+#define SCL_DHCP_CLIENT_PORT       (68)
+#define SCL_DHCP6_CLIENT_PORT      (546)
+#define SCL_DHCP6_SERVER_PORT      (547)
+#define SCL_READ_BE16(p)           ((uint16_t) (((p)[0] << 8) | (p)[1]))
+#define SCL_VLAN_TAG_LEN           (4)
+#define SCL_USER_PRIORITY_MASK     (0x7)
+
+/******************************************************
+ *             Structures
+ ******************************************************/
+/* Structure of SCL TX queue
+ *   frame:                frames waiting to be sent
+ *   head:                 oldest frame
+ *   count:                number of frames waiting
+ *   quota:                frames the queue may still send in the current round
+ *   room:                 set when a frame is taken and a caller is waiting
+ *   waiters:              number of callers waiting for the queue not to be full
+ *   stats:                queue statistics
+ */
+struct scl_tx_queue {
+    scl_tx_buf_t frame[SCL_TX_QUEUE_DEPTH];
+    uint32_t head;
+    uint32_t count;
+    uint32_t quota;
+    cy_semaphore_t room;
+    uint32_t waiters;
+    scl_tx_queue_stats_t stats;
+};
+
+/******************************************************
+ *        Variables Definitions
+ *****************************************************/
+/* 802.1D user priority to TX queue */
+static const uint8_t scl_tx_up_to_queue[] = {
+    SCL_TX_QUEUE_BE, SCL_TX_QUEUE_BK, SCL_TX_QUEUE_BK, SCL_TX_QUEUE_BE,
+    SCL_TX_QUEUE_VI, SCL_TX_QUEUE_VI, SCL_TX_QUEUE_VO, SCL_TX_QUEUE_VO
+};
+
+static const uint32_t scl_tx_weight[SCL_TX_QUEUE_MAX] = {
+    [SCL_TX_QUEUE_BK] = SCL_TX_WEIGHT_BK,
+    [SCL_TX_QUEUE_BE] = SCL_TX_WEIGHT_BE,
+    [SCL_TX_QUEUE_VI] = SCL_TX_WEIGHT_VI,
+    [SCL_TX_QUEUE_VO] = SCL_TX_WEIGHT_VO,
+    [SCL_TX_QUEUE_EXPRESS] = 0
+};
+
+static struct scl_tx_queue scl_tx_queues[SCL_TX_QUEUE_MAX];
+
+/* Number of frames in all queues */
+static uint32_t scl_tx_queued_frames;
+
+/* Thread sending the queued frames, woken by scl_tx_drain_ready when a frame is queued */
+static cy_thread_t scl_tx_drain_thread;
+static cy_semaphore_t scl_tx_drain_ready;
+static bool scl_tx_drain_inited;
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+
+#if (SCL_TX_EXPRESS_ENABLE)
+/** Tells whether a transport header belongs to a DHCP message or a pure TCP ACK
+ *
+ *  @param   l4          Offset of the transport header in the frame.
+ *  @param   l4_length   Length of the transport header and payload, from the IP header.
+ */
+static bool scl_tx_is_express_l4(const uint8_t *frame, uint16_t length, uint8_t protocol,
+                                 uint32_t l4, uint32_t l4_length)
+{
+    uint16_t port;
+    uint8_t flags;
+
+    if ((protocol == SCL_IP_PROTO_UDP) && (length >= (l4 + SCL_UDP_HEADER_LEN))) {
+        port = SCL_READ_BE16(&frame[l4 + 2]);
+        return (port == SCL_DHCP_SERVER_PORT) || (port == SCL_DHCP_CLIENT_PORT) ||
+               (port == SCL_DHCP6_CLIENT_PORT) || (port == SCL_DHCP6_SERVER_PORT);
+    }
+    if ((protocol == SCL_IP_PROTO_TCP) && (length >= (l4 + SCL_TCP_HEADER_LEN))) {
+        flags = frame[l4 + 13];
+        /* ACK only, without data or connection state change */
+        return ((uint32_t) ((frame[l4 + 12] >> 4) * 4) == l4_length) && (flags & SCL_TCP_FLAG_ACK) &&
+               !(flags & (SCL_TCP_FLAG_SYN | SCL_TCP_FLAG_FIN | SCL_TCP_FLAG_RST));
+    }
+    return false;
+}
+
+/** Tells whether a frame is link-critical: EAPOL, ARP, DHCP or a pure TCP ACK
+ *
+ *  @param   l3          Offset of the network header in the frame.
+ */
+static bool scl_tx_is_express(const uint8_t *frame, uint16_t length, uint16_t ethertype, uint32_t l3)
+{
+    uint32_t header_length;
+
+    if ((ethertype == SCL_ETHERTYPE_EAPOL) || (ethertype == SCL_ETHERTYPE_ARP)) {
+        return true;
+    }
+    if ((ethertype == SCL_ETHERTYPE_IPV4) && (length >= (l3 + SCL_IPV4_HEADER_LEN))) {
+        /* Only the first fragment carries the transport header */
+        if (((frame[l3 + 6] & 0x1f) != 0) || (frame[l3 + 7] != 0)) {
+            return false;
+        }
+        header_length = (uint32_t) (frame[l3] & 0x0f) * 4;
+        return scl_tx_is_express_l4(frame, length, frame[l3 + 9], l3 + header_length,
+                                    SCL_READ_BE16(&frame[l3 + 2]) - header_length);
+    }
+    if ((ethertype == SCL_ETHERTYPE_IPV6) && (length >= (l3 + SCL_IPV6_HEADER_LEN))) {
+        return scl_tx_is_express_l4(frame, length, frame[l3 + 6], l3 + SCL_IPV6_HEADER_LEN,
+                                    SCL_READ_BE16(&frame[l3 + 4]));
+    }
+    return false;
+}
+#endif
+
+/** Selects the queue of a frame: express for link-critical frames, otherwise
+ *  from its explicit priority, its VLAN tag or its IP DSCP.
+ *  Only the Ethernet and IP headers of the first piece are looked at.
+ */
+static scl_tx_queue_id_t scl_tx_classify(const scl_tx_buf_t *tx_buf)
+{
+    const uint8_t *frame;
+    uint16_t length;
+    uint16_t ethertype;
+    uint32_t offset = SCL_ETHERTYPE_OFFSET;
+    uint8_t vlan_priority = 0;
+    uint8_t dscp;
+
+    frame = scl_buffer_get_current_piece_data_pointer(tx_buf->buffer);
+    length = scl_buffer_get_current_piece_size(tx_buf->buffer);
+    if (length < SCL_ETHERNET_HEADER_LEN) {
+        return SCL_TX_QUEUE_BE;
+    }
+    ethertype = SCL_READ_BE16(&frame[offset]);
+    if ((ethertype == SCL_ETHERTYPE_VLAN) && (length >= (SCL_ETHERNET_HEADER_LEN + SCL_VLAN_TAG_LEN))) {
+        vlan_priority = frame[offset + 2] >> 5;
+        offset += SCL_VLAN_TAG_LEN;
+        ethertype = SCL_READ_BE16(&frame[offset]);
+    }
+    offset += 2;
+#if (SCL_TX_EXPRESS_ENABLE)
+    if (scl_tx_is_express(frame, length, ethertype, offset)) {
+        return SCL_TX_QUEUE_EXPRESS;
+    }
+#endif
+    if (tx_buf->priority != 0) {
+        return (scl_tx_queue_id_t) scl_tx_up_to_queue[tx_buf->priority & SCL_USER_PRIORITY_MASK];
+    }
+    /* A priority in the VLAN tag wins over the DSCP */
+    if (vlan_priority != 0) {
+        return (scl_tx_queue_id_t) scl_tx_up_to_queue[vlan_priority];
+    }
+    if (length < (offset + 2)) {
+        return SCL_TX_QUEUE_BE;
+    }
+    if (ethertype == SCL_ETHERTYPE_IPV4) {
+        dscp = frame[offset + 1] >> 2;
+    } else if (ethertype == SCL_ETHERTYPE_IPV6) {
+        dscp = (uint8_t) (((frame[offset] & 0x0f) << 2) | (frame[offset + 1] >> 6));
+    } else {
+        return SCL_TX_QUEUE_BE;
+    }
+    /* The class selector bits of the DSCP give the user priority */
+    return (scl_tx_queue_id_t) scl_tx_up_to_queue[dscp >> 3];
+}
+
+/** Removes the oldest frame of a queue
+ *  Called with interrupts disabled.
+ */
+static void scl_tx_take(struct scl_tx_queue *queue, scl_tx_buf_t *tx_buf)
+{
+    *tx_buf = queue->frame[queue->head];
+    queue->head = (queue->head + 1) % SCL_TX_QUEUE_DEPTH;
+    queue->count--;
+    scl_tx_queued_frames--;
+}
+
+/** Takes the next frame to be sent, by weighted round-robin across the queues
+ *  Called with interrupts disabled.
+ *
+ *  @return  true if a frame was taken from the queue returned in from
+ */
+static bool scl_tx_dequeue(scl_tx_buf_t *tx_buf, struct scl_tx_queue **from)
+{
+    struct scl_tx_queue *queue;
+    int32_t id;
+    uint32_t round;
+
+    if (scl_tx_queued_frames == 0) {
+        return false;
+    }
+    /* The express queue is served before any round */
+    queue = &scl_tx_queues[SCL_TX_QUEUE_EXPRESS];
+    if (queue->count > 0) {
+        scl_tx_take(queue, tx_buf);
+        *from = queue;
+        return true;
+    }
+    for (round = 0; round < 2; round++) {
+        /* Higher priorities go first within a round as long as they have quota left */
+        for (id = SCL_TX_QUEUE_VO; id >= SCL_TX_QUEUE_BK; id--) {
+            queue = &scl_tx_queues[id];
+            if ((queue->count > 0) && (queue->quota > 0)) {
+                scl_tx_take(queue, tx_buf);
+                queue->quota--;
+                *from = queue;
+                return true;
+            }
+        }
+        /* Every queue with frames has used its quota, start a new round */
+        for (id = SCL_TX_QUEUE_BK; id <= SCL_TX_QUEUE_VO; id++) {
+            scl_tx_queues[id].quota = scl_tx_weight[id];
+        }
+    }
+    return false;
+}
+
+/** Sends the queued frames until the queues are empty
+ *  Only called from the TX drain thread.
+ */
+static void scl_tx_drain(void)
+{
+    scl_tx_buf_t tx_buf;
+    struct scl_tx_queue *queue = NULL;
+    scl_result_t retval;
+    uint32_t state;
+    bool found;
+    bool waiting;
+
+    while (SCL_TRUE) {
+        state = cyhal_system_critical_section_enter();
+        found = scl_tx_dequeue(&tx_buf, &queue);
+        waiting = found && (queue->waiters > 0);
+        cyhal_system_critical_section_exit(state);
+        if (!found) {
+            break;
+        }
+        if (waiting) {
+            (void) cy_rtos_set_semaphore(&queue->room, SCL_FALSE);
+        }
+        retval = scl_send_data(SCL_TX_SEND_OUT, (char *) &tx_buf, SCL_SEND_TIMEOUT_DEFAULT);
+        /* The statistics are also updated by scl_tx_queue_send() */
+        state = cyhal_system_critical_section_enter();
+        if (retval == SCL_SUCCESS) {
+            queue->stats.sent++;
+        } else {
+            queue->stats.dropped++;
+        }
+        cyhal_system_critical_section_exit(state);
+        if (retval != SCL_SUCCESS) {
+            scl_tx_credit_return();
+            scl_buffer_release(tx_buf.buffer, SCL_NETWORK_TX);
+            continue;
+        }
+        /* The TX ring keeps its own reference until NP consumes the frame */
+        scl_buffer_release(tx_buf.buffer, SCL_NETWORK_TX);
+        if (queue == &scl_tx_queues[SCL_TX_QUEUE_EXPRESS]) {
+            /* A link-critical frame does not wait for the doorbell of a batch or in an aggregate */
+            scl_tx_flush();
+        }
+    }
+    /* No frame is left to coalesce with the ones waiting for the doorbell */
+    scl_tx_flush();
+}
+
+/** Entry of the TX drain thread
+ *
+ *  A frame queued while the queues are being drained sets the semaphore again,
+ *  so no frame is left behind.
+ */
+static void scl_tx_drain_handler(cy_thread_arg_t arg)
+{
+    UNUSED_PARAMETER(arg);
+    while (SCL_TRUE) {
+        (void) cy_rtos_get_semaphore(&scl_tx_drain_ready, CY_RTOS_NEVER_TIMEOUT, SCL_FALSE);
+        scl_tx_drain();
+    }
+}
+#endif
+
+scl_result_t scl_tx_queue_init(void)
+{
+#if (SCL_TX_WMM_ENABLE)
+    uint32_t id;
+
+    if (scl_tx_drain_inited) {
+        return SCL_SUCCESS;
+    }
+    for (id = 0; id < SCL_TX_QUEUE_MAX; id++) {
+        if (cy_rtos_init_semaphore(&scl_tx_queues[id].room, 1, 0) != CY_RSLT_SUCCESS) {
+            break;
+        }
+    }
+    if ((id == SCL_TX_QUEUE_MAX) && (cy_rtos_init_semaphore(&scl_tx_drain_ready, 1, 0) == CY_RSLT_SUCCESS)) {
+        if (cy_rtos_create_thread(&scl_tx_drain_thread, scl_tx_drain_handler, "SCL_tx_drain", NULL,
+                                  SCL_TX_DRAIN_THREAD_STACK_SIZE, (cy_thread_priority_t) SCL_TX_DRAIN_THREAD_PRIORITY,
+                                  (cy_thread_arg_t) NULL) == CY_RSLT_SUCCESS) {
+            scl_tx_drain_inited = true;
+            return SCL_SUCCESS;
+        }
+        (void) cy_rtos_deinit_semaphore(&scl_tx_drain_ready);
+    }
+    while (id > 0) {
+        (void) cy_rtos_deinit_semaphore(&scl_tx_queues[--id].room);
+    }
+    return SCL_ERROR;
+#else
+    return SCL_UNSUPPORTED;
+#endif
+}
+
+void scl_tx_queue_deinit(void)
+{
+#if (SCL_TX_WMM_ENABLE)
+    scl_tx_buf_t tx_buf;
+    struct scl_tx_queue *queue = NULL;
+    uint32_t state;
+    uint32_t id;
+    bool found;
+
+    if (!scl_tx_drain_inited) {
+        return;
+    }
+    if (cy_rtos_terminate_thread(&scl_tx_drain_thread) == CY_RSLT_SUCCESS) {
+        (void) cy_rtos_join_thread(&scl_tx_drain_thread);
+    }
+    (void) cy_rtos_deinit_semaphore(&scl_tx_drain_ready);
+    scl_tx_drain_inited = false;
+    for (id = 0; id < SCL_TX_QUEUE_MAX; id++) {
+        (void) cy_rtos_deinit_semaphore(&scl_tx_queues[id].room);
+    }
+    /* The frames left in the queues are not sent anymore */
+    while (SCL_TRUE) {
+        state = cyhal_system_critical_section_enter();
+        found = scl_tx_dequeue(&tx_buf, &queue);
+        if (found) {
+            queue->stats.dropped++;
+        }
+        cyhal_system_critical_section_exit(state);
+        if (!found) {
+            break;
+        }
+        scl_tx_credit_return();
+        scl_buffer_release(tx_buf.buffer, SCL_NETWORK_TX);
+    }
+#endif
+}
+
+scl_bool_t scl_tx_queue_is_idle(void)
+{
+#if (SCL_TX_WMM_ENABLE)
+    return (scl_tx_queued_frames == 0) ? SCL_TRUE : SCL_FALSE;
+#else
+    return SCL_TRUE;
+#endif
+}
+
+scl_result_t scl_tx_queue_send(scl_tx_buf_t *tx_buf, uint32_t timeout)
+{
+#if (SCL_TX_WMM_ENABLE)
+    struct scl_tx_queue *queue;
+    cy_time_t start = 0;
+    cy_time_t now = 0;
+    uint32_t elapsed = 0;
+    uint32_t state;
+
+    if ((tx_buf == NULL) || (tx_buf->buffer == NULL)) {
+        return SCL_BADARG;
+    }
+    if (!scl_tx_drain_inited) {
+        return SCL_ERROR;
+    }
+    if (timeout == SCL_SEND_TIMEOUT_DEFAULT) {
+        timeout = TIMER_DEFAULT_VALUE;
+    }
+    queue = &scl_tx_queues[scl_tx_classify(tx_buf)];
+    /* The queue keeps its own reference, the drain thread may send the frame as soon as it is queued */
+    scl_buffer_ref(tx_buf->buffer);
+    cy_rtos_get_time(&start);
+    state = cyhal_system_critical_section_enter();
+    /* A full queue holds the caller back as long as the frame may wait for the channel */
+    while ((queue->count == SCL_TX_QUEUE_DEPTH) && (elapsed < timeout)) {
+        queue->waiters++;
+        cyhal_system_critical_section_exit(state);
+        (void) cy_rtos_get_semaphore(&queue->room, timeout - elapsed, SCL_FALSE);
+        cy_rtos_get_time(&now);
+        elapsed = (uint32_t) (now - start);
+        state = cyhal_system_critical_section_enter();
+        queue->waiters--;
+    }
+    if (queue->count == SCL_TX_QUEUE_DEPTH) {
+        queue->stats.dropped++;
+        cyhal_system_critical_section_exit(state);
+        scl_buffer_release(tx_buf->buffer, SCL_NETWORK_TX);
+        scl_stats_count(SCL_STATS_TX_DROPPED);
+        return SCL_BUFFER_UNAVAILABLE_TEMPORARY;
+    }
+    queue->frame[(queue->head + queue->count) % SCL_TX_QUEUE_DEPTH] = *tx_buf;
+    queue->count++;
+    queue->stats.queued++;
+    if (queue->count > queue->stats.max_depth) {
+        queue->stats.max_depth = queue->count;
+    }
+    scl_tx_queued_frames++;
+    cyhal_system_critical_section_exit(state);
+
+    (void) cy_rtos_set_semaphore(&scl_tx_drain_ready, SCL_FALSE);
+    return SCL_SUCCESS;
+#else
+    UNUSED_PARAMETER(tx_buf);
+    UNUSED_PARAMETER(timeout);
+    return SCL_UNSUPPORTED;
+#endif
+}
+
+scl_result_t scl_tx_queue_get_stats(scl_tx_queue_id_t queue, scl_tx_queue_stats_t *stats)
+{
+#if (SCL_TX_WMM_ENABLE)
+    uint32_t state;
+
+    if ((stats == NULL) || (queue >= SCL_TX_QUEUE_MAX)) {
+        return SCL_BADARG;
+    }
+    state = cyhal_system_critical_section_enter();
+    *stats = scl_tx_queues[queue].stats;
+    cyhal_system_critical_section_exit(state);
+    return SCL_SUCCESS;
+#else
+    UNUSED_PARAMETER(queue);
+    UNUSED_PARAMETER(stats);
+    return SCL_UNSUPPORTED;
+#endif
+}
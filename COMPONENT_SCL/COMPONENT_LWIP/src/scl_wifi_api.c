@@ -19,7 +19,11 @@
 #include "scl_ipc.h"
 #include "scl_types.h"
 #include "string.h"
+#include "stddef.h"
 #include "scl_buffer_api.h"
+#include "scl_tx_queue.h"
+#include "scl_rx_input.h"
+#include "scl_ipc_stats.h"
 /******************************************************
  *        Variables Definitions
  *****************************************************/
@@ -112,10 +116,11 @@ scl_result_t scl_wifi_is_ready_to_transceive(void)
     scl_result_t result = SCL_SUCCESS;
     scl_result_t retval = SCL_SUCCESS;
 
-    result = scl_send_data(SCL_TX_TRANSCEIVE_READY, (char *)&retval, TIMER_DEFAULT_VALUE);
-    if (result == SCL_ERROR) {
+    result = scl_send_command(SCL_TX_TRANSCEIVE_READY, &retval, sizeof(retval), SCL_COMMAND_NO_RESULT, 0,
+                              SCL_SEND_TIMEOUT_DEFAULT);
+    if (result != SCL_SUCCESS) {
         SCL_LOG(("Ready to tranceive error\r\n"));
-        return SCL_ERROR;
+        return result;
     } else {
         return retval;
     }
@@ -125,8 +130,9 @@ bool scl_wifi_on(void)
 {
     bool retval = false;
     scl_result_t result = SCL_SUCCESS;
-    result = scl_send_data(SCL_TX_WIFI_ON, (char *)&retval, WIFI_ON_TIMEOUT);
-    if (result == SCL_ERROR) {
+    result = scl_send_command(SCL_TX_WIFI_ON, &retval, sizeof(retval), SCL_COMMAND_NO_RESULT, 0,
+                              SCL_SEND_TIMEOUT_DEFAULT);
+    if (result != SCL_SUCCESS) {
         SCL_LOG(("wifi_on Error\r\n"));
         return false;
     } else {
@@ -138,7 +144,8 @@ scl_result_t scl_wifi_set_up(void)
 {
     scl_result_t retval = SCL_SUCCESS;
     scl_result_t result = SCL_SUCCESS;
-    result = scl_send_data(SCL_TX_WIFI_SET_UP, (char *)&retval, TIMER_DEFAULT_VALUE);
+    result = scl_send_command(SCL_TX_WIFI_SET_UP, &retval, sizeof(retval), SCL_COMMAND_NO_RESULT, 0,
+                              SCL_SEND_TIMEOUT_DEFAULT);
     if (result == SCL_SUCCESS) {
         return retval;
     } else {
@@ -157,7 +164,8 @@ scl_result_t scl_wifi_get_mac_address(scl_mac_t *mac)
     if (mac == NULL) {
         return SCL_BADARG;
     }
-    scl_retval = scl_send_data(SCL_TX_GET_MAC, (char *)&scl_mac_data, TIMER_DEFAULT_VALUE);
+    scl_retval = scl_send_command(SCL_TX_GET_MAC, &scl_mac_data, sizeof(scl_mac_data), offsetof(scl_mac, mac),
+                                  sizeof(scl_mac_t), SCL_SEND_TIMEOUT_DEFAULT);
     if (scl_retval == SCL_SUCCESS) {
         return scl_mac_data.retval;
     } else {
@@ -178,7 +186,8 @@ scl_result_t scl_wifi_get_bssid(scl_mac_t *bssid)
     if (bssid == NULL) {
         return SCL_BADARG;
     }
-    scl_retval = scl_send_data(SCL_TX_WIFI_GET_BSSID, (char *)&scl_bssid_t, TIMER_DEFAULT_VALUE);
+    scl_retval = scl_send_command(SCL_TX_WIFI_GET_BSSID, &scl_bssid_t, sizeof(scl_bssid_t),
+                                  offsetof(struct scl_bssid, bssid), sizeof(scl_mac_t), SCL_SEND_TIMEOUT_DEFAULT);
     if (scl_retval == SCL_SUCCESS) {
         return scl_bssid_t.retval;
     } else {
@@ -196,7 +205,8 @@ scl_result_t scl_wifi_register_multicast_address(scl_mac_t *mac)
     if (mac == NULL) {
         return SCL_BADARG;
     }
-    scl_retval = scl_send_data(SCL_TX_REGISTER_MULTICAST_ADDRESS, (char *)&scl_mac_t, TIMER_DEFAULT_VALUE);
+    scl_retval = scl_send_command(SCL_TX_REGISTER_MULTICAST_ADDRESS, &scl_mac_t, sizeof(scl_mac_t),
+                                  offsetof(scl_mac, mac), sizeof(*mac), SCL_SEND_TIMEOUT_DEFAULT);
     if (scl_retval != SCL_SUCCESS) {
         SCL_LOG(("Register Multicast Address IPC Error\r\n"));
         return SCL_ERROR;
@@ -205,12 +215,41 @@ scl_result_t scl_wifi_register_multicast_address(scl_mac_t *mac)
 }
 
 scl_result_t scl_network_send_ethernet_data(scl_tx_buf_t scl_buffer)
+{
+    /* The priority of the buffer is not set by the callers of this function */
+    return scl_network_send_ethernet_data_prio(scl_buffer, 0);
+}
+
+scl_result_t scl_network_send_ethernet_data_prio(scl_tx_buf_t scl_buffer, uint32_t priority)
 {
     scl_result_t retval = SCL_SUCCESS;
-    if (scl_buffer.buffer == NULL) {
+    uint32_t timeout = SCL_SEND_TIMEOUT_DEFAULT;
+
+    if ((scl_buffer.buffer == NULL) || (priority > SCL_MAX_USER_PRIORITY)) {
         return SCL_BADARG;
     }
-    retval = scl_send_data(SCL_TX_SEND_OUT, (char *)&scl_buffer, TIMER_DEFAULT_VALUE);
+    scl_buffer.priority = priority;
+#if (SCL_RX_DIRECT_INPUT_ENABLE)
+    /* lwIP sends from the SCL thread under the core lock, see SCL_RX_DIRECT_INPUT_ENABLE */
+    if (scl_is_scl_thread() == SCL_TRUE) {
+        timeout = SCL_RX_DIRECT_TX_TIMEOUT;
+    }
+#endif
+    /* Without a credit NP cannot take the frame, the stack retries from the resume callback */
+    retval = scl_tx_credit_take();
+    if (retval != SCL_SUCCESS) {
+        /* Not a drop, the frame stays with the caller */
+        scl_stats_count(SCL_STATS_FLOW_CONTROLLED);
+        return retval;
+    }
+#if (SCL_TX_WMM_ENABLE)
+    retval = scl_tx_queue_send(&scl_buffer, timeout);
+#else
+    retval = scl_send_data(SCL_TX_SEND_OUT, (char *)&scl_buffer, timeout);
+#endif
+    if (retval != SCL_SUCCESS) {
+        scl_tx_credit_return();
+    }
     return retval;
 }
 
@@ -226,7 +265,8 @@ scl_result_t scl_wifi_get_rssi(int32_t *rssi)
         return SCL_BADARG;
     }
     tx_param_t.get_rssi = rssi;
-    scl_retval = scl_send_data(SCL_TX_WIFI_GET_RSSI, (char *) &tx_param_t, TIMER_DEFAULT_VALUE);
+    scl_retval = scl_send_command(SCL_TX_WIFI_GET_RSSI, &tx_param_t, sizeof(tx_param_t),
+                                  offsetof(struct tx_param, get_rssi), sizeof(int32_t), SCL_SEND_TIMEOUT_DEFAULT);
     if (scl_retval == SCL_SUCCESS) {
         return tx_param_t.retval;
     } else {
@@ -265,7 +305,8 @@ uint32_t scl_wifi_scan(scl_scan_type_t scan_type,
     g_user_data = user_data;
     scan_callback = callback;
     /* send scan parameters to NP*/
-    retval = scl_send_data(SCL_TX_SCAN, (char *)&scl_scan_parameters_for_np, TIMER_DEFAULT_VALUE);
+    retval = scl_send_command(SCL_TX_SCAN, &scl_scan_parameters_for_np, sizeof(scl_scan_parameters_for_np),
+                              SCL_COMMAND_NO_RESULT, 0, SCL_SEND_TIMEOUT_DEFAULT);
     return retval;
 }
 
@@ -287,7 +328,8 @@ uint32_t scl_wifi_get_bss_info(scl_wl_bss_info_t *bi) {
     scl_result_t retval = SCL_SUCCESS;
     scl_bss_info_t scl_bss_info;
     scl_bss_info.bss_info = bi;
-    retval = scl_send_data(SCL_TX_GET_BSS_INFO, (char *)&scl_bss_info, TIMER_DEFAULT_VALUE);
+    retval = scl_send_command(SCL_TX_GET_BSS_INFO, &scl_bss_info, sizeof(scl_bss_info),
+                              offsetof(scl_bss_info_t, bss_info), sizeof(scl_wl_bss_info_t), SCL_SEND_TIMEOUT_DEFAULT);
     if (retval == SCL_SUCCESS) {
         return scl_bss_info.retval;
     }
@@ -302,7 +344,8 @@ uint32_t scl_wifi_set_ioctl_value(uint32_t ioctl, uint32_t value) {
     scl_ioctl_value_t scl_ioctl_value;
     scl_ioctl_value.ioctl = ioctl;
     scl_ioctl_value.value = value;
-    retval = scl_send_data(SCL_TX_SET_IOCTL_VALUE, (char *)&scl_ioctl_value, TIMER_DEFAULT_VALUE);
+    retval = scl_send_command(SCL_TX_SET_IOCTL_VALUE, &scl_ioctl_value, sizeof(scl_ioctl_value),
+                              SCL_COMMAND_NO_RESULT, 0, SCL_SEND_TIMEOUT_DEFAULT);
     return retval;
 }
 
@@ -314,7 +357,8 @@ uint32_t scl_wifi_join(const scl_ssid_t *ssid, scl_security_t auth_type,
     network_credentials_for_np.auth_type = scl_to_nsapi_security(auth_type);
     network_credentials_for_np.security_key = security_key;
     network_credentials_for_np.key_length = key_length;
-    retval = scl_send_data(SCL_TX_WIFI_JOIN, (char *)&network_credentials_for_np, TIMER_DEFAULT_VALUE);
+    retval = scl_send_command(SCL_TX_WIFI_JOIN, &network_credentials_for_np, sizeof(network_credentials_for_np),
+                              SCL_COMMAND_NO_RESULT, 0, SCL_SEND_TIMEOUT_DEFAULT);
 
     return retval;
     
@@ -323,7 +367,8 @@ uint32_t scl_wifi_join(const scl_ssid_t *ssid, scl_security_t auth_type,
 scl_result_t scl_wifi_leave(void) {
     scl_result_t retval = SCL_SUCCESS;
     char dummy_variable;
-    retval = scl_send_data(SCL_TX_DISCONNECT, &dummy_variable, TIMER_DEFAULT_VALUE);
+    retval = scl_send_command(SCL_TX_DISCONNECT, &dummy_variable, sizeof(dummy_variable), SCL_COMMAND_NO_RESULT, 0,
+                              SCL_SEND_TIMEOUT_DEFAULT);
 
     return retval;
     
@@ -0,0 +1,182 @@
+/*
+ * Copyright 2018-2020 Cypress Semiconductor Corporation
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ *  Provides the setup of the SCL host benchmarks: emulated Network Processor, SCL, lwIP and
+ *  the lwIP interface of SCL, which hands frames to scl_network_send_ethernet_data() and takes
+ *  them from scl_network_process_ethernet_data() like the network glue of a target build
+ */
+#include "scl_bench.h"
+#include "scl_wifi_api.h"
+#include "scl_buffer_api.h"
+#include "scl_rx_input.h"
+#include "cyabs_rtos.h"
+#include "lwip/tcpip.h"
+#include "lwip/netif.h"
+#include "lwip/etharp.h"
+#include "lwip/ethip6.h"
+#include "netif/ethernet.h"
+#include <string.h>
+#include <time.h>
+
+/******************************************************
+ *        Variables Definitions
+ *****************************************************/
+static struct netif scl_bench_netif;
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+
+/** Hands a frame from lwIP to SCL */
+static err_t scl_bench_linkoutput(struct netif *netif, struct pbuf *p)
+{
+    scl_tx_buf_t tx_buf;
+
+    (void) netif;
+    tx_buf.buffer = p;
+    tx_buf.size = p->tot_len;
+    tx_buf.priority = 0;
+    /* SCL takes its own reference on p if it keeps it, lwIP frees p when this returns */
+    if (scl_network_send_ethernet_data(tx_buf) != SCL_SUCCESS) {
+        return ERR_IF;
+    }
+    return ERR_OK;
+}
+
+void scl_network_process_ethernet_data(scl_buffer_t buffer)
+{
+    struct pbuf *p = (struct pbuf *) buffer;
+
+    if (scl_bench_netif.input(p, &scl_bench_netif) != ERR_OK) {
+        pbuf_free(p);
+    }
+}
+
+static err_t scl_bench_netif_init(struct netif *netif)
+{
+    scl_mac_t mac;
+
+    if (scl_wifi_get_mac_address(&mac) != SCL_SUCCESS) {
+        return ERR_IF;
+    }
+    netif->name[0] = 'w';
+    netif->name[1] = 'l';
+    netif->output = etharp_output;
+#if LWIP_IPV6
+    netif->output_ip6 = ethip6_output;
+#endif
+    netif->linkoutput = scl_bench_linkoutput;
+    netif->mtu = SCL_PAYLOAD_MTU;
+    netif->hwaddr_len = ETH_HWADDR_LEN;
+    memcpy(netif->hwaddr, mac.octet, ETH_HWADDR_LEN);
+    netif->flags = NETIF_FLAG_BROADCAST | NETIF_FLAG_ETHARP | NETIF_FLAG_ETHERNET;
+    return ERR_OK;
+}
+
+static void scl_bench_tcpip_ready(void *arg)
+{
+    cy_rtos_set_semaphore((cy_semaphore_t *) arg, false);
+}
+
+scl_result_t scl_bench_start(uint32_t turnaround_us)
+{
+    scl_np_emu_config_t config = {
+        .mac = SCL_BENCH_CP_MAC,
+        .rssi = -40,
+        .loopback = SCL_FALSE,
+        .turnaround_us = turnaround_us,
+        .tx_callback = scl_bench_peer_input,
+        .tx_user_data = NULL,
+        .aggregation = SCL_TRUE,
+        .tx_ring = SCL_TRUE,
+        .rx_ring = SCL_TRUE
+    };
+    const scl_mac_t peer_mac = SCL_BENCH_PEER_MAC;
+    struct eth_addr peer_eth;
+    ip4_addr_t address;
+    ip4_addr_t netmask;
+    ip4_addr_t gateway;
+    ip4_addr_t peer;
+    cy_semaphore_t ready;
+    scl_result_t result;
+    err_t err;
+
+    result = scl_np_emu_start(&config);
+    if (result != SCL_SUCCESS) {
+        return result;
+    }
+    result = scl_init();
+    if (result != SCL_SUCCESS) {
+        return result;
+    }
+
+    cy_rtos_init_semaphore(&ready, 1, 0);
+    tcpip_init(scl_bench_tcpip_ready, &ready);
+    cy_rtos_get_semaphore(&ready, CY_RTOS_NEVER_TIMEOUT, false);
+    cy_rtos_deinit_semaphore(&ready);
+
+    ip4_addr_set_u32(&address, lwip_htonl(SCL_BENCH_CP_IP));
+    ip4_addr_set_u32(&netmask, lwip_htonl(0xFFFFFF00UL));
+    ip4_addr_set_u32(&gateway, lwip_htonl(SCL_BENCH_PEER_IP));
+    ip4_addr_set_u32(&peer, lwip_htonl(SCL_BENCH_PEER_IP));
+    memcpy(peer_eth.addr, peer_mac.octet, ETH_HWADDR_LEN);
+
+    LOCK_TCPIP_CORE();
+    if (netif_add(&scl_bench_netif, &address, &netmask, &gateway, NULL, scl_bench_netif_init, tcpip_input) == NULL) {
+        UNLOCK_TCPIP_CORE();
+        return SCL_ERROR;
+    }
+    netif_set_default(&scl_bench_netif);
+    netif_set_up(&scl_bench_netif);
+    netif_set_link_up(&scl_bench_netif);
+    /* Fed by the SCL thread when SCL_RX_DIRECT_INPUT_ENABLE is set, through tcpip_input otherwise */
+    (void) scl_rx_set_direct_input(&scl_bench_netif);
+    /* The peer does not answer ARP */
+    err = etharp_add_static_entry(&peer, &peer_eth);
+    UNLOCK_TCPIP_CORE();
+    return (err == ERR_OK) ? SCL_SUCCESS : SCL_ERROR;
+}
+
+void scl_bench_stop(void)
+{
+    scl_np_emu_stop();
+}
+
+/** Reads a clock in nanoseconds */
+static uint64_t scl_bench_clock_ns(clockid_t clock)
+{
+    struct timespec time;
+
+    clock_gettime(clock, &time);
+    return (uint64_t) time.tv_sec * 1000000000ULL + (uint64_t) time.tv_nsec;
+}
+
+uint64_t scl_bench_now_ns(void)
+{
+    return scl_bench_clock_ns(CLOCK_MONOTONIC);
+}
+
+void scl_bench_sample(scl_bench_sample_t *sample)
+{
+    sample->wall_ns = scl_bench_clock_ns(CLOCK_MONOTONIC);
+    sample->process_cpu_ns = scl_bench_clock_ns(CLOCK_PROCESS_CPUTIME_ID);
+    sample->thread_cpu_ns = scl_bench_clock_ns(CLOCK_THREAD_CPUTIME_ID);
+    scl_get_stats(&sample->scl);
+    scl_np_emu_get_stats(&sample->np);
+    scl_bench_peer_get_stats(&sample->peer);
+}
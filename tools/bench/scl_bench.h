@@ -0,0 +1,130 @@
+/*
+ * Copyright 2018-2020 Cypress Semiconductor Corporation
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ *  Provides the common parts of the SCL host benchmarks.
+ *
+ *  The benchmarks run SCL and lwIP on the host against the emulated Network Processor.
+ *  The lwIP interface of SCL has address SCL_BENCH_CP_IP; the peer stands for the remote host
+ *  behind the Network Processor, with address SCL_BENCH_PEER_IP. It sinks the UDP and TCP
+ *  traffic sent by SCL and sources UDP traffic towards SCL.
+ */
+#ifndef INCLUDED_SCL_BENCH_H_
+#define INCLUDED_SCL_BENCH_H_
+
+#include "scl_common.h"
+#include "scl_ipc.h"
+#include "scl_np_emu.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/******************************************************
+*                      Macros
+******************************************************/
+#define SCL_BENCH_CP_IP               (0xC0A80001UL)  /**< 192.168.0.1, lwIP interface of SCL */
+#define SCL_BENCH_PEER_IP             (0xC0A80002UL)  /**< 192.168.0.2, peer behind the Network Processor */
+#define SCL_BENCH_CP_MAC              {{0x02, 0x00, 0x00, 0x00, 0x00, 0x01}}
+#define SCL_BENCH_PEER_MAC            {{0x02, 0x00, 0x00, 0x00, 0x00, 0x02}}
+#define SCL_BENCH_UDP_PORT            (5001)          /**< UDP port of the sink on either side */
+#define SCL_BENCH_TCP_PORT            (5001)          /**< TCP port of the peer sink */
+#define SCL_BENCH_UDP_HEADERS         (14 + 20 + 8)   /**< Ethernet, IPv4 and UDP headers */
+#define SCL_BENCH_TCP_HEADERS         (14 + 20 + 20)  /**< Ethernet, IPv4 and TCP headers */
+#define SCL_BENCH_MAX_PAYLOAD         (1472)          /**< Largest UDP payload in one Ethernet frame */
+
+/******************************************************
+*             Structures and Enumerations
+******************************************************/
+/**
+ * Counters of the peer, for the traffic it sank or sent
+ */
+typedef struct {
+    uint64_t udp_bytes;             /**< UDP payload received from SCL */
+    uint32_t udp_packets;           /**< UDP datagrams received from SCL */
+    uint64_t tcp_bytes;             /**< TCP payload received in order from SCL */
+    uint32_t tcp_segments;          /**< TCP segments carrying data received from SCL */
+    uint32_t tcp_out_of_order;      /**< TCP segments not at the expected sequence number */
+    uint32_t sent;                  /**< Frames injected towards SCL */
+} scl_bench_peer_stats_t;
+
+/**
+ * Snapshot of the counters and clocks a measurement is computed from
+ */
+typedef struct {
+    uint64_t wall_ns;               /**< Monotonic time */
+    uint64_t process_cpu_ns;        /**< CPU time of the process */
+    uint64_t thread_cpu_ns;         /**< CPU time of the calling thread, the traffic generator */
+    scl_stats_t scl;                /**< SCL data-plane counters */
+    scl_np_emu_stats_t np;          /**< Emulated Network Processor counters */
+    scl_bench_peer_stats_t peer;    /**< Peer counters */
+} scl_bench_sample_t;
+
+/******************************************************
+*             Function Prototypes
+******************************************************/
+/** Starts the emulated Network Processor with the peer, SCL, lwIP and the lwIP interface of SCL
+ *
+ *  @param   turnaround_us   Time spent by the Network Processor on each command, see scl_np_emu_config_t.
+ *
+ *  @return  SCL_SUCCESS or an error code
+ */
+scl_result_t scl_bench_start(uint32_t turnaround_us);
+
+/** Stops the emulated Network Processor */
+void scl_bench_stop(void);
+
+/** Sets the MSS announced by the peer on the next TCP connection
+ *
+ *  @param   mss      Maximum segment size, limits the TCP frames sent by SCL.
+ */
+void scl_bench_peer_set_mss(uint16_t mss);
+
+/** Sends one UDP datagram from the peer to SCL_BENCH_UDP_PORT of SCL
+ *
+ *  @param   length   Payload length, up to SCL_BENCH_MAX_PAYLOAD.
+ *
+ *  @return  SCL_SUCCESS, SCL_BADARG or SCL_ERROR if the emulator does not take the frame
+ */
+scl_result_t scl_bench_peer_send_udp(uint32_t length);
+
+/** Reads the counters of the peer
+ *
+ *  @param   stats    Receives the counters.
+ */
+void scl_bench_peer_get_stats(scl_bench_peer_stats_t *stats);
+
+/** Receives the SCL_TX_SEND_OUT frames from the emulated Network Processor, see scl_np_emu_tx_callback_t */
+void scl_bench_peer_input(const uint8_t *frame, uint32_t length, void *user_data);
+
+/** Takes a snapshot of the counters and clocks
+ *
+ *  @param   sample   Receives the snapshot.
+ */
+void scl_bench_sample(scl_bench_sample_t *sample);
+
+/** Returns the monotonic time in nanoseconds */
+uint64_t scl_bench_now_ns(void);
+
+#ifdef __cplusplus
+} /*extern "C" */
+#endif
+
+#endif /* ifndef INCLUDED_SCL_BENCH_H_ */
@@ -0,0 +1,308 @@
+/*
+ * Copyright 2018-2020 Cypress Semiconductor Corporation
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ *  Measures scl_send_data() under contention from several producer threads on the host.
+ *
+ *  Usage: scl_bench_contention [-t seconds] [-p producers,producers,...] [-s size] [-n turnaround_us] [-c]
+ *
+ *  For each number of producers, the threads call scl_send_data() back to back, first with
+ *  SCL_TX_SEND_OUT frames of the given size and then with SCL_TX_WIFI_GET_RSSI commands:
+ *    frame    scl_send_data(SCL_TX_SEND_OUT)      buffer from scl_host_buffer_get()
+ *    rssi     scl_wifi_get_rssi()                  SCL_TX_WIFI_GET_RSSI
+ *  It reports the calls per second, the calls that did not return SCL_SUCCESS, the calls counted
+ *  by scl_get_send_timeouts(), the lock failures counted in scl_stats_t and the longest call in
+ *  microseconds. The TX buffer of a frame is taken before the call is timed, and no call is made
+ *  when none is available.
+ *
+ *  -c prints the results as CSV.
+ */
+#include "scl_bench.h"
+#include "scl_wifi_api.h"
+#include "scl_buffer_api.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/******************************************************
+ **                      Macros
+ *******************************************************/
+#define SCL_BENCH_MAX_PRODUCERS    (64)
+#define SCL_BENCH_MAX_COUNTS       (16)
+/* Time (in ms) a producer waits for a TX buffer */
+#define SCL_BENCH_BUFFER_WAIT_MS   (100)
+
+/******************************************************
+ *             Structures and Enumerations
+ ******************************************************/
+/* Structure of a measurement result
+ *   workload:             "frame" or "rssi"
+ *   producers:            number of producer threads
+ *   rate:                 calls completed per second, by all producers
+ *   failures:             calls that did not return SCL_SUCCESS
+ *   timeouts:             calls counted by scl_get_send_timeouts()
+ *   lock_failures:        requests not sent because the IPC lock or a TX lock was not acquired
+ *   max:                  longest call in microseconds
+ */
+typedef struct {
+    char workload[8];
+    uint32_t producers;
+    double rate;
+    uint32_t failures;
+    uint32_t timeouts;
+    uint32_t lock_failures;
+    double max;
+} scl_bench_result_t;
+
+/* Structure of a producer thread
+ *   thread:               thread calling scl_send_data()
+ *   calls:                calls made
+ *   failures:             calls that did not return SCL_SUCCESS
+ *   max_ns:               longest call
+ */
+typedef struct {
+    pthread_t thread;
+    uint32_t calls;
+    uint32_t failures;
+    uint64_t max_ns;
+} scl_bench_producer_t;
+
+/* Structure of the run shared by the producers
+ *   start:                releases the producers together
+ *   index:                SCL_TX_SEND_OUT or SCL_TX_WIFI_GET_RSSI
+ *   size:                 size of the frames
+ *   stop:                 set to stop the producers
+ */
+static struct {
+    pthread_barrier_t start;
+    int index;
+    uint32_t size;
+    volatile bool stop;
+} scl_bench_run_info;
+
+static scl_bench_producer_t scl_bench_producers[SCL_BENCH_MAX_PRODUCERS];
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+
+/** Sends one frame through scl_send_data() */
+static scl_result_t scl_bench_frame(scl_buffer_t buffer)
+{
+    scl_tx_buf_t tx_buf;
+
+    tx_buf.buffer = buffer;
+    tx_buf.size = scl_bench_run_info.size;
+    tx_buf.priority = 0;
+    return scl_send_data(SCL_TX_SEND_OUT, (char *) &tx_buf, SCL_SEND_TIMEOUT_DEFAULT);
+}
+
+static scl_result_t scl_bench_rssi(void)
+{
+    int32_t rssi;
+
+    return scl_wifi_get_rssi(&rssi);
+}
+
+/** Calls scl_send_data() back to back until stopped */
+static void *scl_bench_producer(void *arg)
+{
+    scl_bench_producer_t *producer = (scl_bench_producer_t *) arg;
+    scl_buffer_t buffer = NULL;
+    scl_result_t retval;
+    uint64_t start;
+    uint64_t elapsed;
+
+    pthread_barrier_wait(&scl_bench_run_info.start);
+    while (!scl_bench_run_info.stop) {
+        if (scl_bench_run_info.index == SCL_TX_SEND_OUT) {
+            if (scl_host_buffer_get(&buffer, SCL_NETWORK_TX, (uint16_t) scl_bench_run_info.size,
+                                    SCL_BENCH_BUFFER_WAIT_MS) != SCL_SUCCESS) {
+                continue;
+            }
+            memset(scl_buffer_get_current_piece_data_pointer(buffer), 0, scl_bench_run_info.size);
+        }
+        start = scl_bench_now_ns();
+        retval = (buffer != NULL) ? scl_bench_frame(buffer) : scl_bench_rssi();
+        elapsed = scl_bench_now_ns() - start;
+        if (buffer != NULL) {
+            scl_buffer_release(buffer, SCL_NETWORK_TX);
+            buffer = NULL;
+        }
+        producer->calls++;
+        if (retval != SCL_SUCCESS) {
+            producer->failures++;
+        }
+        if (elapsed > producer->max_ns) {
+            producer->max_ns = elapsed;
+        }
+    }
+    return NULL;
+}
+
+/** Runs the producers for the given time and computes the contention figures */
+static bool scl_bench_contention(scl_bench_result_t *result, const char *workload, int index, uint32_t producers,
+                                 double seconds)
+{
+    scl_stats_t stats_start;
+    scl_stats_t stats_end;
+    uint32_t timeouts_start = 0;
+    uint32_t timeouts_end = 0;
+    uint64_t start;
+    uint64_t calls = 0;
+    uint64_t max_ns = 0;
+    uint32_t started;
+    uint32_t i;
+
+    memset(result, 0, sizeof(*result));
+    memset(scl_bench_producers, 0, sizeof(scl_bench_producers));
+    scl_bench_run_info.index = index;
+    scl_bench_run_info.stop = false;
+    if (pthread_barrier_init(&scl_bench_run_info.start, NULL, producers + 1) != 0) {
+        return false;
+    }
+    for (started = 0; started < producers; started++) {
+        if (pthread_create(&scl_bench_producers[started].thread, NULL, scl_bench_producer,
+                           &scl_bench_producers[started]) != 0) {
+            break;
+        }
+    }
+    if (started < producers) {
+        /* The barrier cannot be released without every producer, abandon the run */
+        fprintf(stderr, "producer %u not started\n", (unsigned) started);
+        exit(1);
+    }
+
+    (void) scl_get_stats(&stats_start);
+    (void) scl_get_send_timeouts(index, &timeouts_start);
+    pthread_barrier_wait(&scl_bench_run_info.start);
+    start = scl_bench_now_ns();
+    usleep((useconds_t) (seconds * 1e6));
+    scl_bench_run_info.stop = true;
+    for (i = 0; i < producers; i++) {
+        pthread_join(scl_bench_producers[i].thread, NULL);
+        calls += scl_bench_producers[i].calls;
+        result->failures += scl_bench_producers[i].failures;
+        if (scl_bench_producers[i].max_ns > max_ns) {
+            max_ns = scl_bench_producers[i].max_ns;
+        }
+    }
+    result->rate = (double) calls * 1e9 / (double) (scl_bench_now_ns() - start);
+    (void) scl_get_stats(&stats_end);
+    (void) scl_get_send_timeouts(index, &timeouts_end);
+    pthread_barrier_destroy(&scl_bench_run_info.start);
+
+    snprintf(result->workload, sizeof(result->workload), "%s", workload);
+    result->producers = producers;
+    result->timeouts = timeouts_end - timeouts_start;
+    result->lock_failures = stats_end.lock_failures - stats_start.lock_failures;
+    result->max = max_ns / 1e3;
+    return true;
+}
+
+static void scl_bench_print(const scl_bench_result_t *result, bool csv)
+{
+    if (csv) {
+        printf("%s,%u,%.1f,%u,%u,%u,%.1f\n", result->workload, (unsigned) result->producers, result->rate,
+               (unsigned) result->failures, (unsigned) result->timeouts, (unsigned) result->lock_failures,
+               result->max);
+        return;
+    }
+    printf("%-6s %9u %10.0f %8u %8u %8u %10.1f\n", result->workload, (unsigned) result->producers, result->rate,
+           (unsigned) result->failures, (unsigned) result->timeouts, (unsigned) result->lock_failures, result->max);
+}
+
+static void scl_bench_usage(const char *name)
+{
+    fprintf(stderr, "usage: %s [-t seconds] [-p producers,producers,...] [-s size] [-n turnaround_us] [-c]\n", name);
+}
+
+int main(int argc, char *argv[])
+{
+    static const uint32_t default_counts[] = { 1, 2, 4, 8, 16 };
+    scl_bench_result_t result;
+    uint32_t counts[SCL_BENCH_MAX_COUNTS];
+    uint32_t count_number = 0;
+    uint32_t turnaround_us = 0;
+    uint32_t i;
+    double seconds = 2.0;
+    bool csv = false;
+    char *token;
+    int option;
+
+    scl_bench_run_info.size = 256;
+    while ((option = getopt(argc, argv, "t:p:s:n:c")) != -1) {
+        switch (option) {
+            case 't':
+                seconds = atof(optarg);
+                break;
+            case 'p':
+                for (token = strtok(optarg, ","); (token != NULL) && (count_number < SCL_BENCH_MAX_COUNTS);
+                     token = strtok(NULL, ",")) {
+                    counts[count_number] = (uint32_t) strtoul(token, NULL, 0);
+                    if ((counts[count_number] == 0) || (counts[count_number] > SCL_BENCH_MAX_PRODUCERS)) {
+                        fprintf(stderr, "producers %s out of 1..%u\n", token, SCL_BENCH_MAX_PRODUCERS);
+                        return 1;
+                    }
+                    count_number++;
+                }
+                break;
+            case 's':
+                scl_bench_run_info.size = (uint32_t) strtoul(optarg, NULL, 0);
+                if ((scl_bench_run_info.size == 0) ||
+                    (scl_bench_run_info.size > SCL_BENCH_MAX_PAYLOAD + SCL_BENCH_UDP_HEADERS)) {
+                    fprintf(stderr, "size %s out of 1..%u\n", optarg, SCL_BENCH_MAX_PAYLOAD + SCL_BENCH_UDP_HEADERS);
+                    return 1;
+                }
+                break;
+            case 'n':
+                turnaround_us = (uint32_t) strtoul(optarg, NULL, 0);
+                break;
+            case 'c':
+                csv = true;
+                break;
+            default:
+                scl_bench_usage(argv[0]);
+                return 1;
+        }
+    }
+    if (count_number == 0) {
+        count_number = sizeof(default_counts) / sizeof(default_counts[0]);
+        memcpy(counts, default_counts, sizeof(default_counts));
+    }
+
+    if (scl_bench_start(turnaround_us) != SCL_SUCCESS) {
+        fprintf(stderr, "SCL setup failed\n");
+        return 1;
+    }
+    if (!csv) {
+        printf("%-6s %9s %10s %8s %8s %8s %10s\n", "work", "producers", "calls/s", "failures", "timeouts",
+               "lockfail", "max_us");
+    }
+    for (i = 0; i < count_number; i++) {
+        if (scl_bench_contention(&result, "frame", SCL_TX_SEND_OUT, counts[i], seconds)) {
+            scl_bench_print(&result, csv);
+        }
+        if (scl_bench_contention(&result, "rssi", SCL_TX_WIFI_GET_RSSI, counts[i], seconds)) {
+            scl_bench_print(&result, csv);
+        }
+    }
+    scl_bench_stop();
+    return 0;
+}
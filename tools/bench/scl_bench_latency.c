@@ -0,0 +1,378 @@
+/*
+ * Copyright 2018-2020 Cypress Semiconductor Corporation
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ *  Measures the round-trip latency of SCL control commands on the host.
+ *
+ *  Usage: scl_bench_latency [-i iterations] [-l load_size] [-n turnaround_us] [-c] [-b baseline.csv]
+ *
+ *  Each command is issued through its public API, back to back, first on an idle link and then
+ *  while UDP traffic of load_size bytes flows in both directions between lwIP and the peer:
+ *    rssi     scl_wifi_get_rssi()                  SCL_TX_WIFI_GET_RSSI
+ *    mac      scl_wifi_get_mac_address()           SCL_TX_GET_MAC
+ *    ready    scl_wifi_is_ready_to_transceive()    SCL_TX_TRANSCEIVE_READY
+ *    ioctl    scl_wifi_set_ioctl_value()           SCL_TX_SET_IOCTL_VALUE
+ *  and the min, p50, p99 and max round trip in microseconds are reported.
+ *
+ *  -c prints the results as CSV. Saved CSV output given to -b adds the change of p50 and p99
+ *  against that baseline.
+ */
+#include "scl_bench.h"
+#include "scl_wifi_api.h"
+#include "lwip/tcpip.h"
+#include "lwip/udp.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/******************************************************
+ **                      Macros
+ *******************************************************/
+#define SCL_BENCH_COMMANDS         (4)
+#define SCL_BENCH_MAX_RESULTS      (2 * SCL_BENCH_COMMANDS)
+/* Frames queued by the peer towards SCL before it waits, see scl_bench_throughput.c */
+#define SCL_BENCH_RX_WINDOW        (32)
+/* WLC_SET_PM, answered by the emulator like any IOCTL */
+#define SCL_BENCH_IOCTL            (86)
+
+/******************************************************
+ *             Structures and Enumerations
+ ******************************************************/
+/* Structure of a measurement result
+ *   command:              name of the command
+ *   load:                 "idle" or "load"
+ *   count:                round trips measured
+ *   errors:               calls that did not return SCL_SUCCESS
+ *   min, p50, p99, max:   round trip in microseconds
+ */
+typedef struct {
+    char command[8];
+    char load[8];
+    uint32_t count;
+    uint32_t errors;
+    double min;
+    double p50;
+    double p99;
+    double max;
+} scl_bench_result_t;
+
+/* Structure of the background traffic
+ *   pcb:                  UDP socket sending to the peer and sinking its datagrams
+ *   size:                 payload size of the datagrams
+ *   stop:                 set to stop the traffic threads
+ */
+static struct {
+    struct udp_pcb *pcb;
+    uint32_t size;
+    volatile bool stop;
+} scl_bench_load_info;
+
+static uint8_t scl_bench_data[SCL_BENCH_MAX_PAYLOAD];
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+
+static void scl_bench_sleep_us(uint32_t us)
+{
+    struct timespec delay = { .tv_sec = us / 1000000U, .tv_nsec = (long) (us % 1000000U) * 1000L };
+
+    nanosleep(&delay, NULL);
+}
+
+static scl_result_t scl_bench_rssi(uint32_t i)
+{
+    int32_t rssi;
+
+    (void) i;
+    return scl_wifi_get_rssi(&rssi);
+}
+
+static scl_result_t scl_bench_mac(uint32_t i)
+{
+    scl_mac_t mac;
+
+    (void) i;
+    return scl_wifi_get_mac_address(&mac);
+}
+
+static scl_result_t scl_bench_ready(uint32_t i)
+{
+    (void) i;
+    return scl_wifi_is_ready_to_transceive();
+}
+
+static scl_result_t scl_bench_ioctl(uint32_t i)
+{
+    return (scl_result_t) scl_wifi_set_ioctl_value(SCL_BENCH_IOCTL, i & 1);
+}
+
+static const struct {
+    const char *name;
+    scl_result_t (*call)(uint32_t i);
+} scl_bench_commands[SCL_BENCH_COMMANDS] = {
+    { "rssi", scl_bench_rssi },
+    { "mac", scl_bench_mac },
+    { "ready", scl_bench_ready },
+    { "ioctl", scl_bench_ioctl }
+};
+
+static void scl_bench_udp_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *addr, u16_t port)
+{
+    (void) arg;
+    (void) pcb;
+    (void) addr;
+    (void) port;
+    pbuf_free(p);
+}
+
+/** Sends UDP datagrams from lwIP to the peer until stopped */
+static void *scl_bench_load_tx(void *arg)
+{
+    struct pbuf *p;
+    ip_addr_t peer;
+
+    (void) arg;
+    IP_ADDR4(&peer, (SCL_BENCH_PEER_IP >> 24) & 0xFF, (SCL_BENCH_PEER_IP >> 16) & 0xFF,
+             (SCL_BENCH_PEER_IP >> 8) & 0xFF, SCL_BENCH_PEER_IP & 0xFF);
+    while (!scl_bench_load_info.stop) {
+        p = pbuf_alloc(PBUF_TRANSPORT, (u16_t) scl_bench_load_info.size, PBUF_RAM);
+        if (p == NULL) {
+            scl_bench_sleep_us(100);
+            continue;
+        }
+        memcpy(p->payload, scl_bench_data, scl_bench_load_info.size);
+        LOCK_TCPIP_CORE();
+        (void) udp_sendto(scl_bench_load_info.pcb, p, &peer, SCL_BENCH_UDP_PORT);
+        UNLOCK_TCPIP_CORE();
+        pbuf_free(p);
+    }
+    return NULL;
+}
+
+/** Sends UDP datagrams from the peer to lwIP until stopped */
+static void *scl_bench_load_rx(void *arg)
+{
+    scl_np_emu_stats_t np;
+
+    (void) arg;
+    while (!scl_bench_load_info.stop) {
+        scl_np_emu_get_stats(&np);
+        if (np.rx_pending >= SCL_BENCH_RX_WINDOW) {
+            scl_bench_sleep_us(20);
+            continue;
+        }
+        (void) scl_bench_peer_send_udp(scl_bench_load_info.size);
+    }
+    return NULL;
+}
+
+static int scl_bench_compare(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *) a;
+    uint64_t y = *(const uint64_t *) b;
+
+    return (x > y) - (x < y);
+}
+
+/** Issues one command repeatedly and computes its round-trip distribution */
+static void scl_bench_measure(scl_bench_result_t *result, uint32_t command, const char *load,
+                              uint64_t *samples, uint32_t iterations)
+{
+    uint64_t start;
+    uint32_t i;
+
+    memset(result, 0, sizeof(*result));
+    snprintf(result->command, sizeof(result->command), "%s", scl_bench_commands[command].name);
+    snprintf(result->load, sizeof(result->load), "%s", load);
+    for (i = 0; i < iterations; i++) {
+        start = scl_bench_now_ns();
+        if (scl_bench_commands[command].call(i) != SCL_SUCCESS) {
+            result->errors++;
+        }
+        samples[i] = scl_bench_now_ns() - start;
+    }
+    qsort(samples, iterations, sizeof(samples[0]), scl_bench_compare);
+    result->count = iterations;
+    result->min = samples[0] / 1e3;
+    result->p50 = samples[(iterations - 1) / 2] / 1e3;
+    result->p99 = samples[(iterations * 99 + 99) / 100 - 1] / 1e3;
+    result->max = samples[iterations - 1] / 1e3;
+}
+
+/** Reads the results saved with -c
+ *
+ *  @return  number of results read
+ */
+static uint32_t scl_bench_load(const char *path, scl_bench_result_t *results, uint32_t max)
+{
+    char line[256];
+    uint32_t count = 0;
+    FILE *file;
+
+    file = fopen(path, "r");
+    if (file == NULL) {
+        perror(path);
+        return 0;
+    }
+    while ((count < max) && (fgets(line, sizeof(line), file) != NULL)) {
+        if (sscanf(line, "%7[^,],%7[^,],%u,%u,%lf,%lf,%lf,%lf", results[count].command, results[count].load,
+                   &results[count].count, &results[count].errors, &results[count].min, &results[count].p50,
+                   &results[count].p99, &results[count].max) == 8) {
+            count++;
+        }
+    }
+    fclose(file);
+    return count;
+}
+
+static const scl_bench_result_t *scl_bench_find(const scl_bench_result_t *results, uint32_t count,
+                                                const scl_bench_result_t *result)
+{
+    uint32_t i;
+
+    for (i = 0; i < count; i++) {
+        if ((strcmp(results[i].command, result->command) == 0) && (strcmp(results[i].load, result->load) == 0)) {
+            return &results[i];
+        }
+    }
+    return NULL;
+}
+
+static double scl_bench_change(double value, double baseline)
+{
+    return (baseline != 0) ? ((value - baseline) * 100 / baseline) : 0;
+}
+
+static void scl_bench_print(const scl_bench_result_t *result, bool csv, const scl_bench_result_t *baseline)
+{
+    if (csv) {
+        printf("%s,%s,%u,%u,%.2f,%.2f,%.2f,%.2f\n", result->command, result->load, (unsigned) result->count,
+               (unsigned) result->errors, result->min, result->p50, result->p99, result->max);
+        return;
+    }
+    printf("%-7s %-5s %8u %6u %9.1f %9.1f %9.1f %9.1f", result->command, result->load, (unsigned) result->count,
+           (unsigned) result->errors, result->min, result->p50, result->p99, result->max);
+    if (baseline != NULL) {
+        printf(" %+8.1f%% %+8.1f%%", scl_bench_change(result->p50, baseline->p50),
+               scl_bench_change(result->p99, baseline->p99));
+    }
+    printf("\n");
+}
+
+static void scl_bench_usage(const char *name)
+{
+    fprintf(stderr, "usage: %s [-i iterations] [-l load_size] [-n turnaround_us] [-c] [-b baseline.csv]\n", name);
+}
+
+int main(int argc, char *argv[])
+{
+    scl_bench_result_t baseline[SCL_BENCH_MAX_RESULTS];
+    scl_bench_result_t result;
+    pthread_t load_threads[2];
+    uint32_t baseline_count = 0;
+    uint32_t turnaround_us = 0;
+    uint32_t iterations = 10000;
+    uint32_t command;
+    uint32_t i;
+    uint64_t *samples;
+    bool csv = false;
+    int option;
+
+    scl_bench_load_info.size = 1024;
+    while ((option = getopt(argc, argv, "i:l:n:cb:")) != -1) {
+        switch (option) {
+            case 'i':
+                iterations = (uint32_t) strtoul(optarg, NULL, 0);
+                break;
+            case 'l':
+                scl_bench_load_info.size = (uint32_t) strtoul(optarg, NULL, 0);
+                break;
+            case 'n':
+                turnaround_us = (uint32_t) strtoul(optarg, NULL, 0);
+                break;
+            case 'c':
+                csv = true;
+                break;
+            case 'b':
+                baseline_count = scl_bench_load(optarg, baseline, SCL_BENCH_MAX_RESULTS);
+                break;
+            default:
+                scl_bench_usage(argv[0]);
+                return 1;
+        }
+    }
+    if ((iterations == 0) || (scl_bench_load_info.size == 0) || (scl_bench_load_info.size > SCL_BENCH_MAX_PAYLOAD)) {
+        scl_bench_usage(argv[0]);
+        return 1;
+    }
+    samples = (uint64_t *) malloc(iterations * sizeof(samples[0]));
+    if (samples == NULL) {
+        return 1;
+    }
+    for (i = 0; i < sizeof(scl_bench_data); i++) {
+        scl_bench_data[i] = (uint8_t) i;
+    }
+
+    if (scl_bench_start(turnaround_us) != SCL_SUCCESS) {
+        fprintf(stderr, "SCL setup failed\n");
+        return 1;
+    }
+    LOCK_TCPIP_CORE();
+    scl_bench_load_info.pcb = udp_new();
+    if (scl_bench_load_info.pcb != NULL) {
+        (void) udp_bind(scl_bench_load_info.pcb, IP_ANY_TYPE, SCL_BENCH_UDP_PORT);
+        udp_recv(scl_bench_load_info.pcb, scl_bench_udp_recv, NULL);
+    }
+    UNLOCK_TCPIP_CORE();
+    if (scl_bench_load_info.pcb == NULL) {
+        fprintf(stderr, "UDP setup failed\n");
+        return 1;
+    }
+
+    if (!csv) {
+        printf("%-7s %-5s %8s %6s %9s %9s %9s %9s%s\n", "command", "load", "count", "errors", "min us", "p50 us",
+               "p99 us", "max us", (baseline_count > 0) ? "      p50       p99" : "");
+    }
+    for (command = 0; command < SCL_BENCH_COMMANDS; command++) {
+        scl_bench_measure(&result, command, "idle", samples, iterations);
+        scl_bench_print(&result, csv, scl_bench_find(baseline, baseline_count, &result));
+    }
+
+    scl_bench_load_info.stop = false;
+    if ((pthread_create(&load_threads[0], NULL, scl_bench_load_tx, NULL) != 0) ||
+        (pthread_create(&load_threads[1], NULL, scl_bench_load_rx, NULL) != 0)) {
+        fprintf(stderr, "traffic threads not started\n");
+        return 1;
+    }
+    /* Let the traffic reach its steady state */
+    scl_bench_sleep_us(100000);
+    for (command = 0; command < SCL_BENCH_COMMANDS; command++) {
+        scl_bench_measure(&result, command, "load", samples, iterations);
+        scl_bench_print(&result, csv, scl_bench_find(baseline, baseline_count, &result));
+    }
+    scl_bench_load_info.stop = true;
+    pthread_join(load_threads[0], NULL);
+    pthread_join(load_threads[1], NULL);
+
+    free(samples);
+    scl_bench_stop();
+    return 0;
+}
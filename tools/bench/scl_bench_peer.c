@@ -0,0 +1,324 @@
+/*
+ * Copyright 2018-2020 Cypress Semiconductor Corporation
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ *  Provides the peer of the SCL host benchmarks: the remote host behind the emulated Network Processor.
+ *
+ *  It counts the UDP datagrams sent by SCL, acknowledges the TCP segments sent by SCL as a
+ *  minimal receiver (one connection, in-order data only, fixed window) and builds the UDP
+ *  datagrams sent to SCL. Frames are built and parsed by hand, without a network stack.
+ */
+#include "scl_bench.h"
+#include <pthread.h>
+#include <string.h>
+
+/******************************************************
+ **                      Macros
+ *******************************************************/
+#define SCL_BENCH_ETH_HEADER       (14)
+#define SCL_BENCH_IP_HEADER        (20)
+#define SCL_BENCH_UDP_HEADER       (8)
+#define SCL_BENCH_TCP_HEADER       (20)
+#define SCL_BENCH_TCP_MSS_OPTION   (4)
+#define SCL_BENCH_ETHERTYPE_IPV4   (0x0800)
+#define SCL_BENCH_PROTO_TCP        (6)
+#define SCL_BENCH_PROTO_UDP        (17)
+#define SCL_BENCH_TCP_FIN          (0x01)
+#define SCL_BENCH_TCP_SYN          (0x02)
+#define SCL_BENCH_TCP_RST          (0x04)
+#define SCL_BENCH_TCP_ACK          (0x10)
+#define SCL_BENCH_TCP_WINDOW       (0xFFFF)
+#define SCL_BENCH_TCP_ISS          (0x10000000UL)
+
+/******************************************************
+ *        Variables Definitions
+ *****************************************************/
+/* Structure of SCL bench peer info
+ *   lock:                 protects the fields below
+ *   stats:                counters
+ *   mss:                  MSS announced on the next connection
+ *   tcp_open:             set while a connection from SCL is open
+ *   tcp_port:             port of SCL on the open connection
+ *   rcv_nxt:              next sequence number expected from SCL
+ *   snd_nxt:              next sequence number of the peer
+ *   ip_id:                identification of the next IPv4 packet
+ */
+static struct {
+    pthread_mutex_t lock;
+    scl_bench_peer_stats_t stats;
+    uint16_t mss;
+    bool tcp_open;
+    uint16_t tcp_port;
+    uint32_t rcv_nxt;
+    uint32_t snd_nxt;
+    uint16_t ip_id;
+} scl_bench_peer_info = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .mss = SCL_BENCH_MAX_PAYLOAD + SCL_BENCH_UDP_HEADER - SCL_BENCH_TCP_HEADER
+};
+
+static const scl_mac_t scl_bench_cp_mac = SCL_BENCH_CP_MAC;
+static const scl_mac_t scl_bench_peer_mac = SCL_BENCH_PEER_MAC;
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+
+static uint16_t scl_bench_get16(const uint8_t *data)
+{
+    return (uint16_t) ((data[0] << 8) | data[1]);
+}
+
+static uint32_t scl_bench_get32(const uint8_t *data)
+{
+    return ((uint32_t) data[0] << 24) | ((uint32_t) data[1] << 16) | ((uint32_t) data[2] << 8) | data[3];
+}
+
+static void scl_bench_put16(uint8_t *data, uint16_t value)
+{
+    data[0] = (uint8_t) (value >> 8);
+    data[1] = (uint8_t) value;
+}
+
+static void scl_bench_put32(uint8_t *data, uint32_t value)
+{
+    data[0] = (uint8_t) (value >> 24);
+    data[1] = (uint8_t) (value >> 16);
+    data[2] = (uint8_t) (value >> 8);
+    data[3] = (uint8_t) value;
+}
+
+/** Adds data to a ones' complement sum */
+static uint32_t scl_bench_sum(uint32_t sum, const uint8_t *data, uint32_t length)
+{
+    while (length > 1) {
+        sum += scl_bench_get16(data);
+        data += 2;
+        length -= 2;
+    }
+    if (length != 0) {
+        sum += (uint32_t) data[0] << 8;
+    }
+    return sum;
+}
+
+/** Folds a ones' complement sum into a checksum */
+static uint16_t scl_bench_checksum(uint32_t sum)
+{
+    while (sum >> 16) {
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    }
+    return (uint16_t) ~sum;
+}
+
+/** Writes the Ethernet and IPv4 headers of a frame from the peer to SCL
+ *
+ *  @return  the transport header
+ */
+static uint8_t *scl_bench_ip_header(uint8_t *frame, uint8_t protocol, uint32_t transport_length)
+{
+    uint8_t *ip = frame + SCL_BENCH_ETH_HEADER;
+
+    memcpy(frame, scl_bench_cp_mac.octet, sizeof(scl_bench_cp_mac.octet));
+    memcpy(frame + 6, scl_bench_peer_mac.octet, sizeof(scl_bench_peer_mac.octet));
+    scl_bench_put16(frame + 12, SCL_BENCH_ETHERTYPE_IPV4);
+
+    memset(ip, 0, SCL_BENCH_IP_HEADER);
+    ip[0] = 0x45;
+    scl_bench_put16(ip + 2, (uint16_t) (SCL_BENCH_IP_HEADER + transport_length));
+    scl_bench_put16(ip + 4, scl_bench_peer_info.ip_id++);
+    scl_bench_put16(ip + 6, 0x4000);
+    ip[8] = 64;
+    ip[9] = protocol;
+    scl_bench_put32(ip + 12, SCL_BENCH_PEER_IP);
+    scl_bench_put32(ip + 16, SCL_BENCH_CP_IP);
+    scl_bench_put16(ip + 10, scl_bench_checksum(scl_bench_sum(0, ip, SCL_BENCH_IP_HEADER)));
+    return ip + SCL_BENCH_IP_HEADER;
+}
+
+/** Returns the sum of the IPv4 pseudo header of a packet from the peer to SCL */
+static uint32_t scl_bench_pseudo_sum(uint8_t protocol, uint32_t transport_length)
+{
+    return (SCL_BENCH_PEER_IP >> 16) + (SCL_BENCH_PEER_IP & 0xFFFF) +
+           (SCL_BENCH_CP_IP >> 16) + (SCL_BENCH_CP_IP & 0xFFFF) + protocol + transport_length;
+}
+
+/** Sends a TCP segment without data to SCL, called with the lock held */
+static void scl_bench_tcp_reply(uint8_t flags)
+{
+    uint8_t frame[SCL_BENCH_ETH_HEADER + SCL_BENCH_IP_HEADER + SCL_BENCH_TCP_HEADER + SCL_BENCH_TCP_MSS_OPTION];
+    uint32_t length = SCL_BENCH_TCP_HEADER;
+    uint8_t *tcp;
+
+    if (flags & SCL_BENCH_TCP_SYN) {
+        length += SCL_BENCH_TCP_MSS_OPTION;
+    }
+    tcp = scl_bench_ip_header(frame, SCL_BENCH_PROTO_TCP, length);
+    memset(tcp, 0, length);
+    scl_bench_put16(tcp, SCL_BENCH_TCP_PORT);
+    scl_bench_put16(tcp + 2, scl_bench_peer_info.tcp_port);
+    scl_bench_put32(tcp + 4, scl_bench_peer_info.snd_nxt);
+    scl_bench_put32(tcp + 8, scl_bench_peer_info.rcv_nxt);
+    tcp[12] = (uint8_t) ((length / 4) << 4);
+    tcp[13] = flags;
+    scl_bench_put16(tcp + 14, SCL_BENCH_TCP_WINDOW);
+    if (flags & SCL_BENCH_TCP_SYN) {
+        tcp[20] = 2;
+        tcp[21] = SCL_BENCH_TCP_MSS_OPTION;
+        scl_bench_put16(tcp + 22, scl_bench_peer_info.mss);
+    }
+    scl_bench_put16(tcp + 16, scl_bench_checksum(scl_bench_sum(scl_bench_pseudo_sum(SCL_BENCH_PROTO_TCP, length),
+                                                               tcp, length)));
+    if (scl_np_emu_inject_frame(frame, SCL_BENCH_ETH_HEADER + SCL_BENCH_IP_HEADER + length) == SCL_SUCCESS) {
+        scl_bench_peer_info.stats.sent++;
+    }
+}
+
+/** Handles a TCP segment from SCL to the peer sink, called with the lock held */
+static void scl_bench_tcp_input(const uint8_t *tcp, uint32_t length)
+{
+    uint32_t header;
+    uint32_t seq;
+    uint32_t data;
+    uint8_t flags;
+
+    if ((length < SCL_BENCH_TCP_HEADER) || (scl_bench_get16(tcp + 2) != SCL_BENCH_TCP_PORT)) {
+        return;
+    }
+    header = (uint32_t) (tcp[12] >> 4) * 4;
+    if ((header < SCL_BENCH_TCP_HEADER) || (header > length)) {
+        return;
+    }
+    flags = tcp[13];
+    seq = scl_bench_get32(tcp + 4);
+    data = length - header;
+
+    if (flags & SCL_BENCH_TCP_RST) {
+        scl_bench_peer_info.tcp_open = false;
+        return;
+    }
+    if (flags & SCL_BENCH_TCP_SYN) {
+        scl_bench_peer_info.tcp_open = true;
+        scl_bench_peer_info.tcp_port = scl_bench_get16(tcp);
+        scl_bench_peer_info.rcv_nxt = seq + 1;
+        scl_bench_peer_info.snd_nxt = SCL_BENCH_TCP_ISS;
+        scl_bench_tcp_reply(SCL_BENCH_TCP_SYN | SCL_BENCH_TCP_ACK);
+        scl_bench_peer_info.snd_nxt++;
+        return;
+    }
+    if (!scl_bench_peer_info.tcp_open || (scl_bench_get16(tcp) != scl_bench_peer_info.tcp_port)) {
+        return;
+    }
+    if ((data == 0) && !(flags & SCL_BENCH_TCP_FIN)) {
+        /* Pure ACK, the peer never has data in flight */
+        return;
+    }
+    if (seq != scl_bench_peer_info.rcv_nxt) {
+        /* Retransmission or segment after a loss, the duplicate ACK asks for the expected one */
+        scl_bench_peer_info.stats.tcp_out_of_order++;
+        scl_bench_tcp_reply(SCL_BENCH_TCP_ACK);
+        return;
+    }
+    scl_bench_peer_info.rcv_nxt += data;
+    if (data != 0) {
+        scl_bench_peer_info.stats.tcp_bytes += data;
+        scl_bench_peer_info.stats.tcp_segments++;
+    }
+    if (flags & SCL_BENCH_TCP_FIN) {
+        scl_bench_peer_info.rcv_nxt++;
+        scl_bench_tcp_reply(SCL_BENCH_TCP_FIN | SCL_BENCH_TCP_ACK);
+        scl_bench_peer_info.snd_nxt++;
+        scl_bench_peer_info.tcp_open = false;
+        return;
+    }
+    scl_bench_tcp_reply(SCL_BENCH_TCP_ACK);
+}
+
+void scl_bench_peer_input(const uint8_t *frame, uint32_t length, void *user_data)
+{
+    const uint8_t *ip;
+    uint32_t ip_header;
+    uint32_t ip_length;
+
+    (void) user_data;
+    if ((length < SCL_BENCH_ETH_HEADER + SCL_BENCH_IP_HEADER) ||
+        (scl_bench_get16(frame + 12) != SCL_BENCH_ETHERTYPE_IPV4)) {
+        return;
+    }
+    ip = frame + SCL_BENCH_ETH_HEADER;
+    ip_header = (uint32_t) (ip[0] & 0x0F) * 4;
+    ip_length = scl_bench_get16(ip + 2);
+    if (((ip[0] >> 4) != 4) || (ip_header < SCL_BENCH_IP_HEADER) || (ip_length < ip_header) ||
+        (ip_length > length - SCL_BENCH_ETH_HEADER) || (scl_bench_get32(ip + 16) != SCL_BENCH_PEER_IP)) {
+        return;
+    }
+
+    pthread_mutex_lock(&scl_bench_peer_info.lock);
+    if (ip[9] == SCL_BENCH_PROTO_UDP) {
+        if ((ip_length - ip_header >= SCL_BENCH_UDP_HEADER) &&
+            (scl_bench_get16(ip + ip_header + 2) == SCL_BENCH_UDP_PORT)) {
+            scl_bench_peer_info.stats.udp_bytes += ip_length - ip_header - SCL_BENCH_UDP_HEADER;
+            scl_bench_peer_info.stats.udp_packets++;
+        }
+    } else if (ip[9] == SCL_BENCH_PROTO_TCP) {
+        scl_bench_tcp_input(ip + ip_header, ip_length - ip_header);
+    }
+    pthread_mutex_unlock(&scl_bench_peer_info.lock);
+}
+
+scl_result_t scl_bench_peer_send_udp(uint32_t length)
+{
+    uint8_t frame[SCL_BENCH_UDP_HEADERS + SCL_BENCH_MAX_PAYLOAD];
+    uint8_t *udp;
+    uint16_t checksum;
+    scl_result_t result;
+
+    if ((length == 0) || (length > SCL_BENCH_MAX_PAYLOAD)) {
+        return SCL_BADARG;
+    }
+    pthread_mutex_lock(&scl_bench_peer_info.lock);
+    udp = scl_bench_ip_header(frame, SCL_BENCH_PROTO_UDP, SCL_BENCH_UDP_HEADER + length);
+    scl_bench_put16(udp, SCL_BENCH_UDP_PORT);
+    scl_bench_put16(udp + 2, SCL_BENCH_UDP_PORT);
+    scl_bench_put16(udp + 4, (uint16_t) (SCL_BENCH_UDP_HEADER + length));
+    scl_bench_put16(udp + 6, 0);
+    memset(udp + SCL_BENCH_UDP_HEADER, (int) (scl_bench_peer_info.stats.sent & 0xFF), length);
+    checksum = scl_bench_checksum(scl_bench_sum(scl_bench_pseudo_sum(SCL_BENCH_PROTO_UDP, SCL_BENCH_UDP_HEADER + length),
+                                                udp, SCL_BENCH_UDP_HEADER + length));
+    /* A zero UDP checksum means none */
+    scl_bench_put16(udp + 6, (checksum == 0) ? 0xFFFF : checksum);
+    result = scl_np_emu_inject_frame(frame, SCL_BENCH_UDP_HEADERS + length);
+    if (result == SCL_SUCCESS) {
+        scl_bench_peer_info.stats.sent++;
+    }
+    pthread_mutex_unlock(&scl_bench_peer_info.lock);
+    return result;
+}
+
+void scl_bench_peer_set_mss(uint16_t mss)
+{
+    pthread_mutex_lock(&scl_bench_peer_info.lock);
+    scl_bench_peer_info.mss = mss;
+    pthread_mutex_unlock(&scl_bench_peer_info.lock);
+}
+
+void scl_bench_peer_get_stats(scl_bench_peer_stats_t *stats)
+{
+    pthread_mutex_lock(&scl_bench_peer_info.lock);
+    *stats = scl_bench_peer_info.stats;
+    pthread_mutex_unlock(&scl_bench_peer_info.lock);
+}
@@ -0,0 +1,278 @@
+/*
+ * Copyright 2018-2020 Cypress Semiconductor Corporation
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ *  Measures how the SCL thread batches the RX ring on the host.
+ *
+ *  Usage: scl_bench_rx [-t seconds] [-s size] [-r rate,rate,...] [-n turnaround_us] [-c]
+ *
+ *  For each offered rate, in frames per second with 0 for as fast as SCL takes them, the peer
+ *  sends UDP datagrams of the given payload size to lwIP, first with RX interrupt moderation
+ *  disabled and then with the default moderation parameters. From scl_get_rx_stats() it reports
+ *  the frames delivered per second, the wakeups of the SCL thread per second, the average and
+ *  largest number of frames per wakeup, the share of wakeups caused by the polling interval, the
+ *  RX IPC handshakes per frame and the share of frames received in buffers pre-posted by SCL.
+ *
+ *  SCL must be built with SCL_RX_RING_ENABLE, and SCL_RX_POST_ENABLE for the pre-posted buffers;
+ *  without the RX ring the frames go through the legacy handshake and no wakeup is counted.
+ *
+ *  -c prints the results as CSV.
+ */
+#include "scl_bench.h"
+#include "lwip/tcpip.h"
+#include "lwip/udp.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/******************************************************
+ **                      Macros
+ *******************************************************/
+#define SCL_BENCH_MAX_RATES        (16)
+/* Frames queued by the peer towards SCL before it waits, see scl_bench_throughput.c */
+#define SCL_BENCH_RX_WINDOW        (32)
+/* Period at which the peer catches up with the offered rate */
+#define SCL_BENCH_TICK_US          (100)
+
+/******************************************************
+ *             Structures and Enumerations
+ ******************************************************/
+/* Structure of a measurement result
+ *   moderation:           "off" or "on"
+ *   rate:                 offered frames per second, 0 for unpaced
+ *   pps:                  frames delivered to lwIP per second
+ *   wakeups:              wakeups of the SCL thread per second
+ *   frames_per_wakeup:    average frames processed per wakeup
+ *   max_frames:           largest number of frames processed in one wakeup since SCL started
+ *   polled:               share of the wakeups caused by the polling interval, percent
+ *   handshakes:           RX IPC handshakes per frame
+ *   posted:               share of the frames received in pre-posted buffers, percent
+ */
+typedef struct {
+    char moderation[4];
+    uint32_t rate;
+    double pps;
+    double wakeups;
+    double frames_per_wakeup;
+    uint32_t max_frames;
+    double polled;
+    double handshakes;
+    double posted;
+} scl_bench_result_t;
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+
+static void scl_bench_sleep_us(uint32_t us)
+{
+    struct timespec delay = { .tv_sec = us / 1000000U, .tv_nsec = (long) (us % 1000000U) * 1000L };
+
+    nanosleep(&delay, NULL);
+}
+
+static void scl_bench_udp_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *addr, u16_t port)
+{
+    (void) arg;
+    (void) pcb;
+    (void) addr;
+    (void) port;
+    pbuf_free(p);
+}
+
+/** Waits until the emulated Network Processor has delivered all the frames queued by the peer */
+static void scl_bench_drain(void)
+{
+    scl_np_emu_stats_t np;
+
+    do {
+        scl_bench_sleep_us(1000);
+        scl_np_emu_get_stats(&np);
+    } while (np.rx_pending > 0);
+}
+
+/** Sends UDP datagrams from the peer at the offered rate and computes the RX ring figures */
+static void scl_bench_rx(scl_bench_result_t *result, const char *moderation, uint32_t rate, uint32_t size,
+                         double seconds)
+{
+    scl_bench_sample_t start;
+    scl_bench_sample_t end;
+    scl_rx_stats_t rx_start;
+    scl_rx_stats_t rx_end;
+    scl_np_emu_stats_t np;
+    uint64_t deadline;
+    uint64_t sent = 0;
+    uint64_t due;
+    uint32_t frames;
+    uint32_t wakeups;
+    uint32_t received;
+    double elapsed;
+
+    scl_bench_sample(&start);
+    (void) scl_get_rx_stats(&rx_start);
+    deadline = start.wall_ns + (uint64_t) (seconds * 1e9);
+    while (scl_bench_now_ns() < deadline) {
+        if (rate != 0) {
+            due = (scl_bench_now_ns() - start.wall_ns) * rate / 1000000000ULL;
+            if (sent >= due) {
+                scl_bench_sleep_us(SCL_BENCH_TICK_US);
+                continue;
+            }
+        }
+        scl_np_emu_get_stats(&np);
+        if (np.rx_pending >= SCL_BENCH_RX_WINDOW) {
+            scl_bench_sleep_us(20);
+            continue;
+        }
+        if (scl_bench_peer_send_udp(size) == SCL_SUCCESS) {
+            sent++;
+        }
+    }
+    scl_bench_drain();
+    scl_bench_sample(&end);
+    (void) scl_get_rx_stats(&rx_end);
+
+    elapsed = (double) (end.wall_ns - start.wall_ns) / 1e9;
+    frames = rx_end.frames - rx_start.frames;
+    wakeups = rx_end.wakeups - rx_start.wakeups;
+    received = end.np.frames_received - start.np.frames_received;
+    snprintf(result->moderation, sizeof(result->moderation), "%s", moderation);
+    result->rate = rate;
+    result->pps = (double) (end.scl.rx.packets - start.scl.rx.packets) / elapsed;
+    result->wakeups = (double) wakeups / elapsed;
+    result->frames_per_wakeup = (wakeups > 0) ? ((double) frames / wakeups) : 0;
+    result->max_frames = rx_end.max_frames_per_wakeup;
+    result->polled = (wakeups > 0) ? ((double) (rx_end.polls - rx_start.polls) * 100 / wakeups) : 0;
+    result->handshakes = (received > 0) ? ((double) (end.np.rx_messages - start.np.rx_messages) / received) : 0;
+    result->posted = (received > 0) ?
+                     ((double) (end.np.posted_buffers - start.np.posted_buffers) * 100 / received) : 0;
+}
+
+static void scl_bench_print(const scl_bench_result_t *result, bool csv)
+{
+    if (csv) {
+        printf("%s,%u,%.1f,%.1f,%.2f,%u,%.1f,%.3f,%.1f\n", result->moderation, (unsigned) result->rate,
+               result->pps, result->wakeups, result->frames_per_wakeup, (unsigned) result->max_frames,
+               result->polled, result->handshakes, result->posted);
+        return;
+    }
+    printf("%-4s %8u %9.0f %9.0f %9.2f %7u %7.1f%% %8.3f %7.1f%%\n", result->moderation, (unsigned) result->rate,
+           result->pps, result->wakeups, result->frames_per_wakeup, (unsigned) result->max_frames,
+           result->polled, result->handshakes, result->posted);
+}
+
+static void scl_bench_usage(const char *name)
+{
+    fprintf(stderr, "usage: %s [-t seconds] [-s size] [-r rate,rate,...] [-n turnaround_us] [-c]\n", name);
+}
+
+int main(int argc, char *argv[])
+{
+    static const uint32_t default_rates[] = { 1000, 10000, 50000, 0 };
+    static const scl_rx_moderation_config_t moderation_off = { 0 };
+    static const scl_rx_moderation_config_t moderation_on = {
+        .poll_interval_ms = SCL_RX_POLL_INTERVAL_MS,
+        .high_threshold = SCL_RX_MODERATION_HIGH,
+        .low_threshold = SCL_RX_MODERATION_LOW,
+        .idle_polls = SCL_RX_MODERATION_IDLE_POLLS
+    };
+    scl_bench_result_t result;
+    struct udp_pcb *pcb;
+    uint32_t rates[SCL_BENCH_MAX_RATES];
+    uint32_t rate_count = 0;
+    uint32_t size = 64;
+    uint32_t turnaround_us = 0;
+    uint32_t i;
+    double seconds = 2.0;
+    bool csv = false;
+    char *token;
+    int option;
+
+    while ((option = getopt(argc, argv, "t:s:r:n:c")) != -1) {
+        switch (option) {
+            case 't':
+                seconds = atof(optarg);
+                break;
+            case 's':
+                size = (uint32_t) strtoul(optarg, NULL, 0);
+                if ((size == 0) || (size > SCL_BENCH_MAX_PAYLOAD)) {
+                    fprintf(stderr, "size %s out of 1..%u\n", optarg, SCL_BENCH_MAX_PAYLOAD);
+                    return 1;
+                }
+                break;
+            case 'r':
+                for (token = strtok(optarg, ","); (token != NULL) && (rate_count < SCL_BENCH_MAX_RATES);
+                     token = strtok(NULL, ",")) {
+                    rates[rate_count++] = (uint32_t) strtoul(token, NULL, 0);
+                }
+                break;
+            case 'n':
+                turnaround_us = (uint32_t) strtoul(optarg, NULL, 0);
+                break;
+            case 'c':
+                csv = true;
+                break;
+            default:
+                scl_bench_usage(argv[0]);
+                return 1;
+        }
+    }
+    if (rate_count == 0) {
+        rate_count = sizeof(default_rates) / sizeof(default_rates[0]);
+        memcpy(rates, default_rates, sizeof(default_rates));
+    }
+
+    if (scl_bench_start(turnaround_us) != SCL_SUCCESS) {
+        fprintf(stderr, "SCL setup failed\n");
+        return 1;
+    }
+    LOCK_TCPIP_CORE();
+    pcb = udp_new();
+    if ((pcb != NULL) && (udp_bind(pcb, IP_ANY_TYPE, SCL_BENCH_UDP_PORT) == ERR_OK)) {
+        udp_recv(pcb, scl_bench_udp_recv, NULL);
+    }
+    UNLOCK_TCPIP_CORE();
+    if (pcb == NULL) {
+        fprintf(stderr, "UDP sink setup failed\n");
+        scl_bench_stop();
+        return 1;
+    }
+
+    if (!csv) {
+        printf("%-4s %8s %9s %9s %9s %7s %8s %8s %8s\n", "mod", "rate", "pkt/s", "wakeup/s", "pkt/wake",
+               "max", "polled", "ipc/pkt", "posted");
+    }
+    for (i = 0; i < rate_count; i++) {
+        memset(&result, 0, sizeof(result));
+        (void) scl_rx_set_moderation(&moderation_off);
+        scl_bench_rx(&result, "off", rates[i], size, seconds);
+        scl_bench_print(&result, csv);
+
+        memset(&result, 0, sizeof(result));
+        (void) scl_rx_set_moderation(&moderation_on);
+        scl_bench_rx(&result, "on", rates[i], size, seconds);
+        scl_bench_print(&result, csv);
+    }
+
+    LOCK_TCPIP_CORE();
+    udp_remove(pcb);
+    UNLOCK_TCPIP_CORE();
+    scl_bench_stop();
+    return 0;
+}
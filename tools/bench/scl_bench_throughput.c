@@ -0,0 +1,479 @@
+/*
+ * Copyright 2018-2020 Cypress Semiconductor Corporation
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ *  Measures the throughput of the SCL data path on the host, iperf style.
+ *
+ *  Usage: scl_bench_throughput [-t seconds] [-s size,size,...] [-n turnaround_us] [-c] [-b baseline.csv]
+ *
+ *  For each payload size it runs:
+ *    udp-tx   UDP datagrams sent by lwIP through scl_network_send_ethernet_data() to the peer
+ *    udp-rx   UDP datagrams sent by the peer, received by lwIP through scl_network_process_ethernet_data()
+ *    tcp-tx   one TCP connection sending to the peer, which announces the payload size as MSS
+ *  and reports the payload throughput, the frames per second carried by SCL in the measured
+ *  direction, the IPC handshakes per frame carried by SCL in either direction and the CPU time
+ *  per payload byte of SCL and lwIP, without the emulated Network Processor and the peer.
+ *
+ *  -c prints the results as CSV. Saved CSV output given to -b adds the change of the throughput
+ *  and of the CPU time per byte against that baseline.
+ */
+#include "scl_bench.h"
+#include "lwip/tcpip.h"
+#include "lwip/udp.h"
+#include "lwip/tcp.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/******************************************************
+ **                      Macros
+ *******************************************************/
+#define SCL_BENCH_MAX_SIZES        (16)
+#define SCL_BENCH_MAX_RESULTS      (3 * SCL_BENCH_MAX_SIZES)
+/* Frames queued by the peer towards SCL before it waits, so that SCL is never idle nor flooded */
+#define SCL_BENCH_RX_WINDOW        (32)
+#define SCL_BENCH_TCP_MAX_MSS      (1460)
+#define SCL_BENCH_CONNECT_MS       (1000)
+
+/******************************************************
+ *             Structures and Enumerations
+ ******************************************************/
+/* Structure of a measurement result
+ *   test:                 name of the test
+ *   size:                 payload size of the frames
+ *   mbps:                 payload throughput, Mbit/s
+ *   pps:                  frames per second carried by SCL in the measured direction
+ *   handshakes:           IPC handshakes, both directions, per frame carried by SCL
+ *   ns_per_byte:          CPU time of SCL and lwIP per payload byte
+ */
+typedef struct {
+    char test[8];
+    uint32_t size;
+    double mbps;
+    double pps;
+    double handshakes;
+    double ns_per_byte;
+} scl_bench_result_t;
+
+/* Structure of the TCP sender
+ *   pcb:                  connection to the peer
+ *   connected:            set once the connection is established
+ *   failed:               set if the connection failed or was reset
+ *   deadline_ns:          time after which no more data is written
+ */
+static struct {
+    struct tcp_pcb *pcb;
+    volatile bool connected;
+    volatile bool failed;
+    uint64_t deadline_ns;
+} scl_bench_tcp_info;
+
+static uint64_t scl_bench_udp_rx_bytes;
+static uint8_t scl_bench_data[8192];
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+
+static void scl_bench_sleep_us(uint32_t us)
+{
+    struct timespec delay = { .tv_sec = us / 1000000U, .tv_nsec = (long) (us % 1000000U) * 1000L };
+
+    nanosleep(&delay, NULL);
+}
+
+/** Computes a result from the samples taken around a measurement
+ *
+ *  @param   bytes          Payload delivered.
+ *  @param   packets        Frames carried by SCL in the measured direction.
+ *  @param   peer_thread    true if the calling thread ran the peer, its CPU time is then excluded.
+ */
+static void scl_bench_result(scl_bench_result_t *result, const char *test, uint32_t size,
+                             const scl_bench_sample_t *start, const scl_bench_sample_t *end,
+                             uint64_t bytes, uint32_t packets, bool peer_thread)
+{
+    double seconds = (double) (end->wall_ns - start->wall_ns) / 1e9;
+    uint32_t frames = (end->scl.tx.packets - start->scl.tx.packets) + (end->scl.rx.packets - start->scl.rx.packets);
+    uint32_t handshakes = (end->np.commands - start->np.commands) + (end->np.rx_messages - start->np.rx_messages);
+    int64_t cpu_ns = (int64_t) (end->process_cpu_ns - start->process_cpu_ns) -
+                     (int64_t) (end->np.cpu_time_us - start->np.cpu_time_us) * 1000;
+
+    if (peer_thread) {
+        cpu_ns -= (int64_t) (end->thread_cpu_ns - start->thread_cpu_ns);
+    }
+    snprintf(result->test, sizeof(result->test), "%s", test);
+    result->size = size;
+    result->mbps = (seconds > 0) ? ((double) bytes * 8 / seconds / 1e6) : 0;
+    result->pps = (seconds > 0) ? (packets / seconds) : 0;
+    result->handshakes = (frames > 0) ? ((double) handshakes / frames) : 0;
+    result->ns_per_byte = (bytes > 0) ? ((double) (cpu_ns > 0 ? cpu_ns : 0) / (double) bytes) : 0;
+}
+
+static void scl_bench_udp_tx(scl_bench_result_t *result, uint32_t size, double seconds)
+{
+    scl_bench_sample_t start;
+    scl_bench_sample_t end;
+    struct udp_pcb *pcb;
+    struct pbuf *p;
+    ip_addr_t peer;
+    uint64_t deadline;
+
+    IP_ADDR4(&peer, (SCL_BENCH_PEER_IP >> 24) & 0xFF, (SCL_BENCH_PEER_IP >> 16) & 0xFF,
+             (SCL_BENCH_PEER_IP >> 8) & 0xFF, SCL_BENCH_PEER_IP & 0xFF);
+    LOCK_TCPIP_CORE();
+    pcb = udp_new();
+    UNLOCK_TCPIP_CORE();
+    if (pcb == NULL) {
+        return;
+    }
+
+    scl_bench_sample(&start);
+    deadline = start.wall_ns + (uint64_t) (seconds * 1e9);
+    while (scl_bench_now_ns() < deadline) {
+        p = pbuf_alloc(PBUF_TRANSPORT, (u16_t) size, PBUF_RAM);
+        if (p == NULL) {
+            scl_bench_sleep_us(100);
+            continue;
+        }
+        memcpy(p->payload, scl_bench_data, size);
+        LOCK_TCPIP_CORE();
+        (void) udp_sendto(pcb, p, &peer, SCL_BENCH_UDP_PORT);
+        UNLOCK_TCPIP_CORE();
+        pbuf_free(p);
+    }
+    scl_bench_sample(&end);
+
+    LOCK_TCPIP_CORE();
+    udp_remove(pcb);
+    UNLOCK_TCPIP_CORE();
+    scl_bench_result(result, "udp-tx", size, &start, &end, end.peer.udp_bytes - start.peer.udp_bytes,
+                     end.scl.tx.packets - start.scl.tx.packets, false);
+}
+
+static void scl_bench_udp_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *addr, u16_t port)
+{
+    (void) arg;
+    (void) pcb;
+    (void) addr;
+    (void) port;
+    __atomic_fetch_add(&scl_bench_udp_rx_bytes, p->tot_len, __ATOMIC_RELAXED);
+    pbuf_free(p);
+}
+
+static void scl_bench_udp_rx(scl_bench_result_t *result, uint32_t size, double seconds)
+{
+    scl_bench_sample_t start;
+    scl_bench_sample_t end;
+    scl_np_emu_stats_t np;
+    struct udp_pcb *pcb;
+    uint64_t start_bytes;
+    uint64_t deadline;
+
+    LOCK_TCPIP_CORE();
+    pcb = udp_new();
+    if ((pcb != NULL) && (udp_bind(pcb, IP_ANY_TYPE, SCL_BENCH_UDP_PORT) == ERR_OK)) {
+        udp_recv(pcb, scl_bench_udp_recv, NULL);
+    }
+    UNLOCK_TCPIP_CORE();
+    if (pcb == NULL) {
+        return;
+    }
+
+    scl_bench_sample(&start);
+    start_bytes = __atomic_load_n(&scl_bench_udp_rx_bytes, __ATOMIC_RELAXED);
+    deadline = start.wall_ns + (uint64_t) (seconds * 1e9);
+    while (scl_bench_now_ns() < deadline) {
+        scl_np_emu_get_stats(&np);
+        if (np.rx_pending >= SCL_BENCH_RX_WINDOW) {
+            scl_bench_sleep_us(20);
+            continue;
+        }
+        (void) scl_bench_peer_send_udp(size);
+    }
+    scl_bench_sample(&end);
+    scl_bench_result(result, "udp-rx", size, &start, &end,
+                     __atomic_load_n(&scl_bench_udp_rx_bytes, __ATOMIC_RELAXED) - start_bytes,
+                     end.scl.rx.packets - start.scl.rx.packets, true);
+
+    /* Let the frames still queued drain before the next test */
+    do {
+        scl_bench_sleep_us(1000);
+        scl_np_emu_get_stats(&np);
+    } while (np.rx_pending > 0);
+    LOCK_TCPIP_CORE();
+    udp_remove(pcb);
+    UNLOCK_TCPIP_CORE();
+}
+
+/** Fills the send buffer of the TCP connection until the deadline, in the tcpip thread */
+static void scl_bench_tcp_fill(struct tcp_pcb *pcb)
+{
+    u16_t length;
+
+    if (scl_bench_now_ns() >= scl_bench_tcp_info.deadline_ns) {
+        return;
+    }
+    while ((length = tcp_sndbuf(pcb)) > 0) {
+        if (length > sizeof(scl_bench_data)) {
+            length = sizeof(scl_bench_data);
+        }
+        if (tcp_write(pcb, scl_bench_data, length, TCP_WRITE_FLAG_COPY) != ERR_OK) {
+            break;
+        }
+    }
+    (void) tcp_output(pcb);
+}
+
+static err_t scl_bench_tcp_sent(void *arg, struct tcp_pcb *pcb, u16_t length)
+{
+    (void) arg;
+    (void) length;
+    scl_bench_tcp_fill(pcb);
+    return ERR_OK;
+}
+
+static err_t scl_bench_tcp_connected(void *arg, struct tcp_pcb *pcb, err_t err)
+{
+    (void) arg;
+    (void) pcb;
+    if (err != ERR_OK) {
+        scl_bench_tcp_info.failed = true;
+    } else {
+        scl_bench_tcp_info.connected = true;
+    }
+    return ERR_OK;
+}
+
+static void scl_bench_tcp_error(void *arg, err_t err)
+{
+    (void) arg;
+    (void) err;
+    /* lwIP has freed the pcb */
+    scl_bench_tcp_info.pcb = NULL;
+    scl_bench_tcp_info.failed = true;
+}
+
+static void scl_bench_tcp_tx(scl_bench_result_t *result, uint32_t size, double seconds)
+{
+    scl_bench_sample_t start;
+    scl_bench_sample_t end;
+    ip_addr_t peer;
+    uint64_t timeout;
+
+    if (size > SCL_BENCH_TCP_MAX_MSS) {
+        return;
+    }
+    scl_bench_peer_set_mss((uint16_t) size);
+    memset(&scl_bench_tcp_info, 0, sizeof(scl_bench_tcp_info));
+    IP_ADDR4(&peer, (SCL_BENCH_PEER_IP >> 24) & 0xFF, (SCL_BENCH_PEER_IP >> 16) & 0xFF,
+             (SCL_BENCH_PEER_IP >> 8) & 0xFF, SCL_BENCH_PEER_IP & 0xFF);
+
+    LOCK_TCPIP_CORE();
+    scl_bench_tcp_info.pcb = tcp_new();
+    if (scl_bench_tcp_info.pcb != NULL) {
+        tcp_nagle_disable(scl_bench_tcp_info.pcb);
+        tcp_sent(scl_bench_tcp_info.pcb, scl_bench_tcp_sent);
+        tcp_err(scl_bench_tcp_info.pcb, scl_bench_tcp_error);
+        if (tcp_connect(scl_bench_tcp_info.pcb, &peer, SCL_BENCH_TCP_PORT, scl_bench_tcp_connected) != ERR_OK) {
+            tcp_abort(scl_bench_tcp_info.pcb);
+            scl_bench_tcp_info.pcb = NULL;
+        }
+    }
+    UNLOCK_TCPIP_CORE();
+    if (scl_bench_tcp_info.pcb == NULL) {
+        return;
+    }
+    timeout = scl_bench_now_ns() + SCL_BENCH_CONNECT_MS * 1000000ULL;
+    while (!scl_bench_tcp_info.connected && !scl_bench_tcp_info.failed && (scl_bench_now_ns() < timeout)) {
+        scl_bench_sleep_us(1000);
+    }
+
+    scl_bench_sample(&start);
+    LOCK_TCPIP_CORE();
+    if (scl_bench_tcp_info.connected && (scl_bench_tcp_info.pcb != NULL)) {
+        scl_bench_tcp_info.deadline_ns = start.wall_ns + (uint64_t) (seconds * 1e9);
+        scl_bench_tcp_fill(scl_bench_tcp_info.pcb);
+    }
+    UNLOCK_TCPIP_CORE();
+    if (scl_bench_tcp_info.deadline_ns != 0) {
+        scl_bench_sleep_us((uint32_t) (seconds * 1e6));
+    }
+    scl_bench_sample(&end);
+
+    LOCK_TCPIP_CORE();
+    if (scl_bench_tcp_info.pcb != NULL) {
+        tcp_sent(scl_bench_tcp_info.pcb, NULL);
+        tcp_err(scl_bench_tcp_info.pcb, NULL);
+        if (tcp_close(scl_bench_tcp_info.pcb) != ERR_OK) {
+            tcp_abort(scl_bench_tcp_info.pcb);
+        }
+        scl_bench_tcp_info.pcb = NULL;
+    }
+    UNLOCK_TCPIP_CORE();
+    if (!scl_bench_tcp_info.connected) {
+        fprintf(stderr, "tcp-tx %u: connection to the peer failed\n", (unsigned) size);
+        return;
+    }
+    scl_bench_result(result, "tcp-tx", size, &start, &end, end.peer.tcp_bytes - start.peer.tcp_bytes,
+                     end.scl.tx.packets - start.scl.tx.packets, false);
+}
+
+/** Reads the results saved with -c
+ *
+ *  @return  number of results read
+ */
+static uint32_t scl_bench_load(const char *path, scl_bench_result_t *results, uint32_t max)
+{
+    char line[256];
+    uint32_t count = 0;
+    FILE *file;
+
+    file = fopen(path, "r");
+    if (file == NULL) {
+        perror(path);
+        return 0;
+    }
+    while ((count < max) && (fgets(line, sizeof(line), file) != NULL)) {
+        if (sscanf(line, "%7[^,],%u,%lf,%lf,%lf,%lf", results[count].test, &results[count].size,
+                   &results[count].mbps, &results[count].pps, &results[count].handshakes,
+                   &results[count].ns_per_byte) == 6) {
+            count++;
+        }
+    }
+    fclose(file);
+    return count;
+}
+
+static const scl_bench_result_t *scl_bench_find(const scl_bench_result_t *results, uint32_t count,
+                                                const scl_bench_result_t *result)
+{
+    uint32_t i;
+
+    for (i = 0; i < count; i++) {
+        if ((strcmp(results[i].test, result->test) == 0) && (results[i].size == result->size)) {
+            return &results[i];
+        }
+    }
+    return NULL;
+}
+
+static double scl_bench_change(double value, double baseline)
+{
+    return (baseline != 0) ? ((value - baseline) * 100 / baseline) : 0;
+}
+
+static void scl_bench_print(const scl_bench_result_t *result, bool csv, const scl_bench_result_t *baseline)
+{
+    if (csv) {
+        printf("%s,%u,%.3f,%.1f,%.3f,%.3f\n", result->test, (unsigned) result->size, result->mbps,
+               result->pps, result->handshakes, result->ns_per_byte);
+        return;
+    }
+    printf("%-7s %5u %9.2f %10.0f %8.2f %9.2f", result->test, (unsigned) result->size, result->mbps,
+           result->pps, result->handshakes, result->ns_per_byte);
+    if (baseline != NULL) {
+        printf(" %+8.1f%% %+8.1f%%", scl_bench_change(result->mbps, baseline->mbps),
+               scl_bench_change(result->ns_per_byte, baseline->ns_per_byte));
+    }
+    printf("\n");
+}
+
+static void scl_bench_usage(const char *name)
+{
+    fprintf(stderr, "usage: %s [-t seconds] [-s size,size,...] [-n turnaround_us] [-c] [-b baseline.csv]\n", name);
+}
+
+int main(int argc, char *argv[])
+{
+    static const uint32_t default_sizes[] = { 64, 128, 256, 512, 1024, 1460 };
+    static void (*const tests[])(scl_bench_result_t *result, uint32_t size, double seconds) = {
+        scl_bench_udp_tx, scl_bench_udp_rx, scl_bench_tcp_tx
+    };
+    scl_bench_result_t baseline[SCL_BENCH_MAX_RESULTS];
+    scl_bench_result_t result;
+    uint32_t sizes[SCL_BENCH_MAX_SIZES];
+    uint32_t size_count = 0;
+    uint32_t baseline_count = 0;
+    uint32_t turnaround_us = 0;
+    uint32_t i;
+    uint32_t test;
+    double seconds = 2.0;
+    bool csv = false;
+    char *token;
+    int option;
+
+    while ((option = getopt(argc, argv, "t:s:n:cb:")) != -1) {
+        switch (option) {
+            case 't':
+                seconds = atof(optarg);
+                break;
+            case 's':
+                for (token = strtok(optarg, ","); (token != NULL) && (size_count < SCL_BENCH_MAX_SIZES);
+                     token = strtok(NULL, ",")) {
+                    sizes[size_count] = (uint32_t) strtoul(token, NULL, 0);
+                    if ((sizes[size_count] == 0) || (sizes[size_count] > SCL_BENCH_MAX_PAYLOAD)) {
+                        fprintf(stderr, "size %s out of 1..%u\n", token, SCL_BENCH_MAX_PAYLOAD);
+                        return 1;
+                    }
+                    size_count++;
+                }
+                break;
+            case 'n':
+                turnaround_us = (uint32_t) strtoul(optarg, NULL, 0);
+                break;
+            case 'c':
+                csv = true;
+                break;
+            case 'b':
+                baseline_count = scl_bench_load(optarg, baseline, SCL_BENCH_MAX_RESULTS);
+                break;
+            default:
+                scl_bench_usage(argv[0]);
+                return 1;
+        }
+    }
+    if (size_count == 0) {
+        size_count = sizeof(default_sizes) / sizeof(default_sizes[0]);
+        memcpy(sizes, default_sizes, sizeof(default_sizes));
+    }
+    for (i = 0; i < sizeof(scl_bench_data); i++) {
+        scl_bench_data[i] = (uint8_t) i;
+    }
+
+    if (scl_bench_start(turnaround_us) != SCL_SUCCESS) {
+        fprintf(stderr, "SCL setup failed\n");
+        return 1;
+    }
+    if (!csv) {
+        printf("%-7s %5s %9s %10s %8s %9s%s\n", "test", "size", "Mbit/s", "pkt/s", "ipc/pkt", "ns/byte",
+               (baseline_count > 0) ? "   Mbit/s  ns/byte" : "");
+    }
+    for (i = 0; i < size_count; i++) {
+        for (test = 0; test < sizeof(tests) / sizeof(tests[0]); test++) {
+            memset(&result, 0, sizeof(result));
+            tests[test](&result, sizes[i], seconds);
+            /* A test that could not run leaves the result empty */
+            if (result.test[0] != '\0') {
+                scl_bench_print(&result, csv, scl_bench_find(baseline, baseline_count, &result));
+            }
+        }
+    }
+    scl_bench_stop();
+    return 0;
+}
@@ -0,0 +1,170 @@
+#!/usr/bin/env python3
+#
+# Copyright 2018-2020 Cypress Semiconductor Corporation
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Decodes a trace written by scl_trace_dump() into a timeline.
+
+Usage: scl_trace_decode.py [--summary] trace.bin
+
+The timeline lists each event with its time relative to the first event and
+to the previous one. The summary reports the interrupt-to-thread latency
+(RX interrupt until the SCL thread reads the message) and the NP turnaround
+(request written to the IPC channel until the release interrupt) per index.
+"""
+
+import argparse
+import struct
+import sys
+
+TRACE_MAGIC = 0x544C4353
+TRACE_VERSION = 1
+HEADER = struct.Struct("<IHHII")
+ENTRY = struct.Struct("<IIHHI")
+
+# scl_trace_event_t in src/include/scl_ipc_trace.h
+EVENTS = {
+    1: "RX_ISR",
+    2: "RX_MESSAGE",
+    3: "RX_DONE",
+    4: "RX_POLL",
+    5: "RX_DESC",
+    6: "SEND",
+    7: "SEND_DONE",
+    8: "POST",
+    9: "RELEASE",
+    10: "TIMEOUT",
+}
+
+# scl_ipc_tx_t in inc/scl_common.h
+TX_INDEXES = {
+    1: "TEST_MSG", 2: "WIFI_INIT", 3: "CONFIG_PARAMETERS", 4: "GET_MAC",
+    5: "REGISTER_MULTICAST_ADDRESS", 6: "SEND_OUT", 7: "TRANSCEIVE_READY",
+    8: "WIFI_ON", 9: "WIFI_SET_UP", 10: "WIFI_NW_PARAM", 11: "WIFI_GET_RSSI",
+    12: "WIFI_GET_BSSID", 13: "CONNECT", 14: "DISCONNECT", 15: "CONNECTION_STATUS",
+    16: "SCL_VERSION_NUMBER", 17: "SCAN", 18: "GET_BSS_INFO", 19: "SET_IOCTL_VALUE",
+    20: "WIFI_JOIN", 21: "SET_EVENT_HANDLER", 22: "RING_CONFIG", 23: "RING_DOORBELL",
+    24: "TAG_CONFIG", 25: "CHANNEL_CONFIG", 26: "RX_POST_CONFIG", 27: "SG_CONFIG",
+    28: "SEND_OUT_SG", 29: "CREDIT_CONFIG", 30: "AGG_CONFIG", 31: "SEND_OUT_AGG",
+    50: "DHM_CP_REGISTER", 51: "DHM_CP_HEART_BEAT",
+}
+
+# scl_ipc_rx_t in inc/scl_common.h
+RX_INDEXES = {
+    0: "DATA", 1: "TEST_MSG", 2: "GET_BUFFER", 3: "GET_CONNECTION_STATUS",
+    4: "SCAN_STATUS", 5: "EVENT_CALLBACK", 6: "CONTROL_COMPLETE", 7: "RING_DOORBELL",
+    8: "POST_LOW", 9: "CREDIT_UPDATE", 10: "DATA_AGG",
+}
+
+TX_EVENTS = ("SEND", "SEND_DONE", "POST", "RELEASE", "TIMEOUT")
+RX_EVENTS = ("RX_MESSAGE", "RX_DONE", "RX_DESC")
+
+
+def read_trace(path):
+    with open(path, "rb") as trace:
+        data = trace.read()
+    if len(data) < HEADER.size:
+        raise ValueError("trace too short")
+    magic, version, entry_size, cycles_per_us, count = HEADER.unpack_from(data, 0)
+    if magic != TRACE_MAGIC:
+        raise ValueError("not an SCL trace")
+    if version != TRACE_VERSION or entry_size != ENTRY.size:
+        raise ValueError("unsupported trace version %d" % version)
+    entries = []
+    offset = HEADER.size
+    for _ in range(count):
+        if offset + ENTRY.size > len(data):
+            break
+        sequence, timestamp, event, index, arg = ENTRY.unpack_from(data, offset)
+        offset += ENTRY.size
+        # Empty entries were being written or overwritten during the dump
+        if sequence != 0:
+            entries.append((sequence, timestamp, event, index, arg))
+    return max(cycles_per_us, 1), entries
+
+
+def index_name(event, index):
+    if event in TX_EVENTS:
+        return TX_INDEXES.get(index, str(index))
+    if event in RX_EVENTS:
+        return RX_INDEXES.get(index, str(index))
+    return ""
+
+
+def elapsed_us(start, end, cycles_per_us):
+    # The cycle counter wraps around every 2^32 cycles
+    return ((end - start) & 0xffffffff) / cycles_per_us
+
+
+def print_timeline(cycles_per_us, entries):
+    first = previous = None
+    for sequence, timestamp, event, index, arg in entries:
+        if first is None:
+            first = previous = timestamp
+        name = EVENTS.get(event, "EVENT_%d" % event)
+        print("%8d %12.1f us %+10.1f us  %-10s %-26s 0x%08x" % (
+            sequence, elapsed_us(first, timestamp, cycles_per_us),
+            elapsed_us(previous, timestamp, cycles_per_us), name, index_name(name, index), arg))
+        previous = timestamp
+
+
+def print_summary(cycles_per_us, entries):
+    wakeups = {}
+    turnarounds = {}
+    last_isr = None
+    posted = {}
+    for _, timestamp, event, index, arg in entries:
+        name = EVENTS.get(event)
+        if name == "RX_ISR":
+            last_isr = timestamp
+        elif name == "RX_MESSAGE" and last_isr is not None:
+            wakeups.setdefault(index, []).append(elapsed_us(last_isr, timestamp, cycles_per_us))
+            last_isr = None
+        elif name == "POST":
+            # One request is written to a channel at a time, arg is the channel
+            posted[arg] = (index, timestamp)
+        elif name == "RELEASE" and arg in posted:
+            post_index, post_time = posted.pop(arg)
+            turnarounds.setdefault(post_index, []).append(elapsed_us(post_time, timestamp, cycles_per_us))
+    print_table("Interrupt-to-thread latency", wakeups, RX_INDEXES)
+    print_table("NP turnaround", turnarounds, TX_INDEXES)
+
+
+def print_table(title, samples, names):
+    print("%s (us)" % title)
+    print("  %-26s %8s %10s %10s %10s" % ("index", "count", "min", "avg", "max"))
+    for index in sorted(samples):
+        values = samples[index]
+        print("  %-26s %8d %10.1f %10.1f %10.1f" % (
+            names.get(index, str(index)), len(values), min(values), sum(values) / len(values), max(values)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("trace", help="binary trace written by scl_trace_dump()")
+    parser.add_argument("--summary", action="store_true", help="print latency summaries instead of the timeline")
+    args = parser.parse_args()
+    try:
+        cycles_per_us, entries = read_trace(args.trace)
+    except (OSError, ValueError) as error:
+        sys.exit("%s: %s" % (args.trace, error))
+    if args.summary:
+        print_summary(cycles_per_us, entries)
+    else:
+        print_timeline(cycles_per_us, entries)
+
+
+if __name__ == "__main__":
+    main()